@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2018, Fabrice S. Bigirimana
+ * Copyright (c) 2018, University of Oslo
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ * 
+ */
+#ifndef COMMON_HEADERS_H
+#define COMMON_HEADERS_H
+
+
+namespace ns3 {
+
+#define MAX_ATTR_SIZE sizeof(uint8_t)
+#define NOTIFICATION 1
+    /**
+     * how are event buffer emptied
+     */
+#define SELECTED_CONSUMPTION 2 
+#define ZERO_CONSUMPTION 3
+
+    /**
+     * buffer selection policy
+     */
+#define MULTIPLE_SELECTION 4
+#define SINGLE_SELECTION 5 
+    /**
+     * each buffer is indexed by the join key (the sequence number) so that
+     * a match is probed and consumed in constant time
+     */
+#define KEYED_SELECTION 6
+#define ACTIVATE 0
+    
+    enum OperatorState {
+        ACTIVE,
+        DEACTIVATED,
+        FREEZED,
+        RETRANSMITING,
+        RESUMING,
+        TENTATIVE,
+        REMOTE_ACTIVE,
+        UNDEFINED,
+        OUTPUT_CLOSED
+    };
+    /**
+     * window policies of an operator's input buffers
+     */
+    enum window_type {
+        NO_WINDOW,
+        TIME_WINDOW,
+        COUNT_WINDOW
+    };
+    enum window_mode {
+        SLIDING_WINDOW,
+        TUMBLING_WINDOW
+    };
+    enum aggregate_function {
+        AGGREGATE_COUNT,
+        AGGREGATE_SUM,
+        AGGREGATE_AVG,
+        AGGREGATE_MIN,
+        AGGREGATE_MAX
+    };
+    enum event_class {
+        ATOMIC_EVENT,
+        COMPOSITE_EVENT,
+        FINAL_EVENT,
+        SYSTEM_EVENT
+    };
+    
+    enum message_types {
+        EVENT = 1,
+        QUERY,
+        /* operator migration, see Placement::MigrateOperator */
+        MIGRATION,
+        RESUME,
+        REDIRECT,
+        REDIRECT_ACK,
+        STREAM_MOVED,
+        MIGRATION_ABORT,
+        /* the event types a datasource produces, see DataSource::Advertise */
+        ADVERTISEMENT,
+        /* several messages for one destination, see Communication::ScheduleSend */
+        BATCH,
+        /* a message sent until acknowledged, see Communication::EnqueuePacket */
+        RELIABLE,
+        ACK
+    };
+    
+    /* the classes of outgoing messages, from the most urgent */
+    enum traffic_class {
+        CONTROL_TRAFFIC,
+        QUERY_TRAFFIC,
+        FINAL_EVENT_TRAFFIC,
+        COMPOSITE_EVENT_TRAFFIC,
+        ATOMIC_EVENT_TRAFFIC,
+        TRAFFIC_CLASSES
+    };
+    
+    
+}
+#endif /* COMMON_HEADERS_H */
+
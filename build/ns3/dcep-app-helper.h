@@ -0,0 +1,59 @@
+/*
+ * To change this license header, choose License Headers in Project Properties.
+ * To change this template file, choose Tools | Templates
+ * and open the template in the editor.
+ */
+
+/* 
+ * File:   dcep-app-helper.h
+ * Author: fabrice
+ *
+ * Created on September 6, 2016, 3:11 PM
+ */
+
+#ifndef DCEP_APP_HELPER_H
+#define DCEP_APP_HELPER_H
+
+#include <stdint.h>
+#include "ns3/application-container.h"
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+
+
+namespace ns3{
+    
+
+
+class DcepAppHelper
+{
+public:
+  /**
+   * Create UdpServerHelper which will make life easier for people trying
+   * to set up simulations with udp-client-server application.
+   *
+   */
+  DcepAppHelper ();
+
+  /**
+   * Record an attribute to be set in each Application after it is is created.
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetAttribute (std::string name, const AttributeValue &value);
+
+  
+  ApplicationContainer Install (NodeContainer c) const;
+  ApplicationContainer Install (Ptr<Node> node) const;
+
+private:
+    Ptr<Application> InstallPriv (Ptr<Node> node) const;
+  ObjectFactory m_factory; //!< Object factory.
+  
+};
+}
+
+
+
+#endif /* DCEP_APP_HELPER_H */
+
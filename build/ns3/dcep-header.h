@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2018, Fabrice S. Bigirimana
+ * Copyright (c) 2018, University of Oslo
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ * 
+ */
+
+#ifndef DCEPHEADER_H
+#define DCEPHEADER_H
+
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/header.h"
+#include <iostream>
+
+namespace ns3 {
+
+/* A sample Header implementation
+ */
+class DcepHeader : public Header 
+{
+public:
+
+  DcepHeader ();
+  virtual ~DcepHeader ();
+
+  void SetContentType (uint16_t data);
+  uint16_t GetContentType (void) const;
+  std::size_t GetContentSize(void) const;
+  void setContentSize(std::size_t s);
+  /* the traffic class the sender queues the message in, see
+   * Communication::GetTrafficClass */
+  void SetTrafficClass (uint8_t cls);
+  uint8_t GetTrafficClass (void) const;
+  void SetQueryType (std::string);
+  std::string GetQueryType ();
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual uint32_t GetSerializedSize (void) const;
+private:
+  uint16_t m_type;
+  uint8_t m_trafficClass;
+  std::size_t size;
+  std::string qt;
+};
+
+}
+
+#endif /* DCEPHEADER_H */
+
@@ -0,0 +1,23 @@
+
+#ifdef NS3_MODULE_COMPILATION
+# error "Do not include ns3 module aggregator headers from other modules; these are meant only for end user scripts."
+#endif
+
+#ifndef NS3_MODULE_DCEP
+    
+
+// Module headers:
+#include "cep-engine.h"
+#include "common.h"
+#include "communication.h"
+#include "dcep-app-helper.h"
+#include "dcep-header.h"
+#include "dcep-state.h"
+#include "dcep.h"
+#include "event-type.h"
+#include "message-types.h"
+#include "placement.h"
+#include "query-compiler.h"
+#include "resource-manager.h"
+#include "seq-ts-header.h"
+#endif
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2018, Fabrice S. Bigirimana
+ * Copyright (c) 2018, University of Oslo
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ * 
+ */
+
+#ifndef DCEP_STATE_H
+#define DCEP_STATE_H
+
+#include "ns3/object.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "common.h"
+#include "event-type.h"
+#include <unordered_map>
+namespace ns3
+{
+    class Query;
+    class Event;
+     
+    class EventRoutingTableEntry : public Object{
+    public:
+        static TypeId GetTypeId (void);
+ 
+       // void EventRoutingTableEntry(Ptr<EventRoutingTableEntry>);
+        EventRoutingTableEntry();
+        Ptr<Query> source_query;//the query used to produce the event corresponding to the current entry
+        OperatorState state;
+        bool monitoring;
+        Ipv4Address current_processor;
+        Ipv4Address next_hop;//main info used to determine where parent query should be placed
+        uint32_t freezeAck_counter;
+        std::vector<Ptr< Event> > freeze_queue;
+        std::vector<Ipv4Address> dataSources;
+        
+    };
+    
+    /* a datasource which advertised events of some type */
+    class AdvertisedProducer
+    {
+    public:
+        Ipv4Address address;
+        double rate;//events per second
+        Time expires;
+    };
+    
+    class DcepState : public Object
+    {
+    public:
+        static TypeId GetTypeId (void);
+        DcepState ();
+        void Configure ();
+        
+        bool IsExpected(Ptr<Event> e);
+        bool IsActive(EventTypeId eventType);
+        Ipv4Address GetOuputDest(EventTypeId eventType);
+        Ipv4Address GetNextHop(EventTypeId eventType);
+        Ptr<Query> GetQuery(EventTypeId eventType);
+        OperatorState GetState(EventTypeId eventType);
+        Ipv4Address GetCurrentProcessor(EventTypeId eType);
+        
+        
+        void SetNextHop (EventTypeId eventType, Ipv4Address adr);
+        void SetCurrentProcessor (EventTypeId eventType, Ipv4Address adr);
+        void SetOutDest (EventTypeId eventType, Ipv4Address adr);
+        void SetState (EventTypeId eventType, OperatorState state);
+        /* a query placed again, e.g. migrated back, replaces the previous one */
+        void CreateEventRoutingTableEntry (Ptr<Query> q);
+        /* the entry of the operator producing the given type, 0 if there is none */
+        Ptr<EventRoutingTableEntry> GetEntry (EventTypeId eventType);
+        /* the entries of the operators consuming events of the given type */
+        const std::vector<Ptr<EventRoutingTableEntry> >& GetConsumers (EventTypeId inputType);
+        /* the types of the events q consumes */
+        static void GetInputs (Ptr<Query> q, std::vector<EventTypeId> &inputs);
+        
+        /* 
+         * records or refreshes a producer of the given type for lifetime,
+         * returns true if it was not known
+         */
+        bool AddProducer (EventTypeId eType, Ipv4Address address, double rate, Time lifetime);
+        /* the producers of the given type still alive, the fastest first */
+        void GetProducers (EventTypeId eType, std::vector<Ipv4Address> &result);
+        /* the sum of the rates advertised for the given type, 0 if unknown */
+        double GetAdvertisedRate (EventTypeId eType);
+        
+        
+    private:
+        void HandlerLocalPlacement (EventTypeId eType);
+        
+        /* returns the shared miss entry when there is no entry for the type */
+        Ptr<EventRoutingTableEntry> lookUpEventRoutingTable(EventTypeId eventType);
+        void UpdateExpectedInputs (Ptr<Query> q, bool active);
+        
+        /* entries by the type of the events they produce */
+        std::unordered_map<EventTypeId, Ptr<EventRoutingTableEntry> > eventRoutingTable;
+        /* entries by the types of the events they consume */
+        std::unordered_map<EventTypeId, std::vector<Ptr<EventRoutingTableEntry> > > consumers;
+        /* 
+         * expectedInputs[t] is the number of active composite operators 
+         * consuming events of type t, see IsExpected
+         */
+        std::vector<uint32_t> expectedInputs;
+        Ptr<EventRoutingTableEntry> missEntry;
+        std::vector<Ptr<EventRoutingTableEntry> > noConsumers;
+        /* the producers of each event type, from their advertisements */
+        std::unordered_map<EventTypeId, std::vector<AdvertisedProducer> > producers;
+    };
+}
+
+#endif /* DCEP_STATE_H */
+
@@ -0,0 +1,60 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2007 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DROPTAIL_H
+#define DROPTAIL_H
+
+#include <queue>
+#include "ns3/queue.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief A FIFO packet queue that drops tail-end packets on overflow
+ */
+class DropTailQueue : public Queue
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief DropTailQueue Constructor
+   *
+   * Creates a droptail queue with a maximum size of 100 packets by default
+   */
+  DropTailQueue ();
+
+  virtual ~DropTailQueue();
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueItem> item);
+  virtual Ptr<QueueItem> DoDequeue (void);
+  virtual Ptr<QueueItem> DoRemove (void);
+  virtual Ptr<const QueueItem> DoPeek (void) const;
+
+  std::queue<Ptr<QueueItem> > m_packets; //!< the items in the queue
+};
+
+} // namespace ns3
+
+#endif /* DROPTAIL_H */
@@ -0,0 +1,426 @@
+/*
+ * Copyright (C) 2018, Fabrice S. Bigirimana
+ * Copyright (c) 2018, University of Oslo
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ * 
+ */
+
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <stdint.h>
+#include "ns3/object-factory.h"
+#include "ns3/object.h"
+#include "ns3/olsr-routing-protocol.h"
+#include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "event-type.h"
+#include <unordered_map>
+#include <deque>
+
+namespace ns3 {
+
+/* ... */
+  
+    class Query;
+    class Event;
+    class Ipv4Address;
+    class SerializedMigration;
+    class SerializedAdvertisement;
+    class CentralizedPlacementPolicy;
+    class Detector;
+    class Forwarder;
+    class Dcep;
+   
+    class PlacementPolicy : public Object
+    {
+    public:
+        static TypeId GetTypeId (void);
+        
+        PlacementPolicy();
+        virtual void configure(void)= 0;
+        virtual void DoPlacement(void)= 0;
+        /* 
+         * runs DoPlacement once for all the queries received in the 
+         * current time step
+         */
+        void SchedulePlacement(void);
+        /**
+         * Called on the host of the operator producing events of the given
+         * type, to check whether it is still well placed. Returns true if
+         * the operator is being migrated, see Placement::MigrateOperator.
+         */
+        virtual bool doAdaptation(EventTypeId eType)= 0;
+        /**
+         * This function is used to determine where the event produced 
+         * by query q should be sent. 
+         * In a centralized CEP: all events produced by the engine should be 
+         * forwarded on the local node: the sink.
+         * In a decentralized CEP there a re two cases to consider:
+         *  1. only datasources and the sink do the processing: in this case,
+         *     all event produced are forwarded to the sink.
+         *  2. we have a scenario with brokers which process unpinned operators:
+         *     in this case, a more advance placement mechanism is implemented. 
+         * 
+         *  In a sense, this function implements whatever placement policy one
+         *  wants to apply. It therefore needs to be configured by the user.
+         * the function return true if an event routing table entry has been 
+         * successfully created: the processor for q has been determined.
+         */
+        virtual bool PlaceQuery(Ptr<Query> q)= 0;
+        
+        /**
+         * A query is used to produce an event of a specific type when 
+         * an event pattern aggregated to it matches. The event pattern captures
+         * relationships between events of specific types. The following model
+         * reflect what a query is:
+         * ----- event type 1 ---->  | query |---> event type 3
+         * ----- event type 2 ---->  |       | 
+         * 
+         * the query depicted here is a set of operators which can match event
+         *  of types 1 and 2 and produce events of type 3. 
+         * 
+         * this function is used to setup an event-query mapping table which is
+         * used by the cep engine to determine which operator(s) to apply to
+         * incoming events.
+         */
+        
+    protected:
+        /* 
+         * the nodes generating the atomic events of the given type, this 
+         * node if it does, otherwise the advertised ones, the fastest first
+         */
+        void GetProducers(EventTypeId eType, std::vector<Ipv4Address> &producers);
+        /* the first of GetProducers, Any if there is none */
+        Ipv4Address GetProducer(EventTypeId eType);
+        /**
+         * tries to place every query of the placement queue once, in a
+         * single pass. The ones which could not be placed stay queued and
+         * are retried by a single timer, whose delay doubles after every
+         * pass which placed nothing, from RetryDelay up to MaxRetryDelay.
+         */
+        void PlacePending();
+        
+        Time initialRetryDelay;
+        Time maxRetryDelay;
+        Time retryDelay;
+        EventId passEvent;
+        EventId retryEvent;
+        
+        TracedCallback<EventTypeId> newHostFound;
+        TracedCallback<EventTypeId> newLocalPlacement;
+        
+    };
+    
+    class CentralizedPlacementPolicy : public PlacementPolicy
+    {
+    public:
+        static TypeId GetTypeId (void);
+        
+        virtual void configure(void);
+        virtual void DoPlacement(void);
+        virtual bool doAdaptation(EventTypeId eType);
+        virtual bool PlaceQuery(Ptr<Query> q);
+        
+    
+    };
+    
+    /**
+     * Places every composite operator on the node minimizing the traffic
+     * it causes, i.e. the sum over its input and output streams of the 
+     * stream rate times the hop distance to the other end of the stream.
+     * 
+     * The search is decentralized. A query walks the network one hop at a
+     * time and each node only uses its own routing table: it groups the
+     * stream ends by the next hop leading to them. When the ends behind 
+     * one neighbor carry more than half of the total rate, moving there 
+     * strictly reduces the traffic and the query is sent to that neighbor.
+     * Otherwise the node is the weighted median of the stream ends and 
+     * the operator is placed on it.
+     * 
+     * The sink, where queries are issued, places the operators top-down:
+     * an operator is placed once its parent is, and the node it ends up on
+     * reports back to the sink. Atomic queries are sent to the producers
+     * of their event type with the parent operator as output destination.
+     * Stream rates are estimated at the sink, from the events it observed
+     * or, for atomic types, from the rates advertised by their producers
+     * or DefaultEventRate, and travel with the query.
+     * 
+     * Once placed, operators are checked every MonitoringInterval by their
+     * host, with the rates it observes and its current routes. When moving
+     * to the heaviest neighbor saves more than MigrationThreshold of the 
+     * traffic of the operator, the operator is migrated there.
+     */
+    class DistributedPlacementPolicy : public PlacementPolicy
+    {
+    public:
+        static TypeId GetTypeId (void);
+        
+        DistributedPlacementPolicy();
+        virtual void configure(void);
+        virtual void DoPlacement(void);
+        virtual bool doAdaptation(EventTypeId eType);
+        virtual bool PlaceQuery(Ptr<Query> q);
+        /* estimated rate of the events of the given type, per second */
+        double GetRate(EventTypeId eType);
+        
+    private:
+        class RateCounter
+        {
+        public:
+            uint32_t count;
+            Time first;
+        };
+        
+        bool IsOrigin();
+        void CountEvent(Ptr<Event> e);
+        double EstimateRate(EventTypeId eType, uint32_t depth);
+        Ipv4Address GetStreamEnd(EventTypeId eType, uint32_t depth);
+        Ipv4Address GetParentHost(Ptr<Query> q);
+        bool PlaceAtomicQuery(Ptr<Query> q);
+        Ipv4Address GetHeaviestNeighbor(Ptr<Query> q, const double rates[3], 
+                double &heaviest, double &total);
+        void Walk(Ptr<Query> q);
+        void Install(Ptr<Query> q);
+        double GetObservedRate(EventTypeId eType, double fallback);
+        bool SharesInputs(Ptr<Query> q);
+        void Monitor();
+        void OperatorMigrated(EventTypeId eType, Ipv4Address host);
+        
+        double defaultRate;
+        uint32_t maxSteps;
+        double migrationThreshold;
+        Time monitoringInterval;
+        /* the operators hosted by this node */
+        std::vector<EventTypeId> hosted;
+        EventId monitorEvent;
+        /* the issued queries by output type, only known at the sink */
+        std::unordered_map<EventTypeId, Ptr<Query> > queries;
+        std::unordered_map<EventTypeId, RateCounter> observed;
+    };
+    
+    /**
+     * The placement component can be seen as an extension for 
+     * a CEP engine which enables distribution.
+     * This means that the primary goal of this component is to hide distribution
+     * to the CEP engine. To achieve this, the placement component takes care of:
+     *      1. operator placement assignment on network nodes, essentially building an
+     *          operator network.
+     *      2. event forwarding through the operator network
+     * The design of the placement component applies the separation of 
+     * policies and mechanisms. The aim is to allow different placement assignment policies 
+     * which can be loaded at compile or runtime. This should make this component reusable across
+     * different system scenarios. 
+     * A placement object implements mechanisms for building the operator network and forwarding events
+     * through it. And instance of a PlacementPolicy (defined above) object implements a placement 
+     * assignment algorithm to determine where an operator should be placed. 
+     */
+    
+class Placement : public Object
+    {
+    public:
+        static TypeId GetTypeId (void);
+        
+        Placement();
+        void configure();
+        
+        
+        /*
+         * All CEP events from remote nodes are received here
+         * 
+         */
+        void RcvCepEvent(Ptr<Event> e);
+        
+        /*
+         * All CEP events produced by this node are forwarded from here.
+         */
+        void ForwardProducedEvent(Ptr<Event> e);
+        
+        /* Called when the Placement Policy has determined where a 
+         * given query should be sent
+         */
+        void ForwardQuery(EventTypeId eType);
+        void SendQueryToCepEngine (Ptr<Query> q);
+        
+        
+        
+        
+        
+        void RecvQuery(Ptr<Query> q);
+        
+        /**
+         * Moves the operator producing events of the given type from this
+         * node to host, without losing events:
+         *  1. the operator is FREEZED: it is removed from the local CEP 
+         *     engine and its inputs are held in the freeze queue. Its query 
+         *     and state, the events it buffered, are sent to host, which 
+         *     holds the inputs it receives (RESUMING).
+         *  2. the hosts of the input streams are asked to redirect them to
+         *     host. Once they and host all acknowledged, no more input 
+         *     comes here.
+         *  3. the freeze queue is sent to host, which restores the state,
+         *     processes the queued inputs, then the ones it held, and 
+         *     becomes ACTIVE. The operator is DEACTIVATED here and late 
+         *     inputs are forwarded to host.
+         *  4. host tells the consumer of the operator output and the sink 
+         *     that the stream now comes from it.
+         * Without all the acknowledgements within MigrationTimeout, the 
+         * operator is rolled back: it is restored here, the input streams
+         * are redirected back and host is told to give it up. Without the
+         * freeze queue within twice MigrationTimeout, host resumes the 
+         * operator with the state it has.
+         * Returns false if the operator cannot be moved.
+         */
+        bool MigrateOperator(EventTypeId eType, Ipv4Address host);
+        void RecvMigrationMessage(uint16_t type, const SerializedMigration &message, 
+                Ptr<Query> q, const std::vector<Ptr<Event> > &events);
+        /* 
+         * records the producers of the advertised types, queries waiting
+         * for a new producer are placed again
+         */
+        void RecvAdvertisement(const SerializedAdvertisement &message);
+        
+        TracedCallback< Ptr<Event> > m_systemEvent;
+        
+        
+    private:
+        
+        friend class PlacementPolicy;
+        friend class CentralizedPlacementPolicy;
+        friend class DistributedPlacementPolicy;
+        friend class Detector;
+        friend class Forwarder;
+        friend class Dcep;
+        friend class ResourceManager;
+        /*
+         * All events to be processed by remote CEP engine(s)
+         * are sendt from here.
+         */
+        void SendCepEvent (Ptr<Event> e, Ipv4Address dest);
+        /* 
+         * sends e to the hosts of the operators reading it besides the
+         * one at dest, see Query::other_parent_outputs
+         */
+        void ForwardToOtherParents (Ptr<Event> e, Ptr<Query> q, Ipv4Address dest);
+        void TransmitCepEvent (Ptr<Event> e, Ipv4Address dest, uint32_t distance);
+        /*
+         * events to destinations without a route wait in a queue per 
+         * destination, of at most PendingQueueCapacity events, the oldest
+         * being dropped first. The queues are flushed when the resource 
+         * manager reports new routes, at most once per PendingFlushHoldTime,
+         * or checked every PendingCheckInterval for protocols which do not
+         * report them. Events older than PendingEventMaxAge are dropped.
+         */
+        void QueuePendingEvent (Ptr<Event> e, Ipv4Address dest);
+        void RoutesChanged (void);
+        void FlushPending (void);
+        /*
+         * events to be processed by the local CEP engine are
+         * sendt from here
+         */
+        void SendEventToCepEngine (Ptr<Event> e);
+        /*
+         * events expected by the local sink are sendt from here.
+         */
+        void SendEventToSink (Ptr<Event> e);
+        /*
+         * hands e to the local operators consuming it, or holds it for 
+         * the ones being migrated
+         */
+        void DeliverEvent (Ptr<Event> e);
+        
+        void SendMigrationMessage(uint16_t type, const SerializedMigration &message,
+                Ptr<Query> q, const std::vector<Ptr<Event> > &events, Ipv4Address dest);
+        void RecvOperatorState(const SerializedMigration &message, Ptr<Query> q, 
+                const std::vector<Ptr<Event> > &events);
+        void ResumeOperator(const SerializedMigration &message, const std::vector<Ptr<Event> > &events);
+        void RedirectStream(const SerializedMigration &message);
+        void RecvRedirectAck(const SerializedMigration &message);
+        void RecvStreamMoved(const SerializedMigration &message);
+        void FinishMigration(EventTypeId eType);
+        void RollBackMigration(EventTypeId eType);
+        void AbortMigration(const SerializedMigration &message);
+        /* rolls back or resumes the migration of eType, see MigrateOperator */
+        void ExpireMigration(EventTypeId eType);
+        /* 
+         * events no local operator consumes, e.g. redirected to an operator
+         * which did not arrive yet, are held for MigrationTimeout
+         */
+        void HoldUnclaimedEvent(Ptr<Event> e);
+        void DropUnclaimedEvents(void);
+        
+        
+        void ForwardRemoteQuery(EventTypeId eType);
+        void SendRemoteQuery(Ptr<Query> q, Ipv4Address dest);
+        
+        class PendingEvent
+        {
+        public:
+            Ptr<Event> event;
+            Time queued;
+        };
+        
+        uint16_t deploymentModel;
+        /* events waiting for a route, by destination address */
+        std::unordered_map<uint32_t, std::deque<PendingEvent> > pending;
+        uint32_t pendingCapacity;
+        Time pendingMaxAge;
+        Time pendingCheckInterval;
+        EventId pendingCheck;
+        Time pendingFlushHold;
+        EventId pendingFlush;
+        Time lastPendingFlush;
+        TracedValue<uint32_t> pendingOverflowDrops;
+        TracedValue<uint32_t> pendingExpiredDrops;
+        
+        /* an operator being migrated from or to this node */
+        class Migration
+        {
+        public:
+            /* the state of the operator, to restore on rollback or resume */
+            std::vector<Ptr<Event> > state;
+            /* previous host only, the input streams and their hosts */
+            std::vector<EventTypeId> streams;
+            std::vector<Ipv4Address> sources;
+            /* new host only */
+            Ipv4Address origin;
+            Ipv4Address output_dest;
+            EventId timeout;
+        };
+        
+        Time migrationTimeout;
+        std::deque<PendingEvent> unclaimed;
+        EventId unclaimedCheck;
+        TracedValue<uint32_t> unclaimedDrops;
+        
+        bool centralized_mode;
+        uint16_t operator_counter;
+        
+        
+        
+        std::vector<Ptr<Query> > q_queue;//queries awaiting to be placed
+        /* the operators being migrated, until they resume or are rolled back */
+        std::unordered_map<EventTypeId, Migration> migrations;
+        TracedCallback<EventTypeId, Ipv4Address> operatorMigrated;
+        TracedCallback<> activateDatasource;
+        TracedCallback<Ptr<Event> > remoteEventReceived;
+        TracedCallback<Ptr<Event> > m_newEventProduced;
+    };
+    
+}
+
+#endif /* PLACEMENT_H */
+
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2018, Fabrice S. Bigirimana
+ * Copyright (c) 2018, University of Oslo
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#ifndef QUERY_COMPILER_H
+#define QUERY_COMPILER_H
+
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "event-type.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ns3
+{
+    class Query;
+
+    /**
+     * Compiles textual queries into the trees of Query objects the sink
+     * dispatches. A text holds statements separated by ';', '#' starts a
+     * comment running to the end of the line:
+     *
+     *   SELECT AandB FROM A AND B WITHIN 5s WHERE A.temp > 30;
+     *   SELECT Fire FROM SEQ(Smoke, Heat, Alarm) WITHIN 20 EVENTS;
+     *   SELECT Hot FROM AVG(Temp) WITHIN 10s TUMBLING ABOVE 40;
+     *
+     * FROM takes event types combined with AND, OR and SEQ, or with the
+     * functions AND, OR, SEQ, KLEENE, COUNT, SUM, AVG, MIN and MAX. An
+     * infix chain uses a single operator, parentheses group the others.
+     * Chained SEQ make one pattern, chained AND and OR nest, and every
+     * nested operator produces an intermediate type named after the
+     * selected one. WHERE takes an EventFilter expression, WITHIN a time
+     * or a number of EVENTS, optionally TUMBLING, and both apply to every
+     * operator of the statement. ABOVE and EVERY set the threshold and the
+     * report period of an aggregate. Keywords are case insensitive.
+     *
+     * Each event type read from a datasource gets one atomic query,
+     * whose output goes to every operator consuming it, see
+     * Query::other_parent_outputs. One returned by an earlier Compile is
+     * returned again when a new operator reads it. The queries of a
+     * statement come inputs first. Malformed statements abort.
+     */
+    class QueryCompiler
+    {
+    public:
+        QueryCompiler();
+
+        /* appends the queries of the statements of text */
+        void Compile(const std::string &text, std::vector<Ptr<Query> > &queries);
+
+    private:
+        /* an event type, or an operator over the nodes below it */
+        class Node
+        {
+        public:
+            std::string op;
+            std::string name;
+            std::vector<Node> inputs;
+        };
+
+        void ParseStatement(std::vector<Ptr<Query> > &queries);
+        Node ParseExpression();
+        Node ParseTerm();
+        /* creates the queries of the node, returns the type it produces */
+        EventTypeId Emit(const Node &node, EventTypeId output);
+        /* the query of the statement or the atomic one producing type */
+        Ptr<Query> FindQuery(EventTypeId type);
+
+        void SkipBlanks();
+        bool AtEnd();
+        /* consumes the keyword or punctuation if it comes next */
+        bool Accept(const std::string &keyword);
+        void Expect(const std::string &keyword);
+        std::string ReadName();
+        double ReadNumber();
+        /* a time such as 5s or 200ms */
+        Time ReadTime(double number);
+        /* the raw text up to the next clause */
+        std::string ReadFilter();
+        void Fail(const std::string &message);
+
+        uint32_t nextId;
+        /* the atomic queries by the type they read, across statements */
+        std::unordered_map<EventTypeId, Ptr<Query> > atomics;
+        /* the atomic queries returned by the current Compile */
+        std::unordered_set<EventTypeId> compiled;
+
+        std::string text;
+        std::string::size_type pos;
+        /* the statement being compiled */
+        std::string selected;
+        uint32_t intermediates;
+        std::vector<Ptr<Query> > atomicQueries;
+        std::vector<Ptr<Query> > operators;
+    };
+}
+
+#endif /* QUERY_COMPILER_H */
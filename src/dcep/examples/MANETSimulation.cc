@@ -33,6 +33,23 @@ using namespace ns3;
 using namespace std;
 NS_LOG_COMPONENT_DEFINE ("MANETSimulation");
 
+static uint64_t g_phyTxBytes = 0;
+static uint64_t g_finalEvents = 0;
+static uint64_t g_finalEventDelay = 0;
+
+static void
+PhyTxBegin (Ptr<const Packet> p)
+{
+    g_phyTxBytes += p->GetSize ();
+}
+
+static void
+FinalEventDelay (uint64_t delay)
+{
+    g_finalEvents++;
+    g_finalEventDelay += delay;
+}
+
 int main(int argc, char** argv) {
     
     std::string phyMode ("DsssRate1Mbps");
@@ -49,6 +66,7 @@ int main(int argc, char** argv) {
     LogComponentEnable ("ResourceManager", LOG_LEVEL_INFO);
     
     std::string placementPolicy ("centralized");
+    std::string queryOperator ("or");
     std::string adaptationMechanism ("FastAdaptationMechanism");
     uint32_t numberOfEvents = 1;
     uint32_t numStationary = 3;
@@ -64,6 +82,7 @@ int main(int argc, char** argv) {
     
     
     cmd.AddValue ("PlacementPolicy", "the structure of the placement mechanism", placementPolicy);
+    cmd.AddValue ("QueryOperator", "the operator combining the two atomic events of the query", queryOperator);
     cmd.AddValue ("AdaptationMechanism", "the adaptation mechanism to be applied", adaptationMechanism);
     cmd.AddValue ("NumberOfEvents", "the number of events to be generated by each datasource", numberOfEvents);
     cmd.AddValue("EventRate", "the rate at which events are produced by data sources", eventRate);
@@ -156,6 +175,8 @@ int main(int argc, char** argv) {
         {
             NS_LOG_INFO("sink...");
             dcepApps.Get(i)->SetAttribute("IsSink", BooleanValue(true));
+            dcepApps.Get(i)->SetAttribute("query operator", StringValue(queryOperator));
+            dcepApps.Get(i)->TraceConnectWithoutContext("RxFinalEventDelay", MakeCallback(&FinalEventDelay));
         }
         else//data generator
         {
@@ -181,7 +202,13 @@ int main(int argc, char** argv) {
 
     Simulator::Stop (Seconds (1300.0));
      
+    Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyTxBegin",
+                                   MakeCallback (&PhyTxBegin));
+
     Simulator::Run ();
+
+    NS_LOG_INFO ("BYTES ON AIR " << g_phyTxBytes << " FINAL EVENTS " << g_finalEvents
+                 << " MEAN DELAY (ms) " << (g_finalEvents ? g_finalEventDelay / 1000.0 / g_finalEvents : 0));
     Simulator::Destroy ();
     
     return 0;
@@ -32,11 +32,19 @@
 #include "message-types.h"
 #include "ns3/abort.h"
 #include "ns3/placement.h"
+#include "ns3/simulator.h"
+#include "common.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
 
 
 namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED(CEPEngine);
+NS_OBJECT_ENSURE_REGISTERED(Window);
+NS_OBJECT_ENSURE_REGISTERED(PatternAutomaton);
 NS_LOG_COMPONENT_DEFINE ("Detector");
 
 /**************** CEP CORE *******************
@@ -49,9 +57,30 @@ NS_LOG_COMPONENT_DEFINE ("Detector");
         static TypeId tid = TypeId("ns3::CEPEngine")
         .SetParent<Object> ()
         .AddConstructor<CEPEngine> ()
+        .AddAttribute ("OperatorCost",
+                       "The CPU time taken by each operator an event is fed to.",
+                       TimeValue (Seconds (0)),
+                       MakeTimeAccessor (&CEPEngine::operatorCost),
+                       MakeTimeChecker ())
+        .AddAttribute ("BufferedEventCost",
+                       "The CPU time added for every event or partial match held by the operator.",
+                       TimeValue (Seconds (0)),
+                       MakeTimeAccessor (&CEPEngine::bufferedEventCost),
+                       MakeTimeChecker ())
+        .AddAttribute ("ExecutionQueueCapacity",
+                       "The number of events waiting for the CPU, 0 for no limit.",
+                       UintegerValue (0),
+                       MakeUintegerAccessor (&CEPEngine::queueCapacity),
+                       MakeUintegerChecker<uint32_t> ())
         .AddTraceSource ("Event",
                        "Final event.",
                        MakeTraceSourceAccessor (&CEPEngine::nevent))
+        .AddTraceSource ("CpuDrops",
+                       "The number of events dropped because the execution queue was full.",
+                       MakeTraceSourceAccessor (&CEPEngine::cpuDrops))
+        .AddTraceSource ("ProcessingDelay",
+                       "The time an event spent waiting for and using the CPU.",
+                       MakeTraceSourceAccessor (&CEPEngine::processingDelay))
         
         ;
         
@@ -60,6 +89,10 @@ NS_LOG_COMPONENT_DEFINE ("Detector");
     
     
     CEPEngine::CEPEngine()
+    : operatorCost(Seconds(0)),
+      bufferedEventCost(Seconds(0)),
+      queueCapacity(0),
+      cpuDrops(0)
     {
         Ptr<Forwarder> forwarder = CreateObject<Forwarder>();
         Ptr<Detector> detector = CreateObject<Detector>();
@@ -87,29 +120,142 @@ NS_LOG_COMPONENT_DEFINE ("Detector");
     void
     CEPEngine::ProcessCepEvent(Ptr<Event> e){
         
-        GetObject<Detector>()->ProcessEvent(e);
+        if(operatorCost.IsZero() && bufferedEventCost.IsZero())
+        {
+            GetObject<Detector>()->ProcessEvent(e);
+            return;
+        }
+        
+        if((queueCapacity > 0) && (executionQueue.size() >= queueCapacity))
+        {
+            NS_LOG_INFO("EXECUTION QUEUE FULL, DROPPING EVENT");
+            cpuDrops++;
+            return;
+        }
+        
+        QueuedEvent queued;
+        queued.event = e;
+        queued.arrival = Simulator::Now();
+        executionQueue.push_back(queued);
+        if(!inService.event)
+        {
+            StartService();
+        }
+    }
+    
+    bool
+    CEPEngine::IsOrphaned(Ptr<Event> e, const std::vector<EventTypeId>& types)
+    {
+        return (std::find(types.begin(), types.end(), e->type) != types.end())
+                && GetOpsByInputEventType(e->type).empty();
+    }
+    
+    Time
+    CEPEngine::GetServiceTime(Ptr<Event> e)
+    {
+        const std::vector<Ptr<CepOperator> >& ops = GetOpsByInputEventType(e->type);
+        Time service = Seconds(0);
+        for(uint32_t i = 0; i < ops.size(); i++)
+        {
+            service += operatorCost + bufferedEventCost * ops[i]->GetBufferedEvents();
+        }
+        return service;
     }
     
+    void
+    CEPEngine::StartService()
+    {
+        if(executionQueue.empty())
+        {
+            return;
+        }
+        
+        inService = executionQueue.front();
+        executionQueue.pop_front();
+        serviceEvent = Simulator::Schedule(GetServiceTime(inService.event), 
+                &CEPEngine::FinishService, this);
+    }
     
     void
-    CEPEngine::GetOpsByInputEventType(std::string eventType, std::vector<Ptr<CepOperator>>& ops)
+    CEPEngine::FinishService()
     {
+        Ptr<Event> e = inService.event;
+        Time spent = Simulator::Now() - inService.arrival;
+        inService.event = 0;
         
-        Ptr<CepOperator> op;
+        e->delay += spent.GetMicroSeconds();
+        processingDelay(spent);
+        GetObject<Detector>()->ProcessEvent(e);
         
-        std::vector<Ptr<CepOperator> >::iterator it;
-        for( it = ops_queue.begin(); it != ops_queue.end(); ++it) 
+        if(!inService.event)
         {
-
-            op = (Ptr<CepOperator>) *it;
-           // Ptr<EventPattern> ep = q->GetObject<EventPattern>();
-            //Ptr<EventPattern> ep = q->ep;
-            if(op->ExpectingEvent(eventType))
+            StartService();
+        }
+    }
+    
+    void
+    CEPEngine::TakeOrphanedEvents(const std::vector<EventTypeId>& types, 
+            std::vector<Ptr<Event> >& events)
+    {
+        if(inService.event && IsOrphaned(inService.event, types))
+        {
+            /* its processing is void, the next event starts now */
+            Simulator::Cancel(serviceEvent);
+            events.push_back(inService.event);
+            inService.event = 0;
+        }
+        
+        std::deque<QueuedEvent> kept;
+        for(uint32_t i = 0; i < executionQueue.size(); i++)
+        {
+            if(IsOrphaned(executionQueue[i].event, types))
+            {
+                events.push_back(executionQueue[i].event);
+            }
+            else
             {
-                NS_LOG_INFO("found query expecting event type " << eventType);
-                ops.push_back(op);
+                kept.push_back(executionQueue[i]);
             }
         }
+        executionQueue.swap(kept);
+        
+        if(!inService.event)
+        {
+            StartService();
+        }
+    }
+    
+    
+    const std::vector<Ptr<CepOperator> >&
+    CEPEngine::GetOpsByInputEventType(EventTypeId eventType)
+    {
+        if(eventType >= subscriptions.size())
+        {
+            return no_subscribers;
+        }
+        
+        NS_LOG_INFO("found " << subscriptions[eventType].size() << " operator(s) expecting event type " 
+                << EventTypeTable::GetName(eventType));
+        return subscriptions[eventType];
+    }
+    
+    void
+    CEPEngine::Subscribe(EventTypeId eventType, Ptr<CepOperator> op)
+    {
+        if((eventType == NO_EVENT_TYPE) || !op->ExpectingEvent(eventType))
+        {
+            return;
+        }
+        
+        if(eventType >= subscriptions.size())
+        {
+            subscriptions.resize(eventType + 1);
+        }
+        std::vector<Ptr<CepOperator> >& ops = subscriptions[eventType];
+        if(std::find(ops.begin(), ops.end(), op) == ops.end())
+        {
+            ops.push_back(op);
+        }
     }
     
     Ptr<Query> 
@@ -137,6 +283,84 @@ NS_LOG_COMPONENT_DEFINE ("Detector");
         StoreQuery(q);
     }
     
+    Ptr<CepOperator>
+    CEPEngine::GetOperator(uint32_t queryId)
+    {
+        for(uint32_t i = 0; i < ops_queue.size(); i++)
+        {
+            const std::vector<uint32_t> &ids = ops_queue[i]->queryIds;
+            if(std::find(ids.begin(), ids.end(), queryId) != ids.end())
+            {
+                return ops_queue[i];
+            }
+        }
+        return 0;
+    }
+    
+    void
+    CEPEngine::RemoveQuery(Ptr<Query> q, std::vector<Ptr<Event> >& state)
+    {
+        std::vector<Ptr<Query> >::iterator it = std::find(queryPool.begin(), queryPool.end(), q);
+        if(it != queryPool.end())
+        {
+            queryPool.erase(it);
+        }
+        
+        Ptr<CepOperator> op = GetOperator(q->id);
+        if(!op)
+        {
+            return;
+        }
+        
+        op->queryIds.erase(std::find(op->queryIds.begin(), op->queryIds.end(), q->id));
+        if(!op->queryIds.empty())
+        {
+            NS_LOG_INFO("query " << q->id << " removed, its operator is still shared");
+            return;
+        }
+        
+        op->ExportState(state);
+        for(uint32_t i = 0; i < subscriptions.size(); i++)
+        {
+            std::vector<Ptr<CepOperator> >::iterator sub = 
+                    std::find(subscriptions[i].begin(), subscriptions[i].end(), op);
+            if(sub != subscriptions[i].end())
+            {
+                subscriptions[i].erase(sub);
+            }
+        }
+        ops_queue.erase(std::find(ops_queue.begin(), ops_queue.end(), op));
+        shared_ops.erase(GetSignature(q));
+        op->Dispose();
+    }
+    
+    void
+    CEPEngine::RestoreState(Ptr<Query> q, const std::vector<Ptr<Event> >& state)
+    {
+        Ptr<CepOperator> op = GetOperator(q->id);
+        NS_ABORT_MSG_IF (!op, "NO OPERATOR TO RESTORE THE STATE OF");
+        if(op->queryIds.size() > 1)
+        {
+            /* the operator was already there, with its own state */
+            return;
+        }
+        
+        op->SetRestoring(true);
+        for(uint32_t i = 0; i < state.size(); i++)
+        {
+            std::vector<Ptr<Event> > dropped;
+            op->Evaluate(state[i], dropped);
+        }
+        op->SetRestoring(false);
+    }
+    
+    static bool
+    IsAggregate(const std::string &op)
+    {
+        return (op == "count") || (op == "sum") || (op == "avg")
+                || (op == "min") || (op == "max");
+    }
+    
     void
     CEPEngine::InstantiateQuery(Ptr<Query> q){
         
@@ -146,6 +370,16 @@ NS_LOG_COMPONENT_DEFINE ("Detector");
         }
         else
         {
+            std::string signature = GetSignature(q);
+            std::unordered_map<std::string, Ptr<CepOperator> >::iterator shared 
+                    = shared_ops.find(signature);
+            if(shared != shared_ops.end())
+            {
+                NS_LOG_INFO("query " << q->id << " shares operator " << signature);
+                shared->second->queryIds.push_back(q->id);
+                return;
+            }
+            
             Ptr<CepOperator> cepOp;
             if(q->op == "and")
             {
@@ -155,16 +389,75 @@ NS_LOG_COMPONENT_DEFINE ("Detector");
             {
                 cepOp = CreateObject<OrOperator>();
             }
+            else if(q->op == "seq")
+            {
+                cepOp = CreateObject<SeqOperator>();
+            }
+            else if(q->op == "kleene")
+            {
+                cepOp = CreateObject<KleeneOperator>();
+            }
+            else if(IsAggregate(q->op))
+            {
+                Ptr<AggregateOperator> aggOp = CreateObject<AggregateOperator>();
+                aggOp->SetEmitCallback(MakeCallback(&Detector::EmitMatch, 
+                        PeekPointer(GetObject<Detector>())));
+                cepOp = aggOp;
+            }
             else
             {
                 NS_ABORT_MSG ("UNKNOWN OPERATOR");
             }
             cepOp->Configure(q);
+            if(!q->filter.empty())
+            {
+                cepOp->filter = EventFilter::Compile(q->filter);
+            }
+            cepOp->queryIds.push_back(q->id);
+            shared_ops[signature] = cepOp;
             this->ops_queue.push_back(cepOp);
+            Subscribe(q->inevent1, cepOp);
+            Subscribe(q->inevent2, cepOp);
+            for(uint32_t i = 0; i < q->inevents.size(); i++)
+            {
+                Subscribe(q->inevents[i], cepOp);
+            }
         }
             
     }
     
+    /*
+     * everything that determines the matches of an operator, but not what
+     * the queries do with them.
+     */
+    std::string
+    CEPEngine::GetSignature(Ptr<Query> q)
+    {
+        std::ostringstream signature;
+        signature << q->op << "(" << q->inevent1 << "," << q->inevent2;
+        for(uint32_t i = 0; i < q->inevents.size(); i++)
+        {
+            signature << "," << q->inevents[i];
+        }
+        signature << ")";
+        if(!q->filter.empty())
+        {
+            signature << " where " << q->filter;
+        }
+        if(q->window_type != NO_WINDOW)
+        {
+            signature << " window " << q->window_type << "/" << q->window_mode 
+                    << "/" << q->window_length.GetTimeStep() << "/" << q->window_count;
+        }
+        if(IsAggregate(q->op))
+        {
+            signature.precision(17);
+            signature << " threshold " << q->threshold 
+                    << " period " << q->report_period.GetTimeStep();
+        }
+        return signature.str();
+    }
+    
     void
     CEPEngine::StoreQuery(Ptr<Query> q){
         queryPool.push_back(q);
@@ -192,12 +485,17 @@ NS_LOG_COMPONENT_DEFINE ("Detector");
         
         Ptr<CEPEngine> cep = GetObject<CEPEngine>();
         
-        std::vector<Ptr<CepOperator>> ops;
-        cep->GetOpsByInputEventType(e->type, ops);
-        std::vector<Ptr<CepOperator>>::iterator it;
-        for(it = ops.begin(); it != ops.end(); it++)
+        /* a copy, the produced events may lead to queries being added or removed */
+        std::vector<Ptr<CepOperator> > ops = cep->GetOpsByInputEventType(e->type);
+        
+        for(uint32_t i = 0; i < ops.size(); i++)
         {
-            Ptr<CepOperator> op = (Ptr<CepOperator>) *it;
+            Ptr<CepOperator> op = ops[i];
+            
+            if(op->filter && !op->filter->Accept(e))
+            {
+                continue;
+            }
             
             bool proceed = false;
             std::vector<Ptr<Event> > returned;
@@ -210,258 +508,1286 @@ NS_LOG_COMPONENT_DEFINE ("Detector");
             
             if(proceed)
             {
-                Ptr<Query> q = cep->GetQuery(op->queryId);
-                
-                Ptr<Producer> producer = GetObject<Producer>();
-                producer->HandleNewEvent(q, returned);
+                EmitMatch(op, returned);
+            }
+        }
+        
+    }
+    
+    void
+    Detector::EmitMatch(Ptr<CepOperator> op, std::vector<Ptr<Event> > events)
+    {
+        Ptr<CEPEngine> cep = GetObject<CEPEngine>();
+        Ptr<Producer> producer = GetObject<Producer>();
+        for(uint32_t i = 0; i < op->queryIds.size(); i++)
+        {
+            producer->HandleNewEvent(cep->GetQuery(op->queryIds[i]), events);
+        }
+    }
+    
+    
+    /*********** EVENT FILTER ******************
+     *****************************************************
+     ************************************************************ */
+    
+    /* attribute index standing for Event::value */
+    static const uint32_t VALUE_ATTRIBUTE = MAX_EVENT_ATTRIBUTES;
+    
+    static std::string
+    Trim(const std::string &s)
+    {
+        std::string::size_type begin = s.find_first_not_of(" \t");
+        if(begin == std::string::npos)
+        {
+            return "";
+        }
+        std::string::size_type end = s.find_last_not_of(" \t");
+        return s.substr(begin, end - begin + 1);
+    }
+    
+    Ptr<EventFilter>
+    EventFilter::Compile(const std::string &expression)
+    {
+        Ptr<EventFilter> filter = Create<EventFilter>();
+        std::string::size_type begin = 0;
+        while(begin <= expression.size())
+        {
+            std::string::size_type end = expression.find("&&", begin);
+            if(end == std::string::npos)
+            {
+                end = expression.size();
             }
+            filter->AddTerm(expression.substr(begin, end - begin));
+            begin = end + 2;
         }
+        return filter;
+    }
+    
+    void
+    EventFilter::AddTerm(const std::string &term)
+    {
+        std::string::size_type pos = term.find_first_of("<>=!");
+        NS_ABORT_MSG_IF (pos == std::string::npos, "INVALID FILTER TERM " << term);
+        
+        std::string lhs = Trim(term.substr(0, pos));
+        std::string::size_type oplen = ((pos + 1 < term.size()) && (term[pos+1] == '=')) ? 2 : 1;
+        std::string op = term.substr(pos, oplen);
+        std::string rhs = Trim(term.substr(pos + oplen));
+        
+        Term t;
+        if(op == "==") t.comparison = EQUAL;
+        else if(op == "!=") t.comparison = NOT_EQUAL;
+        else if(op == "<") t.comparison = LESS;
+        else if(op == "<=") t.comparison = LESS_EQUAL;
+        else if(op == ">") t.comparison = GREATER;
+        else if(op == ">=") t.comparison = GREATER_EQUAL;
+        else NS_ABORT_MSG ("INVALID FILTER COMPARISON " << op);
+        
+        std::string::size_type dot = lhs.find('.');
+        NS_ABORT_MSG_IF ((dot == std::string::npos) || (dot == 0) || (dot + 1 == lhs.size()), 
+                "INVALID FILTER ATTRIBUTE " << lhs);
+        t.type = EventTypeTable::Intern(lhs.substr(0, dot));
+        std::string attribute = lhs.substr(dot + 1);
+        t.attribute = (attribute == "value") ? VALUE_ATTRIBUTE 
+                : EventTypeTable::InternAttribute(t.type, attribute);
         
+        char *end = NULL;
+        t.constant = std::strtod(rhs.c_str(), &end);
+        NS_ABORT_MSG_IF (rhs.empty() || (*end != '\0'), "INVALID FILTER CONSTANT " << rhs);
+        
+        terms.push_back(t);
+    }
+    
+    bool
+    EventFilter::Accept(Ptr<Event> e) const
+    {
+        for(uint32_t i = 0; i < terms.size(); i++)
+        {
+            const Term &t = terms[i];
+            if(t.type != e->type)
+            {
+                continue;
+            }
+            
+            double v = (t.attribute == VALUE_ATTRIBUTE) ? e->value : e->attributes[t.attribute];
+            bool accepted;
+            switch(t.comparison)
+            {
+                case EQUAL: accepted = (v == t.constant); break;
+                case NOT_EQUAL: accepted = (v != t.constant); break;
+                case LESS: accepted = (v < t.constant); break;
+                case LESS_EQUAL: accepted = (v <= t.constant); break;
+                case GREATER: accepted = (v > t.constant); break;
+                default: accepted = (v >= t.constant); break;
+            }
+            
+            if(!accepted)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    uint32_t
+    EventFilter::GetSize() const
+    {
+        return terms.size();
     }
     
     
     TypeId
     CepOperator::GetTypeId(void)
     {
-        static TypeId tid = TypeId("ns3::CepOperator")
-        .SetParent<Object> ()
-        ;
+        static TypeId tid = TypeId("ns3::CepOperator")
+        .SetParent<Object> ()
+        ;
+        
+        return tid;
+    }
+    
+    void
+    CepOperator::ExportState(std::vector<Ptr<Event> >& state)
+    {
+    }
+    
+    void
+    CepOperator::SetRestoring(bool restoring)
+    {
+    }
+    
+    uint32_t
+    CepOperator::GetBufferedEvents()
+    {
+        return 0;
+    }
+    
+    TypeId
+    AndOperator::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::AndOperator")
+        .SetParent<CepOperator> ()
+        ;
+        
+        return tid;
+    }
+    
+    TypeId
+    OrOperator::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::OrOperator")
+        .SetParent<CepOperator> ()
+        ;
+        
+        return tid;
+    }
+    
+    void
+    AndOperator::Configure(Ptr<Query> q)
+    {
+        this->event1 = q->inevent1;
+        this->event2 = q->inevent2;
+            
+        Ptr<BufferManager> bufman = CreateObject<BufferManager>();
+        
+        bufman->consumption_policy = SELECTED_CONSUMPTION; //default
+        bufman->selection_policy = KEYED_SELECTION; //default
+        bufman->configure(event1, event2);
+        if(q->window_type != NO_WINDOW)
+        {
+            bufman->configure_window(q->window_type, q->window_mode, 
+                    q->window_length, q->window_count);
+        }
+        this->bufman = bufman; 
+    }
+    
+    void
+    OrOperator::Configure(Ptr<Query> q)
+    {
+        this->event1 = q->inevent1;
+        this->event2 = q->inevent2;
+            
+        Ptr<BufferManager> bufman = CreateObject<BufferManager>();
+        
+        bufman->consumption_policy = SELECTED_CONSUMPTION; //default
+        bufman->selection_policy = SINGLE_SELECTION; //default
+        bufman->configure(event1, event2);
+        this->bufman = bufman; 
+    }
+    
+    bool
+    AndOperator::Evaluate(Ptr<Event> e, std::vector<Ptr<Event> >& returned)
+    {
+        if(bufman->selection_policy == KEYED_SELECTION)
+        {
+            Ptr<Event> partner = bufman->consume_match(e);
+            if(partner)
+            {
+                returned.push_back(e);
+                returned.push_back(partner);
+                return true;
+            }
+            
+            bufman->put_event(e);//wait for event with corresponding sequence number
+            return false;
+        }
+        
+        std::vector<Ptr<Event>> events1;
+        std::vector<Ptr<Event>> events2;
+        bufman->read_events(events1, events2);
+        
+        if((!events1.empty()) && (!events2.empty()))
+        {
+            if (e->type == events1.front()->type)
+            {
+                std::vector<Ptr<Event>>::iterator it = events2.begin();
+                for (uint32_t i = 0; i < events2.size(); i++, it++)
+                {
+                     
+                    if(e->m_seq == bufman->events2[i]->m_seq)
+                    {
+                        returned.push_back(e);
+                        returned.push_back(events2[i]);
+                        bufman->events2.erase(it);
+                        
+                        return true;
+                    }
+                }
+                
+            }
+            else
+            {
+                std::vector<Ptr<Event>>::iterator it = bufman->events1.begin();
+                for (uint32_t i = 0; i < bufman->events1.size(); i++, it++)
+                {
+                    if(e->m_seq == bufman->events1[i]->m_seq)
+                    {
+                        returned.push_back(e);
+                        returned.push_back(bufman->events1[i]);
+                        bufman->events1.erase(it);
+                        return true;
+                    }
+                }
+            }
+            
+        }
+        bufman->put_event(e);//wait for event with corresponding sequence number
+        return false;
+    }
+    
+    bool
+    OrOperator::Evaluate(Ptr<Event> e, std::vector<Ptr<Event> >& returned)
+    {
+        /* everything is a match*/
+       returned.push_back(e);
+        return true; 
+    }
+    
+    TypeId
+    SeqOperator::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::SeqOperator")
+        .SetParent<CepOperator> ()
+        ;
+        
+        return tid;
+    }
+    
+    void
+    SeqOperator::Configure(Ptr<Query> q)
+    {
+        nfa = CreateObject<PatternAutomaton>();
+        
+        if(q->inevents.empty())
+        {
+            nfa->AddState(q->inevent1, false);
+            nfa->AddState(q->inevent2, false);
+        }
+        else
+        {
+            for(uint32_t i = 0; i < q->inevents.size(); i++)
+            {
+                nfa->AddState(q->inevents[i], false);
+            }
+        }
+        nfa->SetWindow(q->window_type, q->window_length, q->window_count);
+    }
+    
+    bool
+    SeqOperator::Evaluate(Ptr<Event> e, std::vector<Ptr<Event> >& returned)
+    {
+        return nfa->Advance(e, returned);
+    }
+    
+    bool
+    SeqOperator::ExpectingEvent(EventTypeId eType)
+    {
+        return nfa->ExpectingEvent(eType);
+    }
+    
+    void
+    SeqOperator::ExportState(std::vector<Ptr<Event> >& state)
+    {
+        nfa->GetEvents(state);
+    }
+    
+    void
+    SeqOperator::SetRestoring(bool restoring)
+    {
+        nfa->SetRestoring(restoring);
+    }
+    
+    uint32_t
+    SeqOperator::GetBufferedEvents()
+    {
+        return nfa->GetRunCount();
+    }
+    
+    TypeId
+    KleeneOperator::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::KleeneOperator")
+        .SetParent<CepOperator> ()
+        ;
+        
+        return tid;
+    }
+    
+    void
+    KleeneOperator::Configure(Ptr<Query> q)
+    {
+        nfa = CreateObject<PatternAutomaton>();
+        nfa->AddState(q->inevent1, true);
+        nfa->AddState(q->inevent2, false);
+        nfa->SetWindow(q->window_type, q->window_length, q->window_count);
+    }
+    
+    bool
+    KleeneOperator::Evaluate(Ptr<Event> e, std::vector<Ptr<Event> >& returned)
+    {
+        return nfa->Advance(e, returned);
+    }
+    
+    bool
+    KleeneOperator::ExpectingEvent(EventTypeId eType)
+    {
+        return nfa->ExpectingEvent(eType);
+    }
+    
+    void
+    KleeneOperator::ExportState(std::vector<Ptr<Event> >& state)
+    {
+        nfa->GetEvents(state);
+    }
+    
+    void
+    KleeneOperator::SetRestoring(bool restoring)
+    {
+        nfa->SetRestoring(restoring);
+    }
+    
+    uint32_t
+    KleeneOperator::GetBufferedEvents()
+    {
+        return nfa->GetRunCount();
+    }
+    
+    bool
+    AndOperator::ExpectingEvent(EventTypeId eType)
+    {
+        if((event1 == eType) || (event2 == eType))
+            return true;
+        else 
+            return false;
+    }
+    
+    void
+    AndOperator::ExportState(std::vector<Ptr<Event> >& state)
+    {
+        bufman->get_events(state);
+    }
+    
+    void
+    AndOperator::SetRestoring(bool restoring)
+    {
+        bufman->set_restoring(restoring);
+    }
+    
+    uint32_t
+    AndOperator::GetBufferedEvents()
+    {
+        return bufman->get_size();
+    }
+    
+    bool
+    OrOperator::ExpectingEvent(EventTypeId eType)
+    {
+        if((event1 == eType) || (event2 == eType))
+            return true;
+        else 
+            return false;
+    }
+    
+    
+     
+    /*********** BUFFER MANAGEMENT******************
+     *****************************************************
+     ************************************************************ */
+    
+    TypeId
+    BufferManager::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::WindowManager")
+        .SetParent<Object> ()
+        .AddConstructor<CEPEngine> ()
+        ;
+        
+        return tid;
+    }
+    
+    void
+    BufferManager::configure(EventTypeId event1, EventTypeId event2)
+    {
+        /*
+         * setup the buffers with their corresponding event types
+         */
+        type1 = event1;
+        type2 = event2;
+    }
+    
+    void
+    BufferManager::configure_window(uint32_t type, uint32_t mode, Time length, uint32_t count)
+    {
+        window1 = CreateObject<Window>();
+        window2 = CreateObject<Window>();
+        window1->Configure(type, mode, length, count);
+        window2->Configure(type, mode, length, count);
+        window1->SetEvictCallback(MakeCallback(&BufferManager::evict_event, this));
+        window2->SetEvictCallback(MakeCallback(&BufferManager::evict_event, this));
+    }
+    
+    void
+    BufferManager::set_restoring(bool restoring)
+    {
+        if(window1)
+        {
+            window1->SetRestoring(restoring);
+            window2->SetRestoring(restoring);
+        }
+    }
+    
+    void
+    BufferManager::expire_windows()
+    {
+        if(window1)
+        {
+            window1->Expire();
+            window2->Expire();
+        }
+    }
+    
+    void
+    BufferManager::evict_event(Ptr<Event> e)
+    {
+        /*
+         * events consumed by a match are not removed from the window,
+         * they are simply not found here anymore when they expire.
+         */
+        if(selection_policy == KEYED_SELECTION)
+        {
+            KeyedBuffer &own = (e->type == type1) ? keyed1 : keyed2;
+            std::pair<KeyedBuffer::iterator, KeyedBuffer::iterator> range = own.equal_range(e->m_seq);
+            for(KeyedBuffer::iterator it = range.first; it != range.second; ++it)
+            {
+                if(it->second == e)
+                {
+                    own.erase(it);
+                    return;
+                }
+            }
+        }
+        else
+        {
+            std::vector<Ptr<Event> >::iterator it = std::find(events1.begin(), events1.end(), e);
+            if(it != events1.end())
+            {
+                events1.erase(it);
+                return;
+            }
+            it = std::find(events2.begin(), events2.end(), e);
+            if(it != events2.end())
+            {
+                events2.erase(it);
+            }
+        }
+    }
+    
+    Ptr<Event>
+    BufferManager::consume_match(Ptr<Event> e)
+    {
+        expire_windows();
+        KeyedBuffer &other = (e->type == type1) ? keyed2 : keyed1;
+        KeyedBuffer::iterator it = other.find(e->m_seq);
+        if(it == other.end())
+        {
+            return 0;
+        }
+        
+        Ptr<Event> match = it->second;
+        other.erase(it);
+        return match;
+    }
+    
+    void
+    BufferManager::read_events(std::vector<Ptr<Event> >& event1,
+            std::vector<Ptr<Event> >& event2)
+    {
+        //apply selection policy
+        switch(selection_policy)
+        {
+            case SINGLE_SELECTION:
+                event1 = events1;
+                event2 = events2;
+                break;
+                
+            default:
+                NS_LOG_INFO("Not applying any selection policy");
+        }
+        
+    }
+    
+    void
+    BufferManager::put_event(Ptr<Event> e)
+    {
+        if(selection_policy == KEYED_SELECTION)
+        {
+            KeyedBuffer &own = (e->type == type1) ? keyed1 : keyed2;
+            own.insert(std::make_pair(e->m_seq, e));
+            if(window1)
+            {
+                ((e->type == type1) ? window1 : window2)->Insert(e);
+            }
+            return;
+        }
+        
+        if(events1.empty() && events2.empty())
+        {
+            events1.push_back(e);
+        }
+        else if ((events1.empty()) && (!events2.empty()))
+        {
+            if(events2.front()->type == e->type)
+            {
+                events2.push_back(e);
+            }
+            else
+            {
+                events1.push_back(e);
+            }
+        }
+        else if ((!events1.empty()) && (events2.empty()))
+        {
+            if(events1.front()->type == e->type)
+            {
+                events1.push_back(e);
+            }
+            else
+            {
+                events2.push_back(e);
+            }
+        }
+        else
+        {
+            NS_LOG_INFO("unknown type");
+        }
+
+    }
+    
+    void
+    BufferManager::get_events(std::vector<Ptr<Event> >& events)
+    {
+        expire_windows();
+        if(selection_policy == KEYED_SELECTION)
+        {
+            for(KeyedBuffer::const_iterator it = keyed1.begin(); it != keyed1.end(); ++it)
+            {
+                events.push_back(it->second);
+            }
+            for(KeyedBuffer::const_iterator it = keyed2.begin(); it != keyed2.end(); ++it)
+            {
+                events.push_back(it->second);
+            }
+            return;
+        }
+        
+        events.insert(events.end(), events1.begin(), events1.end());
+        events.insert(events.end(), events2.begin(), events2.end());
+    }
+    
+    uint32_t
+    BufferManager::get_size()
+    {
+        if(selection_policy == KEYED_SELECTION)
+        {
+            return keyed1.size() + keyed2.size();
+        }
+        return events1.size() + events2.size();
+    }
+    
+    void
+    BufferManager::clean_up()
+    {
+        switch(consumption_policy)
+        {
+            case SELECTED_CONSUMPTION:
+                NS_LOG_INFO("Applying consumption policy " << SELECTED_CONSUMPTION);
+                events1.clear();
+                events2.clear();
+                keyed1.clear();
+                keyed2.clear();
+                break;
+                
+            default:
+                NS_LOG_INFO("Not applying any consumption policy");
+                
+        }
+        
+    }
+      
+    /*********** WINDOW ******************
+     *****************************************************
+     ************************************************************ */
+    
+    TypeId
+    Window::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::Window")
+        .SetParent<Object> ()
+        .AddConstructor<Window> ()
+        ;
+        
+        return tid;
+    }
+    
+    Window::Window()
+    : window_type(NO_WINDOW),
+      window_mode(SLIDING_WINDOW),
+      count(0),
+      restoring(false)
+    {}
+    
+    void
+    Window::DoDispose()
+    {
+        Simulator::Cancel(expiry_event);
+        buffer.clear();
+        evicted = MakeNullCallback<void, Ptr<Event> >();
+        Object::DoDispose();
+    }
+    
+    void
+    Window::Configure(uint32_t type, uint32_t mode, Time length, uint32_t count)
+    {
+        NS_ABORT_MSG_IF ((type == TIME_WINDOW) && !length.IsStrictlyPositive(), "TIME WINDOW WITHOUT LENGTH");
+        NS_ABORT_MSG_IF ((type == COUNT_WINDOW) && (count == 0), "COUNT WINDOW WITHOUT SIZE");
+        this->window_type = type;
+        this->window_mode = mode;
+        this->length = length;
+        this->count = count;
+    }
+    
+    void
+    Window::SetEvictCallback(Callback<void, Ptr<Event> > cb)
+    {
+        evicted = cb;
+    }
+    
+    uint32_t
+    Window::GetSize()
+    {
+        return buffer.size();
+    }
+    
+    void
+    Window::Insert(Ptr<Event> e)
+    {
+        Expire();
+        
+        if((window_type == COUNT_WINDOW) && (window_mode == TUMBLING_WINDOW)
+                && (buffer.size() >= count))
+        {
+            while(!buffer.empty())
+            {
+                Evict();
+            }
+        }
+        
+        Time arrival = restoring ? e->arrival : Simulator::Now();
+        if((window_type == TIME_WINDOW) && buffer.empty() && (window_mode == TUMBLING_WINDOW))
+        {
+            window_start = arrival;
+        }
+        
+        WindowEntry entry;
+        entry.event = e;
+        entry.arrival = arrival;
+        buffer.push_back(entry);
+        
+        if((window_type == COUNT_WINDOW) && (window_mode == SLIDING_WINDOW))
+        {
+            while(buffer.size() > count)
+            {
+                Evict();
+            }
+        }
+        
+        ScheduleExpiry();
+    }
+    
+    void
+    Window::Expire()
+    {
+        if(window_type != TIME_WINDOW)
+        {
+            return;
+        }
+        
+        Time now = Simulator::Now();
+        if(window_mode == SLIDING_WINDOW)
+        {
+            while(!buffer.empty() && ((now - buffer.front().arrival) >= length))
+            {
+                Evict();
+            }
+        }
+        else if(!buffer.empty() && ((now - window_start) >= length))
+        {
+            while(!buffer.empty())
+            {
+                Evict();
+            }
+            int64_t elapsed = (now - window_start).GetTimeStep();
+            window_start += TimeStep((elapsed / length.GetTimeStep()) * length.GetTimeStep());
+        }
+        
+        ScheduleExpiry();
+    }
+    
+    void
+    Window::GetEvents(std::vector<Ptr<Event> >& events)
+    {
+        Expire();
+        for(uint32_t i = 0; i < buffer.size(); i++)
+        {
+            buffer[i].event->arrival = buffer[i].arrival;
+            events.push_back(buffer[i].event);
+        }
+    }
+    
+    void
+    Window::SetRestoring(bool restoring)
+    {
+        this->restoring = restoring;
+    }
+    
+    void
+    Window::Evict()
+    {
+        Ptr<Event> e = buffer.front().event;
+        buffer.pop_front();
+        if(!evicted.IsNull())
+        {
+            evicted(e);
+        }
+    }
+    
+    void
+    Window::ScheduleExpiry()
+    {
+        if((window_type != TIME_WINDOW) || buffer.empty() || expiry_event.IsRunning())
+        {
+            return;
+        }
+        
+        Time expiry = (window_mode == SLIDING_WINDOW) ? 
+            (buffer.front().arrival + length) : (window_start + length);
+        /* restored events may be out of the window already */
+        expiry_event = Simulator::Schedule(Max(expiry - Simulator::Now(), Seconds(0)), &Window::Expire, this);
+    }
+    
+    
+    /*********** PATTERN AUTOMATON ******************
+     *****************************************************
+     ************************************************************ */
+    
+    MatchNode::MatchNode(Ptr<Event> e, Ptr<MatchNode> prev)
+    : event(e),
+      prev(prev),
+      length(prev ? prev->length + 1 : 1)
+    {}
+    
+    TypeId
+    PatternAutomaton::GetTypeId(void)
+    {
+        static TypeId tid = TypeId("ns3::PatternAutomaton")
+        .SetParent<Object> ()
+        .AddConstructor<PatternAutomaton> ()
+        .AddAttribute ("MaxRuns",
+                       "The maximum number of partial matches kept, the oldest one is dropped beyond it.",
+                       UintegerValue (1024),
+                       MakeUintegerAccessor (&PatternAutomaton::max_runs),
+                       MakeUintegerChecker<uint32_t> (1))
+        ;
+        
+        return tid;
+    }
+    
+    PatternAutomaton::PatternAutomaton()
+    : runs(1),
+      run_count(0),
+      restoring(false),
+      window_type(NO_WINDOW),
+      window_count(0)
+    {}
+    
+    void
+    PatternAutomaton::AddState(EventTypeId type, bool kleenePlus)
+    {
+        PatternState s;
+        s.type = type;
+        s.kleenePlus = kleenePlus;
+        states.push_back(s);
+        runs.resize(states.size() + 1);
+    }
+    
+    void
+    PatternAutomaton::SetWindow(uint32_t type, Time length, uint32_t count)
+    {
+        window_type = type;
+        window_length = length;
+        window_count = count;
+    }
+    
+    bool
+    PatternAutomaton::ExpectingEvent(EventTypeId type)
+    {
+        for(uint32_t i = 0; i < states.size(); i++)
+        {
+            if(states[i].type == type)
+                return true;
+        }
+        return false;
+    }
+    
+    uint32_t
+    PatternAutomaton::GetRunCount()
+    {
+        return run_count;
+    }
+    
+    bool
+    PatternAutomaton::Advance(Ptr<Event> e, std::vector<Ptr<Event> >& match)
+    {
+        Expire();
+        
+        /* prefer the runs closest to completion */
+        for(int32_t k = states.size() - 1; k >= 0; k--)
+        {
+            if(states[k].type == e->type)
+            {
+                if(k == 0)
+                {
+                    if(run_count >= max_runs)
+                    {
+                        DropOldestRun();
+                    }
+                    
+                    Run run;
+                    run.last = Create<MatchNode>(e, Ptr<MatchNode>());
+                    run.start = restoring ? e->arrival : Simulator::Now();
+                    run_count++;
+                    return Complete(run, 1, match);
+                }
+                
+                if(!runs[k].empty())
+                {
+                    Run run = runs[k].front();
+                    runs[k].pop_front();
+                    run.last = Create<MatchNode>(e, run.last);
+                    return Complete(run, k + 1, match);
+                }
+            }
+            
+            if((k > 0) && states[k-1].kleenePlus && (states[k-1].type == e->type)
+                    && !runs[k].empty())
+            {
+                Run &run = runs[k].front();
+                run.last = Create<MatchNode>(e, run.last);
+                if((window_type == COUNT_WINDOW) && (run.last->length > window_count))
+                {
+                    NS_LOG_INFO("PATTERN: RUN EXCEEDS THE COUNT WINDOW");
+                    runs[k].pop_front();
+                    run_count--;
+                }
+                return false;
+            }
+        }
+        
+        return false;
+    }
+    
+    static bool
+    StartsBefore(const std::pair<Time, Ptr<MatchNode> > &a, const std::pair<Time, Ptr<MatchNode> > &b)
+    {
+        return a.first < b.first;
+    }
+    
+    void
+    PatternAutomaton::GetEvents(std::vector<Ptr<Event> >& events)
+    {
+        Expire();
+        
+        std::vector<std::pair<Time, Ptr<MatchNode> > > live;
+        for(uint32_t k = 1; k < runs.size(); k++)
+        {
+            for(uint32_t i = 0; i < runs[k].size(); i++)
+            {
+                live.push_back(std::make_pair(runs[k][i].start, runs[k][i].last));
+            }
+        }
+        std::stable_sort(live.begin(), live.end(), StartsBefore);
+        
+        for(uint32_t i = 0; i < live.size(); i++)
+        {
+            uint32_t first = events.size();
+            events.resize(first + live[i].second->length);
+            uint32_t j = events.size();
+            for(Ptr<MatchNode> node = live[i].second; node; node = node->prev)
+            {
+                node->event->arrival = live[i].first;
+                events[--j] = node->event;
+            }
+        }
+    }
+    
+    void
+    PatternAutomaton::SetRestoring(bool restoring)
+    {
+        this->restoring = restoring;
+    }
+    
+    /* 
+     * moves a run which now matched the first matched states to its 
+     * bucket, or reports it when it matched all of them
+     */
+    bool
+    PatternAutomaton::Complete(Run &run, uint32_t matched, std::vector<Ptr<Event> >& match)
+    {
+        if((window_type == COUNT_WINDOW) && (run.last->length > window_count))
+        {
+            NS_LOG_INFO("PATTERN: RUN EXCEEDS THE COUNT WINDOW");
+            run_count--;
+            return false;
+        }
+        
+        if(matched < states.size())
+        {
+            runs[matched].push_back(run);
+            return false;
+        }
+        
+        run_count--;
+        match.resize(run.last->length);
+        uint32_t i = match.size();
+        for(Ptr<MatchNode> node = run.last; node; node = node->prev)
+        {
+            match[--i] = node->event;
+        }
+        return true;
+    }
+    
+    void
+    PatternAutomaton::Expire()
+    {
+        if(window_type != TIME_WINDOW)
+        {
+            return;
+        }
+        
+        Time now = Simulator::Now();
+        for(uint32_t k = 1; k < runs.size(); k++)
+        {
+            while(!runs[k].empty() && (runs[k].front().start + window_length < now))
+            {
+                runs[k].pop_front();
+                run_count--;
+            }
+        }
+    }
+    
+    void
+    PatternAutomaton::DropOldestRun()
+    {
+        int32_t oldest = -1;
+        for(uint32_t k = 1; k < runs.size(); k++)
+        {
+            if(!runs[k].empty() && ((oldest < 0) 
+                    || (runs[k].front().start < runs[oldest].front().start)))
+            {
+                oldest = k;
+            }
+        }
         
-        return tid;
+        if(oldest > 0)
+        {
+            NS_LOG_INFO("PATTERN: TOO MANY RUNS, DROPPING THE OLDEST ONE");
+            runs[oldest].pop_front();
+            run_count--;
+        }
     }
     
+    /*********** AGGREGATION ******************
+     *****************************************************
+     ************************************************************ */
+    
     TypeId
-    AndOperator::GetTypeId(void)
+    AggregateOperator::GetTypeId(void)
     {
-        static TypeId tid = TypeId("ns3::AndOperator")
+        static TypeId tid = TypeId("ns3::AggregateOperator")
         .SetParent<CepOperator> ()
         ;
         
         return tid;
     }
     
-    TypeId
-    OrOperator::GetTypeId(void)
+    AggregateOperator::AggregateOperator()
+    : function(AGGREGATE_COUNT),
+      event1(NO_EVENT_TYPE),
+      count(0),
+      sum(0),
+      extreme(0),
+      threshold(0),
+      above(false)
+    {}
+    
+    void
+    AggregateOperator::DoDispose()
     {
-        static TypeId tid = TypeId("ns3::OrOperator")
-        .SetParent<CepOperator> ()
-        ;
-        
-        return tid;
+        Simulator::Cancel(report_event);
+        emit = MakeNullCallback<void, Ptr<CepOperator>, std::vector<Ptr<Event> > >();
+        if(window)
+        {
+            window->Dispose();
+            window = 0;
+        }
+        CepOperator::DoDispose();
     }
     
     void
-    AndOperator::Configure(Ptr<Query> q)
+    AggregateOperator::Configure(Ptr<Query> q)
     {
-        this->queryId = q->id;
+        if(q->op == "count") function = AGGREGATE_COUNT;
+        else if(q->op == "sum") function = AGGREGATE_SUM;
+        else if(q->op == "avg") function = AGGREGATE_AVG;
+        else if(q->op == "min") function = AGGREGATE_MIN;
+        else if(q->op == "max") function = AGGREGATE_MAX;
+        else NS_ABORT_MSG("AGGREGATE: UNKNOWN FUNCTION " << q->op);
+        
         this->event1 = q->inevent1;
-        this->event2 = q->inevent2;
-            
-        Ptr<BufferManager> bufman = CreateObject<BufferManager>();
+        this->threshold = q->threshold;
+        this->report_period = q->report_period;
         
-        bufman->consumption_policy = SELECTED_CONSUMPTION; //default
-        bufman->selection_policy = SINGLE_SELECTION; //default
-        bufman->configure(this);
-        this->bufman = bufman; 
+        if(q->window_type != NO_WINDOW)
+        {
+            window = CreateObject<Window>();
+            window->Configure(q->window_type, q->window_mode, q->window_length, q->window_count);
+            window->SetEvictCallback(MakeCallback(&AggregateOperator::Evict, this));
+        }
+        
+        if(report_period.IsStrictlyPositive())
+        {
+            report_event = Simulator::Schedule(report_period, &AggregateOperator::PeriodicReport, this);
+        }
     }
     
     void
-    OrOperator::Configure(Ptr<Query> q)
+    AggregateOperator::SetEmitCallback(Callback<void, Ptr<CepOperator>, std::vector<Ptr<Event> > > cb)
     {
-        this->queryId = q->id;
-        this->event1 = q->inevent1;
-        this->event2 = q->inevent2;
-            
-        Ptr<BufferManager> bufman = CreateObject<BufferManager>();
-        
-        bufman->consumption_policy = SELECTED_CONSUMPTION; //default
-        bufman->selection_policy = SINGLE_SELECTION; //default
-        bufman->configure(this);
-        this->bufman = bufman; 
+        emit = cb;
     }
     
     bool
-    AndOperator::Evaluate(Ptr<Event> e, std::vector<Ptr<Event> >& returned)
+    AggregateOperator::ExpectingEvent(EventTypeId eType)
     {
-        std::vector<Ptr<Event>> events1;
-        std::vector<Ptr<Event>> events2;
-        bufman->read_events(events1, events2);
-        
-        if((!events1.empty()) && (!events2.empty()))
+        return event1 == eType;
+    }
+    
+    double
+    AggregateOperator::Combine(double a, double b)
+    {
+        return (function == AGGREGATE_MIN) ? std::min(a, b) : std::max(a, b);
+    }
+    
+    bool
+    AggregateOperator::Evaluate(Ptr<Event> e, std::vector<Ptr<Event> >& returned)
+    {
+        count++;
+        sum += e->value;
+        last = e;
+        if((function == AGGREGATE_MIN) || (function == AGGREGATE_MAX))
         {
-            if (e->type == events1.front()->type)
+            if(!window)
             {
-                std::vector<Ptr<Event>>::iterator it = events2.begin();
-                for (uint32_t i = 0; i < events2.size(); i++, it++)
-                {
-                     
-                    if(e->m_seq == bufman->events2[i]->m_seq)
-                    {
-                        Ptr<Event> e1 = CreateObject<Event>();
-                        Ptr<Event> e2 = CreateObject<Event>();
-                        e->CopyEvent(e1);
-                        events2[i]->CopyEvent(e2);
-                        
-                        bufman->events2.erase(it);
-                        returned.push_back(e1);
-                        returned.push_back(e2);
-                        
-                        
-                        
-                        return true;
-                    }
-                }
-                
+                extreme = (count == 1) ? e->value : Combine(extreme, e->value);
             }
             else
             {
-                std::vector<Ptr<Event>>::iterator it = bufman->events1.begin();
-                for (uint32_t i = 0; i < bufman->events1.size(); i++, it++)
-                {
-                    if(e->m_seq == bufman->events1[i]->m_seq)
-                    {
-                        Ptr<Event> e1 = CreateObject<Event>();
-                        Ptr<Event> e2 = CreateObject<Event>();
-                        e->CopyEvent(e1);
-                        bufman->events1[i]->CopyEvent(e2);
-                        
-                        bufman->events1.erase(it);
-                        returned.push_back(e1);
-                        returned.push_back(e2);
-                        return true;
-                    }
-                }
+                StackEntry entry;
+                entry.value = e->value;
+                entry.aggregate = back.empty() ? e->value : Combine(back.back().aggregate, e->value);
+                back.push_back(entry);
             }
-            
         }
-        bufman->put_event(e);//wait for event with corresponding sequence number
+        
+        /* may evict older events, never e itself */
+        if(window)
+        {
+            window->Insert(e);
+        }
+        
+        if(report_period.IsStrictlyPositive())
+        {
+            return false;
+        }
+        
+        bool was_above = above;
+        above = GetValue() > threshold;
+        if(above && !was_above)
+        {
+            Report(returned);
+            return true;
+        }
         return false;
     }
     
-    bool
-    OrOperator::Evaluate(Ptr<Event> e, std::vector<Ptr<Event> >& returned)
+    void
+    AggregateOperator::ExportState(std::vector<Ptr<Event> >& state)
     {
-        /* everything is a match*/
-       returned.push_back(e);
-        return true; 
+        if(window)
+        {
+            window->GetEvents(state);
+        }
     }
     
-    bool
-    AndOperator::ExpectingEvent(std::string eType)
+    void
+    AggregateOperator::SetRestoring(bool restoring)
     {
-        if((event1 == eType) || (event2 == eType))
-            return true;
-        else 
-            return false;
+        if(window)
+        {
+            window->SetRestoring(restoring);
+        }
     }
     
-    bool
-    OrOperator::ExpectingEvent(std::string eType)
+    uint32_t
+    AggregateOperator::GetBufferedEvents()
     {
-        if((event1 == eType) || (event2 == eType))
-            return true;
-        else 
-            return false;
+        return window ? window->GetSize() : 0;
     }
     
-    
-     
-    /*********** BUFFER MANAGEMENT******************
-     *****************************************************
-     ************************************************************ */
-    
-    TypeId
-    BufferManager::GetTypeId(void)
+    void
+    AggregateOperator::Evict(Ptr<Event> e)
     {
-        static TypeId tid = TypeId("ns3::WindowManager")
-        .SetParent<Object> ()
-        .AddConstructor<CEPEngine> ()
-        ;
+        count--;
+        sum = (count == 0) ? 0 : (sum - e->value);
         
-        return tid;
+        if((function != AGGREGATE_MIN) && (function != AGGREGATE_MAX))
+        {
+            return;
+        }
+        
+        if(front.empty())
+        {
+            /* reverse back onto front so that the oldest event is on top */
+            while(!back.empty())
+            {
+                StackEntry entry = back.back();
+                back.pop_back();
+                entry.aggregate = front.empty() ? entry.value : Combine(front.back().aggregate, entry.value);
+                front.push_back(entry);
+            }
+        }
+        front.pop_back();
     }
     
-    void
-    BufferManager::configure(Ptr<CepOperator> op)
+    uint32_t
+    AggregateOperator::GetCount()
     {
-        /*
-         * setup the buffers with their corresponding event types
-         */
-        
+        return count;
     }
     
-    void
-    BufferManager::read_events(std::vector<Ptr<Event> >& event1,
-            std::vector<Ptr<Event> >& event2)
+    double
+    AggregateOperator::GetValue()
     {
-        //apply selection policy
-        switch(selection_policy)
+        if(function == AGGREGATE_COUNT)
         {
-            case SINGLE_SELECTION:
-                event1 = events1;
-                event2 = events2;
-                break;
-                
-            default:
-                NS_LOG_INFO("Not applying any selection policy");
+            return count;
+        }
+        if(count == 0)
+        {
+            return 0;
+        }
+        if(function == AGGREGATE_SUM)
+        {
+            return sum;
+        }
+        if(function == AGGREGATE_AVG)
+        {
+            return sum / count;
         }
         
-    }
-    
-    void
-    BufferManager::put_event(Ptr<Event> e)
-    {
-        if(events1.empty() && events2.empty())
+        if(!window)
         {
-            events1.push_back(e);
+            return extreme;
         }
-        else if ((events1.empty()) && (!events2.empty()))
+        if(front.empty())
         {
-            if(events2.front()->type == e->type)
-            {
-                events2.push_back(e);
-            }
-            else
-            {
-                events1.push_back(e);
-            }
+            return back.back().aggregate;
         }
-        else if ((!events1.empty()) && (events2.empty()))
+        if(back.empty())
         {
-            if(events1.front()->type == e->type)
-            {
-                events1.push_back(e);
-            }
-            else
-            {
-                events2.push_back(e);
-            }
+            return front.back().aggregate;
         }
-        else
+        return Combine(front.back().aggregate, back.back().aggregate);
+    }
+    
+    void
+    AggregateOperator::Report(std::vector<Ptr<Event> >& returned)
+    {
+        Ptr<Event> e = Create<Event>();
+        e->type = event1;
+        e->value = GetValue();
+        if(last)
         {
-            NS_LOG_INFO("unknown type");
+            e->m_seq = last->m_seq;
+            e->delay = last->delay;
+            e->hopsCount = last->hopsCount;
         }
-
+        returned.push_back(e);
     }
     
     void
-    BufferManager::clean_up()
+    AggregateOperator::PeriodicReport()
     {
-        switch(consumption_policy)
+        if(count > 0 && !emit.IsNull())
         {
-            case SELECTED_CONSUMPTION:
-                NS_LOG_INFO("Applying consumption policy " << SELECTED_CONSUMPTION);
-                events1.clear();
-                events2.clear();
-                break;
-                
-            default:
-                NS_LOG_INFO("Not applying any consumption policy");
-                
+            std::vector<Ptr<Event> > returned;
+            Report(returned);
+            emit(this, returned);
         }
-        
+        report_event = Simulator::Schedule(report_period, &AggregateOperator::PeriodicReport, this);
     }
-      
+    
+    
     /***************************PRODUCER **************
      * ***************************************************
      * *************************************************************/
@@ -482,7 +1808,7 @@ NS_LOG_COMPONENT_DEFINE ("Detector");
         if(q->actionType == NOTIFICATION)
         {
             
-            Ptr<Event> new_event = CreateObject<Event>();
+            Ptr<Event> new_event = Create<Event>();
             uint64_t delay = 0;
             uint32_t hops = 0;
             for(std::vector<Ptr<Event>>::iterator it = events.begin();
@@ -509,6 +1835,7 @@ NS_LOG_COMPONENT_DEFINE ("Detector");
             }
             
             new_event->m_seq = events.back()->m_seq;
+            new_event->value = events.back()->value;
             
             Ptr<Forwarder> forwarder = GetObject<Forwarder>();
             forwarder->ForwardNewEvent(new_event);
@@ -579,15 +1906,40 @@ NS_LOG_COMPONENT_DEFINE ("Detector");
     /************** EVENT **************
      * ***********************************************
      * *************************************************/
-    TypeId
-    Event::GetTypeId(void)
+    /* upper bound on the number of released events kept for reuse */
+    const uint32_t Event::FREE_LIST_CAPACITY;
+    std::vector<void*> Event::free_list;
+    
+    void*
+    Event::operator new (size_t size)
     {
-        static TypeId tid = TypeId("ns3::Event")
-        .SetParent<Object> ()
-        .AddConstructor<Event> ()
-        ;
+        if((size != sizeof(Event)) || free_list.empty())
+        {
+            return ::operator new (size);
+        }
         
-        return tid;
+        void *p = free_list.back();
+        free_list.pop_back();
+        return p;
+    }
+    
+    void
+    Event::operator delete (void *p)
+    {
+        if(free_list.size() < FREE_LIST_CAPACITY)
+        {
+            free_list.push_back(p);
+        }
+        else
+        {
+            ::operator delete (p);
+        }
+    }
+    
+    uint32_t
+    Event::GetFreeListSize()
+    {
+        return free_list.size();
     }
     
     Event::Event(Ptr<Event> e)
@@ -596,11 +1948,42 @@ NS_LOG_COMPONENT_DEFINE ("Detector");
         event_class = e->event_class;
         delay = e->delay;
         hopsCount = e->hopsCount;
-        e->m_seq = m_seq;
+        prevHopsCount = e->prevHopsCount;
+        m_seq = e->m_seq;
+        value = e->value;
+        arrival = e->arrival;
+        std::memcpy(attributes, e->attributes, sizeof(attributes));
     }
     
     Event::Event()
-    {}
+    : type(NO_EVENT_TYPE),
+      m_seq(0),
+      delay(0),
+      event_class(ATOMIC_EVENT),
+      hopsCount(0),
+      prevHopsCount(0),
+      value(0)
+    {
+        std::memset(attributes, 0, sizeof(attributes));
+    }
+    
+    void
+    Event::SetAttribute(const std::string &name, double value)
+    {
+        attributes[EventTypeTable::InternAttribute(type, name)] = value;
+    }
+    
+    bool
+    Event::GetAttribute(const std::string &name, double &value) const
+    {
+        uint32_t index;
+        if(!EventTypeTable::LookupAttribute(type, name, index))
+        {
+            return false;
+        }
+        value = attributes[index];
+        return true;
+    }
     
     void 
     Event::operator=(Ptr<Event> e)
@@ -611,39 +1994,38 @@ NS_LOG_COMPONENT_DEFINE ("Detector");
     uint32_t
     Event::getSize()
     { 
-        return (type.size()+sizeof(int64_t)+sizeof(uint32_t));
+        return serialize().GetSerializedSize();
     }
     
-    SerializedEvent*
+    SerializedEvent
     Event::serialize()
     {
-        
-        SerializedEvent *message = new SerializedEvent();
-        message->type = this->type;
-        message->event_class = this->event_class;
-        message->size = sizeof(SerializedEvent);
-        message->delay = this->delay;
-        message->hopsCount = this->hopsCount;
-        message->prevHopsCount = this->prevHopsCount;
-        message->m_seq = this->m_seq;
-        NS_LOG_INFO("serialized type " << message->type);
+        SerializedEvent message;
+        message.type = this->type;
+        message.event_class = this->event_class;
+        message.delay = this->delay;
+        message.hopsCount = this->hopsCount;
+        message.prevHopsCount = this->prevHopsCount;
+        message.m_seq = this->m_seq;
+        message.value = this->value;
+        message.attribute_count = EventTypeTable::GetAttributeCount(this->type);
+        std::memcpy(message.attributes, attributes, sizeof(attributes));
         
         return message;
-       
     }
     
     void
-    Event::deserialize(uint8_t *buffer, uint32_t size)
+    Event::deserialize(const SerializedEvent &message)
     {
-        SerializedEvent *message = new SerializedEvent;
-        
-        memcpy(message, buffer, size);
-        this->type = message->type;
-        this->delay = message->delay;
-        this->m_seq = message->m_seq;
-        this->hopsCount = message->hopsCount;
-        this->prevHopsCount = message->prevHopsCount;
-        this->event_class = message->event_class;
+        this->type = message.type;
+        this->delay = message.delay;
+        this->m_seq = message.m_seq;
+        this->hopsCount = message.hopsCount;
+        this->prevHopsCount = message.prevHopsCount;
+        this->event_class = message.event_class;
+        this->value = message.value;
+        std::memset(attributes, 0, sizeof(attributes));
+        std::memcpy(attributes, message.attributes, message.attribute_count * sizeof(double));
     }
     
     void
@@ -654,6 +2036,8 @@ NS_LOG_COMPONENT_DEFINE ("Detector");
         e->m_seq = m_seq;
         e->prevHopsCount = prevHopsCount;
         e->delay = delay;
+        e->value = value;
+        std::memcpy(e->attributes, attributes, sizeof(attributes));
     }
     
     
@@ -662,6 +2046,23 @@ NS_LOG_COMPONENT_DEFINE ("Detector");
      * ***********************************************
      * *************************************************/
     Query::Query()
+    : id(0),
+      actionType(0),
+      eventType(NO_EVENT_TYPE),
+      isAtomic(false),
+      inputStream1_rate(0),
+      inputStream2_rate(0),
+      output_rate(0),
+      placement_steps(0),
+      inevent1(NO_EVENT_TYPE),
+      inevent2(NO_EVENT_TYPE),
+      parent_output(NO_EVENT_TYPE),
+      window_type(NO_WINDOW),
+      window_mode(SLIDING_WINDOW),
+      window_count(0),
+      threshold(0),
+      isFinal(false),
+      assigned(false)
     {
     }
     Query::Query(Ptr<Query> q)
@@ -672,8 +2073,22 @@ NS_LOG_COMPONENT_DEFINE ("Detector");
         this->isAtomic = q->isAtomic;
         this->isFinal = q->isFinal;
         this->output_dest = q->output_dest;
+        this->other_parent_outputs = q->other_parent_outputs;
+        this->other_output_dests = q->other_output_dests;
         this->assigned = q->assigned;
         this->currentHost = q->currentHost;
+        this->inputStream1_rate = q->inputStream1_rate;
+        this->inputStream2_rate = q->inputStream2_rate;
+        this->output_rate = q->output_rate;
+        this->placement_steps = q->placement_steps;
+        this->window_type = q->window_type;
+        this->window_mode = q->window_mode;
+        this->window_length = q->window_length;
+        this->window_count = q->window_count;
+        this->inevents = q->inevents;
+        this->filter = q->filter;
+        this->threshold = q->threshold;
+        this->report_period = q->report_period;
     }
     
     
@@ -681,67 +2096,78 @@ NS_LOG_COMPONENT_DEFINE ("Detector");
     uint32_t 
     Query::getSerializedSize()
     {
-        uint32_t size = eventType.size()+inevent1.size()+inevent2.size()+
-                (sizeof(uint32_t)*3)+sizeof(bool);
-        return size;
+        return serialize().GetSerializedSize();
     }
     
-    SerializedQuery*
+    SerializedQuery
     Query::serialize()
     {
-        SerializedQuery * message = new SerializedQuery();
-        
+        SerializedQuery message;
         
-        output_dest.Serialize(message->output_dest);
-        inputStream1_address.Serialize(message->inputStream1_address);
-        inputStream2_address.Serialize(message->inputStream2_address);
-        currentHost.Serialize(message->currentHost);
-        message->actionType = this->actionType;
-        message->eventType = this->eventType;
-        message->q_id = this->id;
-        message->isFinal = this->isFinal;
-        message->isAtomic = this->isAtomic;
-        message->inevent1 = this->inevent1;
-        message->inevent2 = this->inevent2;
-        message->op = this->op;
-        message->assigned = this->assigned;
-        
-        message->parent_output = this->parent_output;
-        message->size = sizeof(SerializedQuery);
+        message.output_dest = output_dest;
+        message.inputStream1_address = inputStream1_address;
+        message.inputStream2_address = inputStream2_address;
+        message.currentHost = currentHost;
+        message.inputStream1_rate = inputStream1_rate;
+        message.inputStream2_rate = inputStream2_rate;
+        message.output_rate = output_rate;
+        message.placement_steps = placement_steps;
+        message.actionType = this->actionType;
+        message.eventType = this->eventType;
+        message.q_id = this->id;
+        message.isFinal = this->isFinal;
+        message.isAtomic = this->isAtomic;
+        message.inevent1 = this->inevent1;
+        message.inevent2 = this->inevent2;
+        message.op = this->op;
+        message.window_type = this->window_type;
+        message.window_mode = this->window_mode;
+        message.window_length = this->window_length.GetMilliSeconds();
+        message.window_count = this->window_count;
+        message.assigned = this->assigned;
+        message.parent_output = this->parent_output;
+        message.other_parent_outputs = this->other_parent_outputs;
+        message.other_output_dests = this->other_output_dests;
+        message.inevents = this->inevents;
+        message.filter = this->filter;
+        message.threshold = this->threshold;
+        message.report_period = this->report_period.GetMilliSeconds();
         
         return message;
     }
     
     void
-    Query::deserialize(uint8_t *buffer, uint32_t size)
-    {
-        NS_LOG_INFO ("1");
-       SerializedQuery *message = new SerializedQuery();
-        memcpy(message, buffer, size);
-        NS_LOG_INFO("DESERIALIZED MESSAGE " << message->eventType);
-        this->actionType = message->actionType;
-        NS_LOG_INFO ("1");
-        this->id = message->q_id;
-        NS_LOG_INFO ("1");
-        this->isFinal = message->isFinal;
-        NS_LOG_INFO ("1");
-        this->isAtomic = message->isAtomic;
-        NS_LOG_INFO ("1");
-        this->eventType = message->eventType;
-        NS_LOG_INFO ("1");
-        
-        this->output_dest = Ipv4Address::Deserialize(message->output_dest);
-        this->inputStream1_address = Ipv4Address::Deserialize(message->inputStream1_address);
-        this->inputStream2_address = Ipv4Address::Deserialize(message->inputStream2_address);
-        this->currentHost = Ipv4Address::Deserialize(message->currentHost);
-        NS_LOG_INFO ("1");
-        this->inevent1 = message->inevent1;
-        this->inevent2 = message->inevent2;
-        this->parent_output = message->parent_output;
-        NS_LOG_INFO ("1");
-        this->op = message->op;
-        this->assigned = message->assigned;
-        NS_LOG_INFO ("1");
+    Query::deserialize(const SerializedQuery &message)
+    {
+        NS_LOG_INFO("DESERIALIZED MESSAGE " << EventTypeTable::GetName(message.eventType));
+        this->actionType = message.actionType;
+        this->id = message.q_id;
+        this->isFinal = message.isFinal;
+        this->isAtomic = message.isAtomic;
+        this->eventType = message.eventType;
+        this->output_dest = message.output_dest;
+        this->inputStream1_address = message.inputStream1_address;
+        this->inputStream2_address = message.inputStream2_address;
+        this->currentHost = message.currentHost;
+        this->inputStream1_rate = message.inputStream1_rate;
+        this->inputStream2_rate = message.inputStream2_rate;
+        this->output_rate = message.output_rate;
+        this->placement_steps = message.placement_steps;
+        this->inevent1 = message.inevent1;
+        this->inevent2 = message.inevent2;
+        this->parent_output = message.parent_output;
+        this->other_parent_outputs = message.other_parent_outputs;
+        this->other_output_dests = message.other_output_dests;
+        this->inevents = message.inevents;
+        this->filter = message.filter;
+        this->threshold = message.threshold;
+        this->report_period = MilliSeconds(message.report_period);
+        this->op = message.op;
+        this->window_type = message.window_type;
+        this->window_mode = message.window_mode;
+        this->window_length = MilliSeconds(message.window_length);
+        this->window_count = message.window_count;
+        this->assigned = message.assigned;
     }
     
 }
@@ -21,47 +21,211 @@
 
 #include "ns3/object.h"
 #include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/callback.h"
+#include "ns3/simple-ref-count.h"
+#include "event-type.h"
+#include "message-types.h"
+#include <unordered_map>
+#include <deque>
 namespace ns3 {
 
     class Event;
     class EventPattern;
     class CepOperator;
-    class SerializedEvent;
-    class SerializedQuery;
     
-    class Window : public Object{
-    public:
-        static TypeId GetTypeId (void);
-        std::vector<Event> buffer;
-        
-    };
-    
-     class Event : public Object{
+    /**
+     * CEP events are created and released at a high rate on the event path,
+     * so they are plain reference counted objects rather than full ns3 
+     * Objects: use Create<Event> () to get one. The memory of released 
+     * events is kept on a free list and recycled by the next allocation.
+     */
+     class Event : public SimpleRefCount<Event>{
     public:
-        static TypeId GetTypeId (void);
-        
         Event(Ptr<Event>);
         Event();
         void operator=(Ptr<Event>);
-        SerializedEvent* serialize();
-        void deserialize(uint8_t*, uint32_t);
+        SerializedEvent serialize();
+        void deserialize(const SerializedEvent &message);
         uint32_t getSize();
         void CopyEvent (Ptr<Event> e);
         
-        std::string type; //the type of the event
+        EventTypeId type; //the type of the event
         uint64_t m_seq;
-        uint64_t delay;
+        uint64_t delay; //in microseconds, links and CPU of every hop
         uint32_t event_class;
         int32_t hopsCount;
         int32_t prevHopsCount;
+        double value; //the reading carried by the event, see AggregateOperator
+        /* 
+         * when the operator holding the event received it, only set in
+         * the state exported by an operator, see CepOperator::ExportState
+         */
+        Time arrival;
+        /* payload attributes, in the order of the schema of the event type */
+        double attributes[MAX_EVENT_ATTRIBUTES];
+        
+        void SetAttribute(const std::string &name, double value);
+        /* false if the type of the event has no such attribute */
+        bool GetAttribute(const std::string &name, double &value) const;
+        
+        static void* operator new (size_t size);
+        static void operator delete (void *p);
+        /* the released events waiting to be recycled */
+        static uint32_t GetFreeListSize();
+        /* at most this many released events are kept */
+        static const uint32_t FREE_LIST_CAPACITY = 65536;
+        
+    private:
+        static std::vector<void*> free_list;
+    };
+    
+    /**
+     * A window bounds the events an operator keeps for one input stream.
+     * Windows are either time based (the events received in the last 
+     * length seconds) or count based (the last count events), and either
+     * sliding (events expire one by one) or tumbling (the whole window is
+     * emptied once it is over).
+     * Events are kept in arrival order, so inserting and expiring an event
+     * are O(1) amortized. Time windows expire events as simulation time
+     * advances, even when no new event arrives.
+     * Every event leaving the window is reported to the evict callback so 
+     * that the owner can drop it from its own indexes.
+     */
+    class Window : public Object{
+    public:
+        static TypeId GetTypeId (void);
+        
+        Window();
+        void Configure(uint32_t type, uint32_t mode, Time length, uint32_t count);
+        void SetEvictCallback(Callback<void, Ptr<Event> > cb);
+        void Insert(Ptr<Event> e);
+        /* evicts the events which are out of the window at the current time */
+        void Expire();
+        uint32_t GetSize();
+        /* 
+         * appends the events in the window, oldest first, with the time
+         * they entered it in Event::arrival
+         */
+        void GetEvents(std::vector<Ptr<Event> >& events);
+        /* 
+         * while set, Insert takes the time an event entered the window 
+         * from Event::arrival rather than the clock, see GetEvents
+         */
+        void SetRestoring(bool restoring);
+        
+    protected:
+        virtual void DoDispose (void);
+        
+    private:
+        void Evict();
+        void ScheduleExpiry();
+        
+        class WindowEntry
+        {
+        public:
+            Ptr<Event> event;
+            Time arrival;
+        };
+        
+        uint32_t window_type;
+        uint32_t window_mode;
+        Time length;
+        uint32_t count;
+        Time window_start;//tumbling time windows only
+        bool restoring;
+        std::deque<WindowEntry> buffer;
+        EventId expiry_event;
+        Callback<void, Ptr<Event> > evicted;
+        
+    };
+    
+    /**
+     * A partial match is kept as a chain of the events it has taken so
+     * far, newest first. Chains are immutable, so runs extending the same
+     * prefix share its nodes and events are referenced, never copied.
+     */
+    class MatchNode : public SimpleRefCount<MatchNode>{
+    public:
+        MatchNode(Ptr<Event> e, Ptr<MatchNode> prev);
+        
+        Ptr<Event> event;
+        Ptr<MatchNode> prev;
+        uint32_t length;
+    };
+    
+    /**
+     * Nondeterministic automaton matching a sequence of event types, where 
+     * a state may carry a Kleene plus (one or more events of its type).
+     * The automaton follows the skip-till-next-match strategy: an event is
+     * taken by the oldest run that can use it, preferring the runs closest
+     * to completion, and otherwise starts a new run.
+     * Runs are bucketed by the number of states they matched so the
+     * work per event is bounded by the length of the pattern. The number
+     * of runs is bounded by MaxRuns and, when a window is set, runs are
+     * dropped once they span more than the window.
+     */
+    class PatternAutomaton : public Object{
+    public:
+        static TypeId GetTypeId (void);
+        
+        PatternAutomaton();
+        void AddState(EventTypeId type, bool kleenePlus);
+        void SetWindow(uint32_t type, Time length, uint32_t count);
+        bool ExpectingEvent(EventTypeId type);
+        /**
+         * feeds e to the automaton. Returns true and fills match with the
+         * events of the run, oldest first, when e completes a run.
+         */
+        bool Advance(Ptr<Event> e, std::vector<Ptr<Event> >& match);
+        uint32_t GetRunCount();
+        /**
+         * appends the events of the runs, run after run from the oldest 
+         * one, with the time the run started in Event::arrival. Advancing
+         * a new automaton with them, restoring, rebuilds the same runs.
+         */
+        void GetEvents(std::vector<Ptr<Event> >& events);
+        /* while set, a run starts at the Event::arrival of its first event */
+        void SetRestoring(bool restoring);
+        
+    private:
+        class PatternState
+        {
+        public:
+            EventTypeId type;
+            bool kleenePlus;
+        };
+        
+        class Run
+        {
+        public:
+            Ptr<MatchNode> last;
+            Time start;
+        };
+        
+        void Expire();
+        void DropOldestRun();
+        bool Complete(Run &run, uint32_t matched, std::vector<Ptr<Event> >& match);
+        
+        std::vector<PatternState> states;
+        /* runs[k] holds the runs which matched the first k states, oldest first */
+        std::vector<std::deque<Run> > runs;
+        uint32_t run_count;
+        uint32_t max_runs;
+        bool restoring;
+        uint32_t window_type;
+        Time window_length;
+        uint32_t window_count;
     };
     
     class EventPattern : public Object{
         
     public:
         static TypeId GetTypeId (void);
-        std::vector<std::string> eventTypes;
+        std::vector<EventTypeId> eventTypes;
         
         std::string op;
        // std::string temporalConstraintValue;
@@ -78,16 +242,55 @@ namespace ns3 {
         Query();
         uint32_t id;
         uint32_t actionType;
-        std::string eventType;
+        EventTypeId eventType;
         bool isAtomic;
         Ipv4Address output_dest;
         Ipv4Address inputStream1_address;
         Ipv4Address inputStream2_address;
         Ipv4Address currentHost;
-        std::string inevent1;
-        std::string inevent2;
-        std::string parent_output;
+        /*
+         * estimated rates (events per second) of the input and output 
+         * streams, and the number of hops the query travelled while 
+         * being placed, see DistributedPlacementPolicy
+         */
+        double inputStream1_rate;
+        double inputStream2_rate;
+        double output_rate;
+        uint32_t placement_steps;
+        EventTypeId inevent1;
+        EventTypeId inevent2;
+        EventTypeId parent_output;
+        /*
+         * an atomic query read by several operators goes to the one of
+         * parent_output and to these, at other_output_dests once placed
+         */
+        std::vector<EventTypeId> other_parent_outputs;
+        std::vector<Ipv4Address> other_output_dests;
+        /*
+         * the input event types of n-ary operators such as seq, in
+         * pattern order.
+         */
+        std::vector<EventTypeId> inevents;
         std::string op;
+        /*
+         * conjunction of comparisons on the attributes of the input 
+         * events, e.g. "A.temp > 30 && A.zone == 4", see EventFilter.
+         */
+        std::string filter;
+        /*
+         * the window applied to the input streams of the operator
+         */
+        uint32_t window_type;
+        uint32_t window_mode;
+        Time window_length;
+        uint32_t window_count;
+        /*
+         * aggregation operators only: the event of type above is 
+         * produced when the aggregate rises above threshold or, if 
+         * report_period is set, every period.
+         */
+        double threshold;
+        Time report_period;
         /*
          * the event notification for the event of type above is the
          * one the sink is interested in.
@@ -95,8 +298,8 @@ namespace ns3 {
         bool isFinal;
         bool assigned;
         
-        SerializedQuery* serialize();
-        void deserialize(uint8_t *buffer, uint32_t);
+        SerializedQuery serialize();
+        void deserialize(const SerializedQuery &message);
         uint32_t getSerializedSize();
          
     };
@@ -107,8 +310,30 @@ class CEPEngine : public Object
         static TypeId GetTypeId (void);
         CEPEngine();
         void Configure();
+        /**
+         * events are processed by a single CPU server. They wait in a FIFO
+         * queue of at most ExecutionQueueCapacity events, then occupy the
+         * server for OperatorCost plus BufferedEventCost per event held 
+         * by each operator they are fed to, after which the operators see
+         * them. The time spent is added to the delay of the event. With
+         * both costs zero, events are processed as soon as they arrive.
+         */
         void ProcessCepEvent(Ptr<Event> e);
-        void GetOpsByInputEventType(std::string eventType, std::vector<Ptr<CepOperator> >& ops);
+        /**
+         * removes the queued events of the given types no operator consumes
+         * anymore, e.g. the inputs of a query after RemoveQuery, and appends
+         * them to events in arrival order.
+         */
+        void TakeOrphanedEvents(const std::vector<EventTypeId>& types, 
+                std::vector<Ptr<Event> >& events);
+        /**
+         * returns the operators subscribed to events of the given type.
+         * The returned vector is owned by the engine's subscription index
+         * and must not be modified by the caller. RecvQuery and RemoveQuery
+         * invalidate it, so callers which may reach them while iterating
+         * must copy it first, see Detector::ProcessEvent.
+         */
+        const std::vector<Ptr<CepOperator> >& GetOpsByInputEventType(EventTypeId eventType);
         
         /**
          * this method instantiates the query and 
@@ -117,6 +342,19 @@ class CEPEngine : public Object
          * the query to instantiate
          */
         void RecvQuery(Ptr<Query>);
+        /**
+         * removes the query and detaches its operator, unless other 
+         * queries share it. The events buffered by the operator are
+         * appended to state, see CepOperator::ExportState.
+         */
+        void RemoveQuery(Ptr<Query> q, std::vector<Ptr<Event> >& state);
+        /**
+         * feeds the state exported by the operator of q on another node 
+         * to the operator of q. The events keep the windows and runs they
+         * were in there, from the time in Event::arrival. The matches it
+         * completes were already reported there and are dropped.
+         */
+        void RestoreState(Ptr<Query> q, const std::vector<Ptr<Event> >& state);
         TracedCallback< Ptr<Event> > nevent;
         
         
@@ -126,10 +364,48 @@ private:
     
     void ForwardProducedEvent(Ptr<Event>);
     void InstantiateQuery(Ptr<Query> q);
+    static std::string GetSignature(Ptr<Query> q);
     void StoreQuery(Ptr<Query> q);
+    void Subscribe(EventTypeId eventType, Ptr<CepOperator> op);
     Ptr<Query> GetQuery(uint32_t id);
+    Ptr<CepOperator> GetOperator(uint32_t queryId);
     std::vector<Ptr<Query> > queryPool;
     std::vector<Ptr<CepOperator> > ops_queue;
+    /*
+     * subscription index: event type id -> operators expecting it.
+     * Kept up to date by InstantiateQuery.
+     */
+    std::vector<std::vector<Ptr<CepOperator> > > subscriptions;
+    std::vector<Ptr<CepOperator> > no_subscribers;
+    /*
+     * operators by signature, queries with the same sub-pattern share 
+     * one operator and its buffers.
+     */
+    std::unordered_map<std::string, Ptr<CepOperator> > shared_ops;
+    
+    class QueuedEvent
+    {
+    public:
+        Ptr<Event> event;
+        Time arrival;
+    };
+    
+    /* the time the CPU takes to process e */
+    Time GetServiceTime(Ptr<Event> e);
+    void StartService();
+    void FinishService();
+    /* e is of one of types and no operator consumes it anymore */
+    bool IsOrphaned(Ptr<Event> e, const std::vector<EventTypeId>& types);
+    
+    Time operatorCost;
+    Time bufferedEventCost;
+    uint32_t queueCapacity;
+    std::deque<QueuedEvent> executionQueue;
+    /* the event being processed, 0 when the CPU is idle */
+    QueuedEvent inService;
+    EventId serviceEvent;
+    TracedValue<uint32_t> cpuDrops;
+    TracedCallback<Time> processingDelay;
       
     };
     class Forwarder  : public Object
@@ -150,6 +426,8 @@ private:
     public:
         static TypeId GetTypeId (void);
         void ProcessEvent(Ptr<Event> e);
+        /* hands the events matched by op to the producer */
+        void EmitMatch(Ptr<CepOperator> op, std::vector<Ptr<Event> > events);
        
     };
     
@@ -157,10 +435,23 @@ private:
     public:
         static TypeId GetTypeId (void);
         
-        void configure(Ptr<CepOperator> op);
+        void configure(EventTypeId event1, EventTypeId event2);
+        /* bounds both input buffers with a window, see Window */
+        void configure_window(uint32_t type, uint32_t mode, Time length, uint32_t count);
+        /* see Window::SetRestoring */
+        void set_restoring(bool restoring);
         void read_events(std::vector<Ptr<Event> >& event1, 
         std::vector<Ptr<Event> >& event2);
         void put_event(Ptr<Event>);
+        /* appends the buffered events of both streams */
+        void get_events(std::vector<Ptr<Event> >& events);
+        uint32_t get_size();
+        /**
+         * KEYED_SELECTION only: removes and returns the buffered event 
+         * of the other input stream with the same sequence number as e, 
+         * or 0 if there is none.
+         */
+        Ptr<Event> consume_match(Ptr<Event> e);
         void clean_up();
         uint32_t consumption_policy;
         uint32_t selection_policy;
@@ -169,17 +460,92 @@ private:
         
     private:
         friend class CepOperator;
+        typedef std::unordered_multimap<uint64_t, Ptr<Event> > KeyedBuffer;
+        
+        EventTypeId type1;
+        EventTypeId type2;
+        KeyedBuffer keyed1;
+        KeyedBuffer keyed2;
+        Ptr<Window> window1;
+        Ptr<Window> window2;
+        
+        void expire_windows();
+        void evict_event(Ptr<Event> e);
           
     };
     
+    /**
+     * A conjunction of comparisons between event attributes and constants,
+     * such as "A.temp > 30 && A.zone == 4". The attribute "value" refers
+     * to Event::value.
+     * The expression is compiled once, when the query is instantiated, into
+     * (event type, attribute index, comparison, constant) terms so that
+     * accepting an event only takes a few array reads and comparisons.
+     * Terms on other types than the one of the event are ignored.
+     */
+    class EventFilter : public SimpleRefCount<EventFilter>
+    {
+    public:
+        /* aborts on malformed expressions */
+        static Ptr<EventFilter> Compile(const std::string &expression);
+        bool Accept(Ptr<Event> e) const;
+        uint32_t GetSize() const;
+        
+    private:
+        enum Comparison {
+            EQUAL,
+            NOT_EQUAL,
+            LESS,
+            LESS_EQUAL,
+            GREATER,
+            GREATER_EQUAL
+        };
+        
+        class Term
+        {
+        public:
+            EventTypeId type;
+            uint32_t attribute;
+            Comparison comparison;
+            double constant;
+        };
+        
+        void AddTerm(const std::string &term);
+        
+        std::vector<Term> terms;
+    };
+    
     class CepOperator: public Object {
     public:
         static TypeId GetTypeId ();
         
         virtual void Configure (Ptr<Query>) = 0;
         virtual bool Evaluate(Ptr<Event> e, std::vector<Ptr<Event> >&) = 0; 
-        virtual bool ExpectingEvent (std::string) = 0;
-        uint32_t queryId;
+        virtual bool ExpectingEvent (EventTypeId) = 0;
+        /**
+         * appends the events the operator keeps, in an order such that 
+         * evaluating them again rebuilds its state. Operators which keep
+         * nothing have no state.
+         */
+        virtual void ExportState (std::vector<Ptr<Event> >& state);
+        /*
+         * while set, the events evaluated are an exported state and the
+         * windows they enter keep the times they entered the exporting
+         * operator, see Window::SetRestoring
+         */
+        virtual void SetRestoring (bool restoring);
+        /* 
+         * the number of events or partial matches the operator holds,
+         * which the processing cost of an event grows with, see CEPEngine
+         */
+        virtual uint32_t GetBufferedEvents ();
+        /*
+         * the queries sharing this operator, each of them produces its
+         * own event out of every match.
+         */
+        std::vector<uint32_t> queryIds;
+        /* events rejected by the filter are dropped before Evaluate */
+        Ptr<EventFilter> filter;
     };
     
     class AndOperator: public CepOperator {
@@ -188,12 +554,14 @@ private:
         
         void Configure (Ptr<Query>);
         bool Evaluate (Ptr<Event> e, std::vector<Ptr<Event> >&); 
-        bool ExpectingEvent (std::string);
-        std::string event1;
-        std::string event2;
+        bool ExpectingEvent (EventTypeId);
+        void ExportState (std::vector<Ptr<Event> >& state);
+        void SetRestoring (bool restoring);
+        uint32_t GetBufferedEvents ();
+        EventTypeId event1;
+        EventTypeId event2;
         
     private:
-        uint32_t queryId;
         //std::string first;
         Ptr<BufferManager> bufman;
         
@@ -205,16 +573,119 @@ private:
         
         void Configure (Ptr<Query>);
         bool Evaluate(Ptr<Event> e, std::vector<Ptr<Event> >&); 
-        bool ExpectingEvent (std::string);
-        std::string event1;
-        std::string event2;
+        bool ExpectingEvent (EventTypeId);
+        EventTypeId event1;
+        EventTypeId event2;
     
     private:
-        uint32_t queryId;
         //std::string first;
         Ptr<BufferManager> bufman;
     };
     
+    /**
+     * seq(E1, ..., En): the events of types E1 to En, in this order.
+     */
+    class SeqOperator: public CepOperator {
+    public:
+        static TypeId GetTypeId ();
+        
+        void Configure (Ptr<Query>);
+        bool Evaluate(Ptr<Event> e, std::vector<Ptr<Event> >&); 
+        bool ExpectingEvent (EventTypeId);
+        void ExportState (std::vector<Ptr<Event> >& state);
+        void SetRestoring (bool restoring);
+        uint32_t GetBufferedEvents ();
+        
+    private:
+        Ptr<PatternAutomaton> nfa;
+    };
+    
+    /**
+     * kleene(A, B), i.e. seq(A+, B): one or more events of type A 
+     * followed by an event of type B. All the A events of the 
+     * match are reported together with B.
+     */
+    class KleeneOperator: public CepOperator {
+    public:
+        static TypeId GetTypeId ();
+        
+        void Configure (Ptr<Query>);
+        bool Evaluate(Ptr<Event> e, std::vector<Ptr<Event> >&); 
+        bool ExpectingEvent (EventTypeId);
+        void ExportState (std::vector<Ptr<Event> >& state);
+        void SetRestoring (bool restoring);
+        uint32_t GetBufferedEvents ();
+        
+    private:
+        Ptr<PatternAutomaton> nfa;
+    };
+    
+    /**
+     * count, sum, avg, min and max of the values of the events of 
+     * type inevent1 over the query window (over all the events seen when
+     * the query has no window).
+     * count, sum and avg are maintained by subtracting evicted values. 
+     * min and max cannot be subtracted, so the window is mirrored by a 
+     * two-stack queue whose entries carry the min or max of the entries
+     * below them; the aggregate combines the tops of both stacks.
+     * Inserting or evicting an event is O(1) amortized, whatever the 
+     * window size.
+     * The operator reports a single event carrying the aggregate as its
+     * value, either when the aggregate rises above the query threshold or,
+     * when the query sets a report period, periodically.
+     */
+    class AggregateOperator: public CepOperator {
+    public:
+        static TypeId GetTypeId ();
+        
+        AggregateOperator();
+        void Configure (Ptr<Query>);
+        bool Evaluate(Ptr<Event> e, std::vector<Ptr<Event> >&); 
+        bool ExpectingEvent (EventTypeId);
+        /* only the events of the window, unbounded aggregates restart empty */
+        void ExportState (std::vector<Ptr<Event> >& state);
+        void SetRestoring (bool restoring);
+        uint32_t GetBufferedEvents ();
+        /* periodic reports are not triggered by an event, they go through cb */
+        void SetEmitCallback(Callback<void, Ptr<CepOperator>, std::vector<Ptr<Event> > > cb);
+        double GetValue();
+        uint32_t GetCount();
+        
+    protected:
+        virtual void DoDispose (void);
+        
+    private:
+        class StackEntry
+        {
+        public:
+            double value;
+            double aggregate;
+        };
+        
+        void Evict(Ptr<Event> e);
+        void Report(std::vector<Ptr<Event> >& returned);
+        void PeriodicReport();
+        double Combine(double a, double b);
+        
+        aggregate_function function;
+        EventTypeId event1;
+        Ptr<Window> window;
+        uint32_t count;
+        double sum;
+        /* two-stack queue, events are pushed on back and evicted from front */
+        std::vector<StackEntry> front;
+        std::vector<StackEntry> back;
+        /* running min/max of an unbounded aggregate, nothing is ever evicted */
+        double extreme;
+        Ptr<Event> last;
+        
+        double threshold;
+        bool above;
+        Time report_period;
+        EventId report_event;
+        Callback<void, Ptr<CepOperator>, std::vector<Ptr<Event> > > emit;
+    };
+    
     class Producer  : public Object
     {
     public:
@@ -34,6 +34,11 @@ namespace ns3 {
      */
 #define MULTIPLE_SELECTION 4
 #define SINGLE_SELECTION 5 
+    /**
+     * each buffer is indexed by the join key (the sequence number) so that
+     * a match is probed and consumed in constant time
+     */
+#define KEYED_SELECTION 6
 #define ACTIVATE 0
     
     enum OperatorState {
@@ -47,6 +52,25 @@ namespace ns3 {
         UNDEFINED,
         OUTPUT_CLOSED
     };
+    /**
+     * window policies of an operator's input buffers
+     */
+    enum window_type {
+        NO_WINDOW,
+        TIME_WINDOW,
+        COUNT_WINDOW
+    };
+    enum window_mode {
+        SLIDING_WINDOW,
+        TUMBLING_WINDOW
+    };
+    enum aggregate_function {
+        AGGREGATE_COUNT,
+        AGGREGATE_SUM,
+        AGGREGATE_AVG,
+        AGGREGATE_MIN,
+        AGGREGATE_MAX
+    };
     enum event_class {
         ATOMIC_EVENT,
         COMPOSITE_EVENT,
@@ -56,7 +80,31 @@ namespace ns3 {
     
     enum message_types {
         EVENT = 1,
-        QUERY
+        QUERY,
+        /* operator migration, see Placement::MigrateOperator */
+        MIGRATION,
+        RESUME,
+        REDIRECT,
+        REDIRECT_ACK,
+        STREAM_MOVED,
+        MIGRATION_ABORT,
+        /* the event types a datasource produces, see DataSource::Advertise */
+        ADVERTISEMENT,
+        /* several messages for one destination, see Communication::ScheduleSend */
+        BATCH,
+        /* a message sent until acknowledged, see Communication::EnqueuePacket */
+        RELIABLE,
+        ACK
+    };
+    
+    /* the classes of outgoing messages, from the most urgent */
+    enum traffic_class {
+        CONTROL_TRAFFIC,
+        QUERY_TRAFFIC,
+        FINAL_EVENT_TRAFFIC,
+        COMPOSITE_EVENT_TRAFFIC,
+        ATOMIC_EVENT_TRAFFIC,
+        TRAFFIC_CLASSES
     };
     
     
@@ -18,29 +18,32 @@
  */
 
 #include "communication.h"
-#include "ns3/drop-tail-queue.h"
 #include "ns3/type-id.h"
 #include "ns3/dcep.h"
 #include "dcep-header.h"
 #include "seq-ts-header.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/ipv4.h"
-#include "ns3/ipv4-header.h"
 #include "ns3/log.h"
 #include "cep-engine.h"
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
 #include "ns3/names.h"
 #include "ns3/uinteger.h"
+#include "ns3/string.h"
 #include "ns3/nstime.h"
+#include "ns3/data-rate.h"
 #include "placement.h"
+#include "resource-manager.h"
 #include "common.h"
 #include "message-types.h"
 #include "ns3/socket-factory.h"
-#include "src/internet/model/ipv4-header.h"
 #include <cstdlib>
 #include <cstdio>
 #include <ctime>
+#include <algorithm>
+#include <sstream>
+#include <cmath>
 #include "ns3/abort.h"
 #include "dcep-header.h"
 
@@ -49,6 +52,9 @@ namespace ns3 {
 NS_OBJECT_ENSURE_REGISTERED(Communication);
 NS_LOG_COMPONENT_DEFINE("Communication");
 
+/* the most messages received beyond the cumulative one an ack lists */
+static const uint32_t MAX_SELECTIVE_ACKS = 16;
+
 
 /* ... */
     TypeId
@@ -62,18 +68,116 @@ NS_LOG_COMPONENT_DEFINE("Communication");
                        Ipv4AddressValue (),
                        MakeIpv4AddressAccessor (&Communication::m_sinkAddress),
                        MakeIpv4AddressChecker ())
-        
+        .AddAttribute ("ControlQueueCapacity",
+                       "The number of control messages waiting for a destination beyond which new ones are dropped.",
+                       UintegerValue (100),
+                       MakeUintegerAccessor (&Communication::m_controlCapacity),
+                       MakeUintegerChecker<uint32_t> (1))
+        .AddAttribute ("QueryQueueCapacity",
+                       "The number of queries waiting for a destination beyond which new ones are dropped.",
+                       UintegerValue (100),
+                       MakeUintegerAccessor (&Communication::m_queryCapacity),
+                       MakeUintegerChecker<uint32_t> (1))
+        .AddAttribute ("FinalEventQueueCapacity",
+                       "The number of final event packets waiting for a destination beyond which new ones are dropped.",
+                       UintegerValue (100),
+                       MakeUintegerAccessor (&Communication::m_finalEventCapacity),
+                       MakeUintegerChecker<uint32_t> (1))
+        .AddAttribute ("CompositeEventQueueCapacity",
+                       "The number of composite event packets waiting for a destination beyond which new ones are dropped.",
+                       UintegerValue (100),
+                       MakeUintegerAccessor (&Communication::m_compositeEventCapacity),
+                       MakeUintegerChecker<uint32_t> (1))
+        .AddAttribute ("AtomicEventQueueCapacity",
+                       "The number of atomic event packets waiting for a destination beyond which new ones are dropped.",
+                       UintegerValue (100),
+                       MakeUintegerAccessor (&Communication::m_atomicEventCapacity),
+                       MakeUintegerChecker<uint32_t> (1))
+        .AddAttribute ("PacingRate",
+                       "The rate at which packets are released to the socket, zero sends them as fast as the socket takes them.",
+                       DataRateValue (DataRate (0)),
+                       MakeDataRateAccessor (&Communication::m_pacingRate),
+                       MakeDataRateChecker ())
+        .AddAttribute ("PacingBurst",
+                       "The number of bytes the pacer may release back to back.",
+                       UintegerValue (1500),
+                       MakeUintegerAccessor (&Communication::m_pacingBurst),
+                       MakeUintegerChecker<uint32_t> (1))
+        .AddAttribute ("SendRetryInterval",
+                       "The time after which a packet the socket refused is tried again, unless the socket reports it can send earlier.",
+                       TimeValue (MilliSeconds (10)),
+                       MakeTimeAccessor (&Communication::m_retryInterval),
+                       MakeTimeChecker ())
+        .AddAttribute ("MaxSendRetries",
+                       "The most times a packet the socket refused is tried again before it is dropped. "
+                       "Packets without a route wait for the routes to change instead when the node has a resource manager.",
+                       UintegerValue (10),
+                       MakeUintegerAccessor (&Communication::m_maxSendRetries),
+                       MakeUintegerChecker<uint32_t> ())
+        .AddAttribute ("BatchSize",
+                       "The number of bytes of events sent together to a destination, zero sends every event in its own packet.",
+                       UintegerValue (0),
+                       MakeUintegerAccessor (&Communication::m_batchSize),
+                       MakeUintegerChecker<uint32_t> ())
+        .AddAttribute ("BatchHoldTime",
+                       "The longest time an event waits for its batch to fill.",
+                       TimeValue (MilliSeconds (20)),
+                       MakeTimeAccessor (&Communication::m_batchHoldTime),
+                       MakeTimeChecker ())
+        .AddAttribute ("ReliableMessages",
+                       "The messages sent until acknowledged, a comma separated list of "
+                       "event, query, migration and advertisement. The others are sent once. "
+                       "A lost migration message stalls the operator until it is rolled back.",
+                       StringValue ("migration"),
+                       MakeStringAccessor (&Communication::m_reliableMessages),
+                       MakeStringChecker ())
+        .AddAttribute ("MaxRetransmissions",
+                       "The most times a reliable message is sent again before it is given up.",
+                       UintegerValue (5),
+                       MakeUintegerAccessor (&Communication::numRetransmissions),
+                       MakeUintegerChecker<uint32_t> ())
+        .AddAttribute ("InitialRto",
+                       "The retransmission timeout of a destination before any round trip is measured.",
+                       TimeValue (Seconds (1)),
+                       MakeTimeAccessor (&Communication::m_initialRto),
+                       MakeTimeChecker ())
+        .AddAttribute ("MinRto",
+                       "The lower bound of the retransmission timeout.",
+                       TimeValue (MilliSeconds (100)),
+                       MakeTimeAccessor (&Communication::m_minRto),
+                       MakeTimeChecker ())
+        .AddTraceSource ("QueueDrop",
+                       "A packet dropped because the queue of its traffic class was full.",
+                       MakeTraceSourceAccessor (&Communication::m_queueDrop))
+        .AddTraceSource ("SendDrops",
+                       "The number of packets dropped because the socket refused them too many times, or for good.",
+                       MakeTraceSourceAccessor (&Communication::m_sendDrops))
+        .AddTraceSource ("Retransmissions",
+                       "The number of reliable messages sent again.",
+                       MakeTraceSourceAccessor (&Communication::m_retransmissions))
+        .AddTraceSource ("ReliableDrops",
+                       "The number of reliable messages given up after MaxRetransmissions.",
+                       MakeTraceSourceAccessor (&Communication::m_reliableDrops))
         ;
         
         return tid;
     }
  
     Communication::Communication()
-   // : m_lossCounter (0)
+    : m_blocked(false),
+      m_routesSignalled(false),
+      m_sendDrops(0),
+      m_batchSize(0),
+      m_retransmissions(0),
+      m_reliableDrops(0)
     {
         numRetransmissions = 0;
         m_sent=0;
-        m_sendQueue = CreateObject<DropTailQueue> ();
+        m_stamped=0;
+        for(uint32_t i = 0; i < TRAFFIC_CLASSES; i++)
+        {
+            m_classes[i].drops = 0;
+        }
         
     }
     
@@ -81,7 +185,6 @@ NS_LOG_COMPONENT_DEFINE("Communication");
     Communication::~Communication()
     {
       //  m_lossCounter.~PacketLossCounter();
-        this->m_sendQueue->DequeueAll();
     }
     
     void
@@ -121,6 +224,49 @@ NS_LOG_COMPONENT_DEFINE("Communication");
         }
        
         m_socket->SetRecvCallback (MakeCallback (&Communication::HandleRead, this));
+        m_socket->SetSendCallback (MakeCallback (&Communication::SocketReady, this));
+        
+        Ptr<ResourceManager> rm = GetObject<ResourceManager>();
+        if(rm && rm->ReportsRouteChanges() && !m_routesSignalled)
+        {
+            rm->TraceConnectWithoutContext("RoutesChanged", 
+                    MakeCallback(&Communication::RoutesChanged, this));
+            m_routesSignalled = true;
+        }
+        
+        m_reliableTypes.clear();
+        std::istringstream names(m_reliableMessages);
+        std::string name;
+        while(std::getline(names, name, ','))
+        {
+            name.erase(0, name.find_first_not_of(" "));
+            name.erase(name.find_last_not_of(" ") + 1);
+            if(name == "event")
+            {
+                m_reliableTypes.insert(EVENT);
+            }
+            else if(name == "query")
+            {
+                m_reliableTypes.insert(QUERY);
+            }
+            else if(name == "migration")
+            {
+                m_reliableTypes.insert(MIGRATION);
+                m_reliableTypes.insert(RESUME);
+                m_reliableTypes.insert(REDIRECT);
+                m_reliableTypes.insert(REDIRECT_ACK);
+                m_reliableTypes.insert(STREAM_MOVED);
+                m_reliableTypes.insert(MIGRATION_ABORT);
+            }
+            else if(name == "advertisement")
+            {
+                m_reliableTypes.insert(ADVERTISEMENT);
+            }
+            else if(!name.empty())
+            {
+                NS_ABORT_MSG("UNKNOWN RELIABLE MESSAGE CLASS " << name);
+            }
+        }
         
     }
     
@@ -130,7 +276,6 @@ NS_LOG_COMPONENT_DEFINE("Communication");
     {
         NS_LOG_FUNCTION (this << socket);
         Ptr<Packet> packet, pcopy;
-        Ptr<Dcep> dcep = GetObject<Dcep>();
         
         Address from;
         while ((packet = socket->RecvFrom (from)))
@@ -139,11 +284,8 @@ NS_LOG_COMPONENT_DEFINE("Communication");
               {
                 SeqTsHeader seqTs;
                 DcepHeader dcepHeader;
-                Ipv4Header ipv4;
                 
                 packet->RemoveHeader(seqTs);
-                    
-                packet->RemoveHeader(ipv4);
                 packet->RemoveHeader(dcepHeader);
                 
                 Time delay = Simulator::Now() - seqTs.GetTs();
@@ -154,9 +296,7 @@ NS_LOG_COMPONENT_DEFINE("Communication");
                        << "s packet of type " << dcepHeader.GetContentType()
                        << " from "
                        << InetSocketAddress::ConvertFrom(from).GetIpv4 ()
-                           << " destination was "
-                           << ipv4.GetDestination()
-                           << "local address "
+                           << " local address "
                            << this->host_address
                                << "packet size "
                                << packet->GetSize()
@@ -164,9 +304,8 @@ NS_LOG_COMPONENT_DEFINE("Communication");
                            << delay.GetMilliSeconds()
                                );
                       
-                       uint8_t *buffer = new uint8_t[dcepHeader.GetContentSize()];
-                       packet->CopyData(buffer, dcepHeader.GetContentSize());
-                       dcep->rcvRemoteMsg(buffer,dcepHeader.GetContentSize(),dcepHeader.GetContentType(), delay.GetMilliSeconds());
+                       Deliver(packet, dcepHeader.GetContentType(), delay.GetMicroSeconds(),
+                               InetSocketAddress::ConvertFrom(from).GetIpv4 ());
                   
                 }
                }   
@@ -189,70 +328,632 @@ NS_LOG_COMPONENT_DEFINE("Communication");
 //    }
 //    
     
+    void
+    Communication::Deliver(Ptr<Packet> packet, uint16_t msg_type, uint64_t delay, Ipv4Address from)
+    {
+        switch(msg_type)
+        {
+            case BATCH:
+            {
+                while(packet->GetSize() > 0)
+                {
+                    SeqTsHeader seqTs;
+                    DcepHeader dcepHeader;
+                    packet->RemoveHeader(seqTs);
+                    packet->RemoveHeader(dcepHeader);
+                    Ptr<Packet> message = packet->CreateFragment(0, dcepHeader.GetContentSize());
+                    packet->RemoveAtStart(dcepHeader.GetContentSize());
+                    Deliver(message, dcepHeader.GetContentType(), 
+                            (Simulator::Now() - seqTs.GetTs()).GetMicroSeconds(), from);
+                }
+                break;
+            }
+            
+            case RELIABLE:
+                RecvReliable(packet, delay, from);
+                break;
+                
+            case ACK:
+            {
+                SerializedAck ack;
+                packet->RemoveHeader(ack);
+                RecvAck(ack, from);
+                break;
+            }
+            
+            default:
+                GetObject<Dcep>()->rcvRemoteMsg(packet, msg_type, delay);
+        }
+    }
+    
+    Ptr<Packet>
+    Communication::MakeReliable(Ptr<Packet> p, Ipv4Address addr)
+    {
+        std::unordered_map<uint32_t, ReliableSender>::iterator it = m_senders.find(addr.Get());
+        if(it == m_senders.end())
+        {
+            ReliableSender sender;
+            sender.nextSeq = 1;
+            sender.measured = false;
+            sender.rto = m_initialRto;
+            it = m_senders.insert(std::make_pair(addr.Get(), sender)).first;
+        }
+        ReliableSender &sender = it->second;
+        
+        uint32_t seq = sender.nextSeq++;
+        Unacked unacked;
+        unacked.packet = p;
+        unacked.sent = Simulator::Now();
+        unacked.transmissions = 1;
+        unacked.timeout = Simulator::Schedule(sender.rto, &Communication::Retransmit, this, addr, seq);
+        sender.unacked[seq] = unacked;
+        
+        return WrapReliable(p, seq, sender);
+    }
+    
+    Ptr<Packet>
+    Communication::WrapReliable(Ptr<Packet> p, uint32_t seq, const ReliableSender &sender)
+    {
+        SerializedReliable header;
+        header.seq = seq;
+        /* the message itself is unacked, the map is never empty here */
+        header.lowest = sender.unacked.begin()->first;
+        Ptr<Packet> wrapped = p->Copy();
+        DcepHeader inner;
+        wrapped->PeekHeader(inner);
+        wrapped->AddHeader(header);
+        DcepHeader dcepHeader;
+        dcepHeader.SetContentType(RELIABLE);
+        dcepHeader.SetTrafficClass(GetTrafficClass(inner));
+        dcepHeader.setContentSize(wrapped->GetSize());
+        wrapped->AddHeader(dcepHeader);
+        return wrapped;
+    }
+    
+    void
+    Communication::Retransmit(Ipv4Address addr, uint32_t seq)
+    {
+        ReliableSender &sender = m_senders[addr.Get()];
+        std::map<uint32_t, Unacked>::iterator it = sender.unacked.find(seq);
+        if(it == sender.unacked.end())
+        {
+            return;
+        }
+        
+        if(it->second.transmissions > numRetransmissions)
+        {
+            NS_LOG_INFO ("COMMUNICATION: giving up message " << seq << " to " << addr);
+            sender.unacked.erase(it);
+            m_reliableDrops++;
+            return;
+        }
+        
+        /* back off until an acknowledgement gives a new estimate */
+        sender.rto = std::min(sender.rto + sender.rto, Seconds(60));
+        it->second.transmissions++;
+        it->second.sent = Simulator::Now();
+        it->second.timeout = Simulator::Schedule(sender.rto, &Communication::Retransmit, this, addr, seq);
+        m_retransmissions++;
+        
+        NS_LOG_INFO ("COMMUNICATION: retransmitting message " << seq << " to " << addr);
+        EnqueuePacket(WrapReliable(it->second.packet, seq, sender), addr);
+    }
+    
+    void
+    Communication::RecvReliable(Ptr<Packet> packet, uint64_t delay, Ipv4Address from)
+    {
+        SerializedReliable header;
+        packet->RemoveHeader(header);
+        
+        ReliableReceiver &receiver = m_receivers[from.Get()];
+        bool duplicate = (header.seq <= receiver.cumulative) 
+                || (receiver.received.find(header.seq) != receiver.received.end());
+        if(!duplicate)
+        {
+            receiver.received.insert(header.seq);
+        }
+        if(header.lowest > receiver.cumulative + 1)
+        {
+            /* the sender gave up the missing messages before lowest */
+            receiver.cumulative = header.lowest - 1;
+            receiver.received.erase(receiver.received.begin(), 
+                    receiver.received.upper_bound(receiver.cumulative));
+        }
+        while(receiver.received.erase(receiver.cumulative + 1) > 0)
+        {
+            receiver.cumulative++;
+        }
+        
+        /* a lost acknowledgement is repeated for the copy sent again */
+        SendAck(from, receiver, header.seq);
+        if(duplicate)
+        {
+            NS_LOG_INFO ("COMMUNICATION: duplicate message " << header.seq << " from " << from);
+            return;
+        }
+        
+        DcepHeader dcepHeader;
+        packet->RemoveHeader(dcepHeader);
+        Deliver(packet, dcepHeader.GetContentType(), delay, from);
+    }
+    
+    void
+    Communication::SendAck(Ipv4Address addr, const ReliableReceiver &receiver, uint32_t seq)
+    {
+        SerializedAck ack;
+        ack.cumulative = receiver.cumulative;
+        if(seq > receiver.cumulative)
+        {
+            ack.selective.push_back(seq);
+        }
+        for(std::set<uint32_t>::const_iterator it = receiver.received.begin();
+                (it != receiver.received.end()) && (ack.selective.size() < MAX_SELECTIVE_ACKS); it++)
+        {
+            if(*it != seq)
+            {
+                ack.selective.push_back(*it);
+            }
+        }
+        
+        Ptr<Packet> p = Create<Packet>();
+        p->AddHeader(ack);
+        DcepHeader dcepHeader;
+        dcepHeader.SetContentType(ACK);
+        dcepHeader.setContentSize(ack.GetSerializedSize());
+        p->AddHeader(dcepHeader);
+        EnqueuePacket(p, addr);
+    }
+    
+    void
+    Communication::RecvAck(const SerializedAck &ack, Ipv4Address from)
+    {
+        std::unordered_map<uint32_t, ReliableSender>::iterator it = m_senders.find(from.Get());
+        if(it == m_senders.end())
+        {
+            return;
+        }
+        ReliableSender &sender = it->second;
+        
+        std::vector<uint32_t> acked;
+        for(std::map<uint32_t, Unacked>::iterator u = sender.unacked.begin();
+                (u != sender.unacked.end()) && (u->first <= ack.cumulative); u++)
+        {
+            acked.push_back(u->first);
+        }
+        acked.insert(acked.end(), ack.selective.begin(), ack.selective.end());
+        
+        for(uint32_t i = 0; i < acked.size(); i++)
+        {
+            std::map<uint32_t, Unacked>::iterator u = sender.unacked.find(acked[i]);
+            if(u == sender.unacked.end())
+            {
+                continue;
+            }
+            
+            /* the round trip of a message sent again is ambiguous */
+            if(u->second.transmissions == 1)
+            {
+                UpdateRto(sender, Simulator::Now() - u->second.sent);
+            }
+            Simulator::Cancel(u->second.timeout);
+            sender.unacked.erase(u);
+        }
+    }
+    
+    void
+    Communication::UpdateRto(ReliableSender &sender, Time sample)
+    {
+        /* as TCP does, RFC 6298 */
+        double r = sample.GetSeconds();
+        if(!sender.measured)
+        {
+            sender.measured = true;
+            sender.srtt = sample;
+            sender.rttvar = Seconds(r / 2);
+        }
+        else
+        {
+            double srtt = sender.srtt.GetSeconds();
+            sender.rttvar = Seconds(0.75 * sender.rttvar.GetSeconds() + 0.25 * std::abs(srtt - r));
+            sender.srtt = Seconds(0.875 * srtt + 0.125 * r);
+        }
+        sender.rto = std::max(m_minRto, Seconds(sender.srtt.GetSeconds() + 4 * sender.rttvar.GetSeconds()));
+    }
+    
     void Communication::ScheduleSend(Ptr<Packet> p, Ipv4Address addr)
     {
-        Ipv4Header ipv4;
-        ipv4.SetDestination(addr);
-        ipv4.SetProtocol(123);
-        p->AddHeader(ipv4);
+        if(m_batchSize == 0)
+        {
+            EnqueuePacket(p, addr);
+            return;
+        }
+        
+        DcepHeader dcepHeader;
+        p->PeekHeader(dcepHeader);
+        if(dcepHeader.GetContentType() == EVENT)
+        {
+            AddToBatch(p, addr);
+        }
+        else
+        {
+            /* keep the order of the messages to addr */
+            FlushBatch(addr);
+            EnqueuePacket(p, addr);
+        }
+    }
+    
+    void
+    Communication::AddToBatch(Ptr<Packet> p, Ipv4Address addr)
+    {
+        /* the receiver splits a batch by the content sizes */
+        DcepHeader dcepHeader;
+        p->RemoveHeader(dcepHeader);
+        dcepHeader.setContentSize(p->GetSize());
+        p->AddHeader(dcepHeader);
+        /* each record keeps its own stamp, the hold time counts in its delay */
+        SeqTsHeader sth;
+        sth.SetSeq(m_stamped++);
+        p->AddHeader(sth);
+        
+        std::unordered_map<uint32_t, Batch>::iterator it = m_batches.find(addr.Get());
+        if((it != m_batches.end()) && (it->second.packet->GetSize() + p->GetSize() > m_batchSize))
+        {
+            FlushBatch(addr);
+            it = m_batches.end();
+        }
+        
+        if(it == m_batches.end())
+        {
+            Batch batch;
+            batch.packet = Create<Packet>();
+            batch.trafficClass = ATOMIC_EVENT_TRAFFIC;
+            batch.flushEvent = Simulator::Schedule(m_batchHoldTime, &Communication::FlushBatch, this, addr);
+            it = m_batches.insert(std::make_pair(addr.Get(), batch)).first;
+        }
         
-        Ptr<ns3::QueueItem> p_item = Create<ns3::QueueItem>(p);
-        m_sendQueue->Enqueue(p_item);
+        it->second.packet->AddAtEnd(p);
+        it->second.trafficClass = std::min(it->second.trafficClass, dcepHeader.GetTrafficClass());
         
-        Simulator::Schedule (Seconds (0.0), &Communication::send, this);
+        if(it->second.packet->GetSize() >= m_batchSize)
+        {
+            FlushBatch(addr);
+        }
+    }
+    
+    void
+    Communication::FlushBatch(Ipv4Address addr)
+    {
+        std::unordered_map<uint32_t, Batch>::iterator it = m_batches.find(addr.Get());
+        if(it == m_batches.end())
+        {
+            return;
+        }
         
+        Simulator::Cancel(it->second.flushEvent);
+        Ptr<Packet> p = it->second.packet;
+        /* even a lone record, its stamp tells how long it was held */
+        DcepHeader dcepHeader;
+        dcepHeader.SetContentType(BATCH);
+        dcepHeader.SetTrafficClass(it->second.trafficClass);
+        dcepHeader.setContentSize(p->GetSize());
+        p->AddHeader(dcepHeader);
+        m_batches.erase(it);
+        
+        NS_LOG_INFO ("COMMUNICATION: sending a batch of size " << p->GetSize() << " to " << addr);
+        EnqueuePacket(p, addr);
     }
     
     void
-    Communication::send()
+    Communication::EnqueuePacket(Ptr<Packet> p, Ipv4Address addr)
+    {
+        /* a batch holds events */
+        DcepHeader dcepHeader;
+        p->PeekHeader(dcepHeader);
+        uint16_t type = (dcepHeader.GetContentType() == BATCH) ? EVENT : dcepHeader.GetContentType();
+        uint32_t cls = GetTrafficClass(dcepHeader);
+        if(m_reliableTypes.find(type) != m_reliableTypes.end())
+        {
+            p = MakeReliable(p, addr);
+        }
+        
+        TrafficClass &traffic = m_classes[cls];
+        std::deque<QueuedPacket> &queue = traffic.queues[addr.Get()];
+        if(queue.size() >= GetClassCapacity(cls))
+        {
+            NS_LOG_INFO ("COMMUNICATION: queue of class " << cls << " to " << addr << " full, dropping packet");
+            traffic.drops++;
+            m_queueDrop(p, cls);
+            if(queue.empty())
+            {
+                traffic.queues.erase(addr.Get());
+            }
+            return;
+        }
+        
+        if(queue.empty())
+        {
+            traffic.active.push_back(addr);
+        }
+        /* the delay of a message counts from here, the time it waits for
+         * the socket included */
+        SeqTsHeader sth;
+        sth.SetSeq(m_stamped++);
+        p->AddHeader(sth);
+        QueuedPacket queued;
+        queued.packet = p;
+        queued.ordered = IsOrdered(dcepHeader.GetContentType());
+        queued.order = 0;
+        if(queued.ordered)
+        {
+            /* zero initialized for a new destination */
+            queued.order = m_orderings[addr.Get()].queued++;
+        }
+        queue.push_back(queued);
+        
+        /* a pending send already drains the queues, unless it waits for
+         * the socket to take packets for other destinations */
+        if(m_blocked || !m_packetSendEvent.IsRunning())
+        {
+            m_blocked = false;
+            Simulator::Cancel(m_packetSendEvent);
+            m_packetSendEvent = Simulator::ScheduleNow (&Communication::send, this);
+        }
+        
+    }
+    
+    uint32_t
+    Communication::GetTrafficClass(const DcepHeader &dcepHeader)
     {
-        if(m_sendQueue->GetNPackets() > 0)
+        switch(dcepHeader.GetContentType())
         {
-            Ptr<Packet> p = m_sendQueue->Peek()->GetPacket(); 
-            DcepHeader dcepHeader;
-            Ipv4Header ipv4;
-            p->RemoveHeader(ipv4);
-            p->RemoveHeader(dcepHeader);
+            case QUERY:
+                return QUERY_TRAFFIC;
+                
+            /* set by the sender of the event, for a batch its most urgent
+             * event and for a reliable message the one it wraps */
+            case EVENT:
+            case BATCH:
+            case RELIABLE:
+                return std::min<uint32_t>(dcepHeader.GetTrafficClass(), ATOMIC_EVENT_TRAFFIC);
             
-            Ptr<Packet> pp = p->Copy();
-
-            SeqTsHeader sth;
-            sth.SetSeq(m_sent);
-
-            pp->AddHeader(dcepHeader);
-            pp->AddHeader(ipv4);
-            pp->AddHeader(sth);
-            bool itemSent = false;
-
-            m_socket->Connect (InetSocketAddress (Ipv4Address::ConvertFrom(ipv4.GetDestination()), m_port));
-            if ((m_socket->Send (pp)) >= 0)
+            default:
+                return CONTROL_TRAFFIC;
+        }
+    }
+    
+    uint8_t
+    Communication::GetEventTrafficClass(uint32_t eventClass)
+    {
+        switch(eventClass)
+        {
+            case ATOMIC_EVENT:
+                return ATOMIC_EVENT_TRAFFIC;
+            case COMPOSITE_EVENT:
+                return COMPOSITE_EVENT_TRAFFIC;
+            case FINAL_EVENT:
+                return FINAL_EVENT_TRAFFIC;
+            default:
+                return CONTROL_TRAFFIC;
+        }
+    }
+    
+    bool
+    Communication::IsOrdered(uint16_t type)
+    {
+        switch(type)
+        {
+            /* a query or an advertisement stands alone, a retransmission
+             * is late anyway */
+            case QUERY:
+            case ADVERTISEMENT:
+            case RELIABLE:
+            case ACK:
+                return false;
+            
+            /* the events and the migration of the operators they go to */
+            default:
+                return true;
+        }
+    }
+    
+    uint32_t
+    Communication::GetClassCapacity(uint32_t cls)
+    {
+        switch(cls)
+        {
+            case CONTROL_TRAFFIC:
+                return m_controlCapacity;
+            case QUERY_TRAFFIC:
+                return m_queryCapacity;
+            case FINAL_EVENT_TRAFFIC:
+                return m_finalEventCapacity;
+            case COMPOSITE_EVENT_TRAFFIC:
+                return m_compositeEventCapacity;
+            default:
+                return m_atomicEventCapacity;
+        }
+    }
+    
+    uint32_t
+    Communication::GetQueueDrops(uint32_t cls)
+    {
+        NS_ABORT_MSG_IF (cls >= TRAFFIC_CLASSES, "UNKNOWN TRAFFIC CLASS " << cls);
+        return m_classes[cls].drops;
+    }
+    
+    bool
+    Communication::NextPeer(const std::set<uint32_t> &refused, uint32_t &cls, Ipv4Address &peer)
+    {
+        for(cls = 0; cls < TRAFFIC_CLASSES; cls++)
+        {
+            const std::deque<Ipv4Address> &active = m_classes[cls].active;
+            for(uint32_t i = 0; i < active.size(); i++)
             {
-
-                NS_LOG_INFO ("SUCCESSFUL TX from : " << host_address
-                        << "packet size "
-                        << pp->GetSize());
-                itemSent = true;
-                m_sent++;
+                if(refused.find(active[i].Get()) != refused.end())
+                {
+                    continue;
+                }
+                
+                /* an ordered packet waits for the older ones in other
+                 * classes; the oldest is always at the front of its queue */
+                const QueuedPacket &head = m_classes[cls].queues[active[i].Get()].front();
+                if(head.ordered && (head.order != m_orderings[active[i].Get()].sent))
+                {
+                    continue;
+                }
+                
+                peer = active[i];
+                return true;
             }
-            else
+        }
+        return false;
+    }
+    
+    Time
+    Communication::GetPacingStart()
+    {
+        /* the bucket holds no more than the burst */
+        return std::max(m_bucketEmptyAt,
+                Simulator::Now() - m_pacingRate.CalculateBytesTxTime(m_pacingBurst));
+    }
+    
+    void
+    Communication::SocketReady(Ptr<Socket> socket, uint32_t available)
+    {
+        if(m_blocked)
+        {
+            NS_LOG_INFO ("COMMUNICATION: socket ready, resuming transmission");
+            m_blocked = false;
+            Simulator::Cancel(m_packetSendEvent);
+            m_packetSendEvent = Simulator::ScheduleNow (&Communication::send, this);
+        }
+    }
+    
+    void
+    Communication::RoutesChanged()
+    {
+        if(m_unroutable.empty())
+        {
+            return;
+        }
+        
+        NS_LOG_INFO ("COMMUNICATION: routes changed, trying " << m_unroutable.size() << " destinations again");
+        m_unroutable.clear();
+        if(!m_packetSendEvent.IsRunning())
+        {
+            m_packetSendEvent = Simulator::ScheduleNow (&Communication::send, this);
+        }
+    }
+    
+    void
+    Communication::PopFront(uint32_t cls, Ipv4Address peer)
+    {
+        TrafficClass &traffic = m_classes[cls];
+        std::deque<QueuedPacket> &queue = traffic.queues[peer.Get()];
+        m_sendFailures.erase(peer.Get());
+        
+        if(queue.front().ordered)
+        {
+            Ordering &ordering = m_orderings[peer.Get()];
+            if(++ordering.sent == ordering.queued)
             {
-              NS_LOG_INFO ("Error " << m_socket->GetErrno());
-
+                m_orderings.erase(peer.Get());
+            }
+        }
+        
+        /* the destination goes to the rear of the round of its class */
+        traffic.active.erase(std::find(traffic.active.begin(), traffic.active.end(), peer));
+        queue.pop_front();
+        if(queue.empty())
+        {
+            traffic.queues.erase(peer.Get());
+        }
+        else
+        {
+            traffic.active.push_back(peer);
+        }
+    }
+    
+    void
+    Communication::DropFront(uint32_t cls, Ipv4Address peer)
+    {
+        NS_LOG_INFO ("COMMUNICATION: dropping a packet to " << peer << " the socket refused");
+        m_sendDrops++;
+        PopFront(cls, peer);
+    }
+    
+    void
+    Communication::send()
+    {
+        bool pacing = m_pacingRate.GetBitRate() > 0;
+        /* the destinations skipped in this round, the ones waiting for a
+         * route and the ones the socket refused */
+        std::set<uint32_t> refused(m_unroutable);
+        bool retry = false;
+        uint32_t cls;
+        Ipv4Address peer;
+        
+        while(NextPeer(refused, cls, peer))
+        {
+            /* the queued packet stays untouched in case it must be sent again */
+            Ptr<Packet> pp = m_classes[cls].queues[peer.Get()].front().packet->Copy();
+            
+            if(pacing)
+            {
+                /* a packet larger than the burst waits for a full bucket */
+                Time ready = GetPacingStart()
+                        + m_pacingRate.CalculateBytesTxTime(std::min(pp->GetSize(), m_pacingBurst));
+                if(ready > Simulator::Now())
+                {
+                    m_packetSendEvent = Simulator::Schedule (ready - Simulator::Now(),
+                            &Communication::send, this);
+                    return;
+                }
             }
 
-            Ptr<QueueItem> item = m_sendQueue->Remove();
-
-            if (!itemSent) //we push it back at the rear of the queue
+            if ((m_socket->SendTo (pp, 0, InetSocketAddress (peer, m_port))) < 0)
             {
-                NS_LOG_INFO ("COMMUNICATION: Rescheduling item!");
-                m_sendQueue->Enqueue(item);
+                Socket::SocketErrno error = m_socket->GetErrno();
+                NS_LOG_INFO ("COMMUNICATION: Error " << error << " sending to " << peer);
+                if(error == Socket::ERROR_MSGSIZE)
+                {
+                    DropFront(cls, peer);
+                }
+                else if((error == Socket::ERROR_NOROUTETOHOST) && m_routesSignalled)
+                {
+                    /* sent again when the resource manager sees new routes */
+                    m_unroutable.insert(peer.Get());
+                    refused.insert(peer.Get());
+                }
+                else if(++m_sendFailures[peer.Get()] > m_maxSendRetries)
+                {
+                    DropFront(cls, peer);
+                }
+                else
+                {
+                    refused.insert(peer.Get());
+                    retry = true;
+                }
+                continue;
             }
 
-            if(m_sendQueue->GetNPackets() != 0)//only schedule when there are more packet to send
+            NS_LOG_INFO ("SUCCESSFUL TX from : " << host_address
+                    << "packet size "
+                    << pp->GetSize());
+            m_sent++;
+            if(pacing)
             {
-                NS_LOG_INFO ("SCHEDULING TRANSMISSION");
-                Simulator::Schedule (Seconds(1), &Communication::send, this);
+                m_bucketEmptyAt = GetPacingStart() + m_pacingRate.CalculateBytesTxTime(pp->GetSize());
             }
+            
+            PopFront(cls, peer);
+        }
+        
+        /* wait for the socket with what it refused */
+        m_blocked = retry;
+        if(m_blocked)
+        {
+            m_packetSendEvent = Simulator::Schedule (m_retryInterval, &Communication::send, this);
         }
     }
     
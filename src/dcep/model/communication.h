@@ -28,17 +28,26 @@
 #include "ns3/socket.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/traced-callback.h"
-#include "ns3/queue.h"
+#include "ns3/traced-value.h"
 #include "ns3/packet.h"
 #include "ns3/event-id.h"
 #include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "common.h"
+#include <unordered_map>
+#include <deque>
+#include <map>
+#include <set>
 
 namespace ns3 {
 
 /* ... */
     class Event;
+    class DcepHeader;
     class Packet;
     class Query;
+    class SerializedAck;
     
 //template<typename Item> class DropTailQueue;
 class Communication : public Object
@@ -68,20 +77,176 @@ class Communication : public Object
         void ScheduleSend(Ptr<Packet> p, Ipv4Address addr);
         Ipv4Address GetLocalAddress();  
         Ipv4Address GetSinkAddress();
+        /* the packets of a traffic_class dropped on full queues */
+        uint32_t GetQueueDrops(uint32_t cls);
+        /* the traffic_class of an event message, set in its DcepHeader */
+        static uint8_t GetEventTrafficClass(uint32_t eventClass);
     
     private:
         
+        /* the events waiting to be sent together to a destination */
+        struct Batch
+        {
+            Ptr<Packet> packet;
+            EventId flushEvent;
+            /* the most urgent class of its events */
+            uint8_t trafficClass;
+        };
+        
+        /* a reliable message waiting for its acknowledgement */
+        struct Unacked
+        {
+            Ptr<Packet> packet;//without the reliable header, see WrapReliable
+            Time sent;
+            uint32_t transmissions;
+            EventId timeout;
+        };
+        
+        /* the reliable messages sent to a destination */
+        struct ReliableSender
+        {
+            uint32_t nextSeq;
+            std::map<uint32_t, Unacked> unacked;
+            bool measured;
+            Time srtt;
+            Time rttvar;
+            Time rto;
+        };
+        
+        /* a packet waiting for the socket */
+        struct QueuedPacket
+        {
+            Ptr<Packet> packet;
+            /* events and migration messages leave in the order they came,
+             * whatever their class, see Ordering */
+            bool ordered;
+            uint32_t order;
+        };
+        
+        /* the ordered packets to a destination, numbered as they are
+         * queued; only the oldest one queued may be sent */
+        struct Ordering
+        {
+            uint32_t queued;
+            uint32_t sent;
+        };
+        
+        /* the packets of a class waiting for each destination */
+        struct TrafficClass
+        {
+            std::unordered_map<uint32_t, std::deque<QueuedPacket> > queues;
+            /* the destinations with waiting packets, in the order they are served */
+            std::deque<Ipv4Address> active;
+            uint32_t drops;
+        };
+        
+        /* the reliable messages received from a source */
+        struct ReliableReceiver
+        {
+            ReliableReceiver() : cumulative(0) {}
+            uint32_t cumulative;
+            /* the ones received beyond cumulative */
+            std::set<uint32_t> received;
+        };
+        
+        /* queues a packet for the socket in the queue of its class and
+         * destination */
+        void EnqueuePacket(Ptr<Packet> p, Ipv4Address addr);
+        /* control messages, queries, then final, composite and atomic
+         * events, as the header tells */
+        uint32_t GetTrafficClass(const DcepHeader &dcepHeader);
+        /* whether messages of the type keep their order to a destination */
+        bool IsOrdered(uint16_t type);
+        uint32_t GetClassCapacity(uint32_t cls);
+        /* the first destination of the most urgent class holding a packet
+         * that may be sent, skipping the ones the socket refused */
+        bool NextPeer(const std::set<uint32_t> &refused, uint32_t &cls, Ipv4Address &peer);
+        /* appends an event message to the batch of its destination */
+        void AddToBatch(Ptr<Packet> p, Ipv4Address addr);
+        void FlushBatch(Ipv4Address addr);
+        /* hands a received message, or each message of a batch, to dcep;
+         * delay is the link delay in microseconds */
+        void Deliver(Ptr<Packet> packet, uint16_t msg_type, uint64_t delay, Ipv4Address from);
+        /* numbers the message and keeps it until acknowledged */
+        Ptr<Packet> MakeReliable(Ptr<Packet> p, Ipv4Address addr);
+        /* a copy of p behind a reliable header telling what is still unacked */
+        Ptr<Packet> WrapReliable(Ptr<Packet> p, uint32_t seq, const ReliableSender &sender);
+        void Retransmit(Ipv4Address addr, uint32_t seq);
+        void RecvReliable(Ptr<Packet> packet, uint64_t delay, Ipv4Address from);
+        void RecvAck(const SerializedAck &ack, Ipv4Address from);
+        /* acknowledges everything received, seq always among the selective ones */
+        void SendAck(Ipv4Address addr, const ReliableReceiver &receiver, uint32_t seq);
+        void UpdateRto(ReliableSender &sender, Time sample);
+        /* transmits queued packets, a class only when the more urgent ones
+         * are empty or wait for older ordered packets to their destination,
+         * and the destinations of a class in turn, until the
+         * queues are empty, the pacer runs out of tokens or the socket
+         * refuses a packet for every destination */
         void send(void);
-        Ptr<Queue> m_sendQueue;
+        /* called by the socket when it can take data again */
+        void SocketReady(Ptr<Socket> socket, uint32_t available);
+        /* called by the resource manager, destinations without a route
+         * are tried again */
+        void RoutesChanged(void);
+        /* removes the first packet queued in the class for the peer */
+        void PopFront(uint32_t cls, Ipv4Address peer);
+        /* drops the first packet queued in the class for the peer, the
+         * socket will never take it */
+        void DropFront(uint32_t cls, Ipv4Address peer);
+        /* the time from which the pacer bucket filled up to now */
+        Time GetPacingStart(void);
+        
+        TrafficClass m_classes[TRAFFIC_CLASSES];
+        std::unordered_map<uint32_t, Ordering> m_orderings;
+        /* the packets of a class waiting for a destination beyond which
+         * new ones are dropped */
+        uint32_t m_controlCapacity;
+        uint32_t m_queryCapacity;
+        uint32_t m_finalEventCapacity;
+        uint32_t m_compositeEventCapacity;
+        uint32_t m_atomicEventCapacity;
+        TracedCallback<Ptr<const Packet>, uint32_t> m_queueDrop;
         EventId m_packetSendEvent;
+        /* true while waiting for the socket after a failed send */
+        bool m_blocked;
+        Time m_retryInterval;
+        /* the times the first packet for a destination was refused */
+        std::unordered_map<uint32_t, uint32_t> m_sendFailures;
+        uint32_t m_maxSendRetries;
+        /* the destinations waiting for a route, when the resource manager
+         * tells about new routes */
+        std::set<uint32_t> m_unroutable;
+        bool m_routesSignalled;
+        TracedValue<uint32_t> m_sendDrops;
+        /* token bucket pacer, disabled when the rate is zero; the bucket is
+         * kept as the time it was last empty, it refills at the rate from then */
+        DataRate m_pacingRate;
+        uint32_t m_pacingBurst;
+        Time m_bucketEmptyAt;
+        /* batching of events, disabled when the size is zero */
+        uint32_t m_batchSize;
+        Time m_batchHoldTime;
+        std::unordered_map<uint32_t, Batch> m_batches;
+        /* the message types sent reliably, by name and by type */
+        std::string m_reliableMessages;
+        std::set<uint16_t> m_reliableTypes;
+        Time m_initialRto;
+        Time m_minRto;
+        std::unordered_map<uint32_t, ReliableSender> m_senders;
+        std::unordered_map<uint32_t, ReliableReceiver> m_receivers;
+        TracedValue<uint32_t> m_retransmissions;
+        TracedValue<uint32_t> m_reliableDrops;
         uint32_t backoffTime;
         uint16_t m_port; 
+        /* the most times a reliable message is sent again */
         uint32_t numRetransmissions;
         Ipv4Address m_sinkAddress;
         Ipv4Address host_address;
         Ptr<Socket> m_socket; 
         Ptr<Node> disnode;
         uint32_t m_sent; 
+        /* the messages stamped so far, numbering their SeqTsHeader */
+        uint32_t m_stamped;
      
     };
    
@@ -22,7 +22,8 @@
 namespace ns3 {
 
     DcepHeader::DcepHeader ():
-    m_type (0)
+    m_type (0),
+    m_trafficClass (0)
     {
       // we must provide a public default constructor, 
       // implicit or explicit, but never private.
@@ -59,8 +60,8 @@ namespace ns3 {
     uint32_t
     DcepHeader::GetSerializedSize (void) const
     {
-      // we reserve 2 bytes for our header.
-      return (sizeof(uint32_t)+sizeof(uint16_t));
+      // we reserve 7 bytes for our header.
+      return (sizeof(uint32_t)+sizeof(uint16_t)+sizeof(uint8_t));
     }
     void
     DcepHeader::Serialize (Buffer::Iterator start) const
@@ -68,6 +69,7 @@ namespace ns3 {
       // we can serialize two bytes at the start of the buffer.
       // we write them in network byte order.
       start.WriteHtonU16 (m_type);
+      start.WriteU8 (m_trafficClass);
       start.WriteHtonU32(size);
     }
     uint32_t
@@ -77,9 +79,10 @@ namespace ns3 {
       // we read them in network byte order and store them
       // in host byte order.
       m_type = start.ReadNtohU16 ();
+      m_trafficClass = start.ReadU8 ();
       size = start.ReadNtohU32();
       // we return the number of bytes effectively read.
-      return (sizeof(uint32_t)+sizeof(uint16_t));
+      return (sizeof(uint32_t)+sizeof(uint16_t)+sizeof(uint8_t));
     }
     
     void 
@@ -93,6 +96,17 @@ namespace ns3 {
       return m_type;
     }
     
+    void
+    DcepHeader::SetTrafficClass (uint8_t cls)
+    {
+      m_trafficClass = cls;
+    }
+    uint8_t
+    DcepHeader::GetTrafficClass (void) const
+    {
+      return m_trafficClass;
+    }
+    
     void
     DcepHeader::setContentSize(std::size_t s)
     {
@@ -39,6 +39,10 @@ public:
   uint16_t GetContentType (void) const;
   std::size_t GetContentSize(void) const;
   void setContentSize(std::size_t s);
+  /* the traffic class the sender queues the message in, see
+   * Communication::GetTrafficClass */
+  void SetTrafficClass (uint8_t cls);
+  uint8_t GetTrafficClass (void) const;
   void SetQueryType (std::string);
   std::string GetQueryType ();
 
@@ -50,6 +54,7 @@ public:
   virtual uint32_t GetSerializedSize (void) const;
 private:
   uint16_t m_type;
+  uint8_t m_trafficClass;
   std::size_t size;
   std::string qt;
 };
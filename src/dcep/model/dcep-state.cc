@@ -21,8 +21,10 @@
 #include "ns3/log.h"
 #include "cep-engine.h"
 #include "ns3/abort.h"
+#include "ns3/simulator.h"
 #include "communication.h"
 #include "placement.h"
+#include <algorithm>
 namespace ns3 
 {
     
@@ -41,6 +43,9 @@ namespace ns3
     }
     
     EventRoutingTableEntry::EventRoutingTableEntry()
+    : state(UNDEFINED),
+      current_processor(Ipv4Address::GetAny()),
+      next_hop(Ipv4Address::GetAny())
     {
         freezeAck_counter = 0;
         monitoring = false;
@@ -57,7 +62,11 @@ namespace ns3
     }
     
     DcepState::DcepState()
-    {}
+    {
+        missEntry = CreateObject<EventRoutingTableEntry>();
+        missEntry->state = UNDEFINED;
+        missEntry->next_hop = Ipv4Address::GetAny();
+    }
     
     void
     DcepState::Configure ()
@@ -73,7 +82,7 @@ namespace ns3
     
     
     void
-    DcepState::HandlerLocalPlacement(std::string eType)
+    DcepState::HandlerLocalPlacement(EventTypeId eType)
     {
         OperatorState ostate = GetState(eType);
         if(ostate == UNDEFINED)
@@ -87,32 +96,164 @@ namespace ns3
     }
     
     Ptr<EventRoutingTableEntry>
-    DcepState::lookUpEventRoutingTable(std::string eventType) 
+    DcepState::lookUpEventRoutingTable(EventTypeId eventType) 
     {
-
-        Ptr<EventRoutingTableEntry> er;
-        std::vector<Ptr<EventRoutingTableEntry> >::iterator it;
-        for (it = eventRoutingTable.begin(); it != eventRoutingTable.end(); ++it) 
+        std::unordered_map<EventTypeId, Ptr<EventRoutingTableEntry> >::const_iterator it 
+                = eventRoutingTable.find(eventType);
+        if (it == eventRoutingTable.end())
         {
-
-            er = (Ptr<EventRoutingTableEntry>) * it;
-
-            if (er->source_query->eventType == eventType) {
-               // NS_LOG_INFO("Found entry with event type " << er->source_query->eventType);
-                return er;
+            return missEntry;
+        }
+        return it->second;
+    }
+    
+    void
+    DcepState::GetInputs (Ptr<Query> q, std::vector<EventTypeId> &inputs)
+    {
+        if (q->inevent1 != NO_EVENT_TYPE)
+            inputs.push_back(q->inevent1);
+        if (q->inevent2 != NO_EVENT_TYPE)
+            inputs.push_back(q->inevent2);
+        for (uint32_t i = 0; i < q->inevents.size(); i++)
+        {
+            if (std::find(inputs.begin(), inputs.end(), q->inevents[i]) == inputs.end())
+                inputs.push_back(q->inevents[i]);
+        }
+    }
+    
+    void
+    DcepState::UpdateExpectedInputs (Ptr<Query> q, bool active)
+    {
+        if (q->isAtomic)
+        {
+            return;
+        }
+        
+        std::vector<EventTypeId> inputs;
+        GetInputs(q, inputs);
+        for (uint32_t i = 0; i < inputs.size(); i++)
+        {
+            if (inputs[i] >= expectedInputs.size())
+            {
+                expectedInputs.resize(inputs[i] + 1, 0);
             }
-
+            
+            if (active)
+                expectedInputs[inputs[i]]++;
+            else
+                expectedInputs[inputs[i]]--;
         }
-
-        er = CreateObject<EventRoutingTableEntry>();
-        er->next_hop = Ipv4Address::GetAny();
-
-        return er;
+    }
+    
+    Ptr<EventRoutingTableEntry>
+    DcepState::GetEntry (EventTypeId eventType)
+    {
+        Ptr<EventRoutingTableEntry> erte = this->lookUpEventRoutingTable(eventType);
+        return (erte == missEntry) ? 0 : erte;
+    }
+    
+    const std::vector<Ptr<EventRoutingTableEntry> >&
+    DcepState::GetConsumers (EventTypeId inputType)
+    {
+        std::unordered_map<EventTypeId, std::vector<Ptr<EventRoutingTableEntry> > >::const_iterator it 
+                = consumers.find(inputType);
+        if (it == consumers.end())
+        {
+            return noConsumers;
+        }
+        return it->second;
+    }
+    
+    static bool
+    IsExpired (const AdvertisedProducer &p)
+    {
+        return p.expires <= Simulator::Now();
+    }
+    
+    bool
+    DcepState::AddProducer (EventTypeId eType, Ipv4Address address, double rate, Time lifetime)
+    {
+        std::vector<AdvertisedProducer> &known = producers[eType];
+        for (uint32_t i = 0; i < known.size(); i++)
+        {
+            if (known[i].address == address)
+            {
+                known[i].rate = rate;
+                known[i].expires = Simulator::Now() + lifetime;
+                return false;
+            }
+        }
+        
+        NS_LOG_INFO("NEW PRODUCER " << address << " OF " << EventTypeTable::GetName(eType));
+        AdvertisedProducer producer;
+        producer.address = address;
+        producer.rate = rate;
+        producer.expires = Simulator::Now() + lifetime;
+        known.push_back(producer);
+        return true;
+    }
+    
+    static bool
+    IsFaster (const AdvertisedProducer &a, const AdvertisedProducer &b)
+    {
+        if (a.rate != b.rate)
+        {
+            return a.rate > b.rate;
+        }
+        return a.address.Get() < b.address.Get();
+    }
+    
+    void
+    DcepState::GetProducers (EventTypeId eType, std::vector<Ipv4Address> &result)
+    {
+        result.clear();
+        std::unordered_map<EventTypeId, std::vector<AdvertisedProducer> >::iterator it 
+                = producers.find(eType);
+        if (it == producers.end())
+        {
+            return;
+        }
+        
+        std::vector<AdvertisedProducer> &known = it->second;
+        known.erase(std::remove_if(known.begin(), known.end(), IsExpired), known.end());
+        std::sort(known.begin(), known.end(), IsFaster);
+        for (uint32_t i = 0; i < known.size(); i++)
+        {
+            result.push_back(known[i].address);
+        }
+    }
+    
+    double
+    DcepState::GetAdvertisedRate (EventTypeId eType)
+    {
+        std::unordered_map<EventTypeId, std::vector<AdvertisedProducer> >::const_iterator it 
+                = producers.find(eType);
+        double rate = 0;
+        if (it != producers.end())
+        {
+            for (uint32_t i = 0; i < it->second.size(); i++)
+            {
+                if (!IsExpired(it->second[i]))
+                {
+                    rate += it->second[i].rate;
+                }
+            }
+        }
+        return rate;
     }
     
     void
     DcepState::CreateEventRoutingTableEntry (Ptr<Query> q)
     {
+        std::unordered_map<EventTypeId, Ptr<EventRoutingTableEntry> >::iterator it 
+                = eventRoutingTable.find(q->eventType);
+        if (it != eventRoutingTable.end())
+        {
+            /* same inputs, the consumer index is still valid */
+            it->second->source_query = q;
+            return;
+        }
+        
         Ptr<EventRoutingTableEntry> ee = CreateObject<EventRoutingTableEntry>();
         ee->source_query = q;
         ee->state = UNDEFINED;
@@ -120,74 +261,63 @@ namespace ns3
         {
             ee->source_query->output_dest = GetObject<Communication>()->GetSinkAddress();
         }
+        this->eventRoutingTable[q->eventType] = ee;
         
-        if ((q->eventType == "AorB") || (q->eventType == "AandB"))
+        std::vector<EventTypeId> inputs;
+        GetInputs(q, inputs);
+        for (uint32_t i = 0; i < inputs.size(); i++)
         {
-            ee->dataSources.push_back("10.0.0.2");
-            ee->dataSources.push_back("10.0.0.3");
+            consumers[inputs[i]].push_back(ee);
         }
-        this->eventRoutingTable.push_back(ee);
     }
     
     
     bool
     DcepState::IsExpected(Ptr<Event> e)
     {
-        for (uint32_t i = 0; i < eventRoutingTable.size(); i++)
-        {
-            if (((eventRoutingTable[i]->source_query->inevent1 == e->type) ||
-                    (eventRoutingTable[i]->source_query->inevent2 == e->type)) && (!eventRoutingTable[i]->source_query->isAtomic))
-            {
-                if (eventRoutingTable[i]->state == ACTIVE)
-                {
-                    return true;
-                }
-                
-            }
-        }
-        return false;
+        return (e->type < expectedInputs.size()) && (expectedInputs[e->type] > 0);
     }
     
     
     Ipv4Address
-    DcepState::GetOuputDest(std::string eType)
+    DcepState::GetOuputDest(EventTypeId eType)
     {
         Ptr<EventRoutingTableEntry> erte = this->lookUpEventRoutingTable(eType);
+        if (!erte->source_query)
+        {
+            return Ipv4Address::GetAny();
+        }
         return erte->source_query->output_dest;
     }
     
     bool 
-    DcepState::IsActive(std::string eType)
+    DcepState::IsActive(EventTypeId eType)
     {
         Ptr<EventRoutingTableEntry> erte = this->lookUpEventRoutingTable(eType);
-        return erte->state;
+        return erte->state == ACTIVE;
     }
     
     
     Ptr<Query>
-    DcepState::GetQuery(std::string eType)
+    DcepState::GetQuery(EventTypeId eType)
     {
         Ptr<EventRoutingTableEntry> erte = this->lookUpEventRoutingTable(eType);
         return erte->source_query;
     }
     
     void
-    DcepState::SetNextHop(std::string eType, Ipv4Address adr)
+    DcepState::SetNextHop(EventTypeId eType, Ipv4Address adr)
     {
-        
-        for(uint32_t i = 0; i != eventRoutingTable.size(); i++)
+        Ptr<EventRoutingTableEntry> erte = this->lookUpEventRoutingTable(eType);
+        if (erte != missEntry)
         {
-            if(eventRoutingTable[i]->source_query->eventType == eType)
-            {
-                eventRoutingTable[i]->next_hop = adr;
-                NS_LOG_INFO ("NEXT HOP " << eventRoutingTable[i]->next_hop);
-            }
+            erte->next_hop = adr;
+            NS_LOG_INFO ("NEXT HOP " << erte->next_hop);
         }
-        
     }
     
     Ipv4Address
-    DcepState::GetNextHop(std::string eType)
+    DcepState::GetNextHop(EventTypeId eType)
     {
       Ptr<EventRoutingTableEntry> erte = this->lookUpEventRoutingTable(eType);
       return erte->next_hop;
@@ -195,51 +325,51 @@ namespace ns3
     
     
     void
-    DcepState::SetOutDest(std::string eType, Ipv4Address adr)
+    DcepState::SetOutDest(EventTypeId eType, Ipv4Address adr)
     {
-        for(uint32_t i = 0; i != eventRoutingTable.size(); i++)
+        Ptr<EventRoutingTableEntry> erte = this->lookUpEventRoutingTable(eType);
+        if (erte != missEntry)
         {
-            if(eventRoutingTable[i]->source_query->eventType == eType)
-            {
-                eventRoutingTable[i]->source_query->output_dest = adr;
-            }
+            erte->source_query->output_dest = adr;
         }
     }
     
     void
-    DcepState::SetCurrentProcessor(std::string eType, Ipv4Address adr)
+    DcepState::SetCurrentProcessor(EventTypeId eType, Ipv4Address adr)
     {
-        for(uint32_t i = 0; i != eventRoutingTable.size(); i++)
+        Ptr<EventRoutingTableEntry> erte = this->lookUpEventRoutingTable(eType);
+        if (erte != missEntry)
         {
-            if(eventRoutingTable[i]->source_query->eventType == eType)
-            {
-                eventRoutingTable[i]->current_processor = adr;
-            }
+            erte->current_processor = adr;
         }
     }
     
     Ipv4Address
-    DcepState::GetCurrentProcessor(std::string eType)
+    DcepState::GetCurrentProcessor(EventTypeId eType)
     {
         Ptr<EventRoutingTableEntry> erte = this->lookUpEventRoutingTable(eType);
         return erte->current_processor;
     }
     
     void
-    DcepState::SetState(std::string eType, OperatorState state)
+    DcepState::SetState(EventTypeId eType, OperatorState state)
     {
-        for(uint32_t i = 0; i != eventRoutingTable.size(); i++)
+        Ptr<EventRoutingTableEntry> erte = this->lookUpEventRoutingTable(eType);
+        if (erte == missEntry)
         {
-            if(eventRoutingTable[i]->source_query->eventType == eType)
-            {
-                eventRoutingTable[i]->state = state;
-            }
+            return;
+        }
+        
+        if ((erte->state == ACTIVE) != (state == ACTIVE))
+        {
+            UpdateExpectedInputs(erte->source_query, state == ACTIVE);
         }
+        erte->state = state;
     }
     
     
     OperatorState 
-    DcepState::GetState(std::string eType)
+    DcepState::GetState(EventTypeId eType)
     {
         Ptr<EventRoutingTableEntry> erte = this->lookUpEventRoutingTable(eType);
         return erte->state;
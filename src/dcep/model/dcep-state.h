@@ -21,7 +21,10 @@
 
 #include "ns3/object.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
 #include "common.h"
+#include "event-type.h"
+#include <unordered_map>
 namespace ns3
 {
     class Query;
@@ -44,6 +47,15 @@ namespace ns3
         
     };
     
+    /* a datasource which advertised events of some type */
+    class AdvertisedProducer
+    {
+    public:
+        Ipv4Address address;
+        double rate;//events per second
+        Time expires;
+    };
+    
     class DcepState : public Object
     {
     public:
@@ -52,26 +64,58 @@ namespace ns3
         void Configure ();
         
         bool IsExpected(Ptr<Event> e);
-        bool IsActive(std::string eventType);
-        Ipv4Address GetOuputDest(std::string eventType);
-        Ipv4Address GetNextHop(std::string eventType);
-        Ptr<Query> GetQuery(std::string eventType);
-        OperatorState GetState(std::string eventType);
-        Ipv4Address GetCurrentProcessor(std::string eType);
+        bool IsActive(EventTypeId eventType);
+        Ipv4Address GetOuputDest(EventTypeId eventType);
+        Ipv4Address GetNextHop(EventTypeId eventType);
+        Ptr<Query> GetQuery(EventTypeId eventType);
+        OperatorState GetState(EventTypeId eventType);
+        Ipv4Address GetCurrentProcessor(EventTypeId eType);
         
         
-        void SetNextHop (std::string eventType, Ipv4Address adr);
-        void SetCurrentProcessor (std::string eventType, Ipv4Address adr);
-        void SetOutDest (std::string eventType, Ipv4Address adr);
+        void SetNextHop (EventTypeId eventType, Ipv4Address adr);
+        void SetCurrentProcessor (EventTypeId eventType, Ipv4Address adr);
+        void SetOutDest (EventTypeId eventType, Ipv4Address adr);
+        void SetState (EventTypeId eventType, OperatorState state);
+        /* a query placed again, e.g. migrated back, replaces the previous one */
         void CreateEventRoutingTableEntry (Ptr<Query> q);
+        /* the entry of the operator producing the given type, 0 if there is none */
+        Ptr<EventRoutingTableEntry> GetEntry (EventTypeId eventType);
+        /* the entries of the operators consuming events of the given type */
+        const std::vector<Ptr<EventRoutingTableEntry> >& GetConsumers (EventTypeId inputType);
+        /* the types of the events q consumes */
+        static void GetInputs (Ptr<Query> q, std::vector<EventTypeId> &inputs);
+        
+        /* 
+         * records or refreshes a producer of the given type for lifetime,
+         * returns true if it was not known
+         */
+        bool AddProducer (EventTypeId eType, Ipv4Address address, double rate, Time lifetime);
+        /* the producers of the given type still alive, the fastest first */
+        void GetProducers (EventTypeId eType, std::vector<Ipv4Address> &result);
+        /* the sum of the rates advertised for the given type, 0 if unknown */
+        double GetAdvertisedRate (EventTypeId eType);
         
         
     private:
-        void HandlerLocalPlacement (std::string eType);
+        void HandlerLocalPlacement (EventTypeId eType);
+        
+        /* returns the shared miss entry when there is no entry for the type */
+        Ptr<EventRoutingTableEntry> lookUpEventRoutingTable(EventTypeId eventType);
+        void UpdateExpectedInputs (Ptr<Query> q, bool active);
         
-        void SetState (std::string eventType, OperatorState state);
-        Ptr<EventRoutingTableEntry> lookUpEventRoutingTable(std::string eventType);
-        std::vector<Ptr<EventRoutingTableEntry> > eventRoutingTable;
+        /* entries by the type of the events they produce */
+        std::unordered_map<EventTypeId, Ptr<EventRoutingTableEntry> > eventRoutingTable;
+        /* entries by the types of the events they consume */
+        std::unordered_map<EventTypeId, std::vector<Ptr<EventRoutingTableEntry> > > consumers;
+        /* 
+         * expectedInputs[t] is the number of active composite operators 
+         * consuming events of type t, see IsExpected
+         */
+        std::vector<uint32_t> expectedInputs;
+        Ptr<EventRoutingTableEntry> missEntry;
+        std::vector<Ptr<EventRoutingTableEntry> > noConsumers;
+        /* the producers of each event type, from their advertisements */
+        std::unordered_map<EventTypeId, std::vector<AdvertisedProducer> > producers;
     };
 }
 
@@ -26,15 +26,21 @@
 #include "communication.h"
 #include "cep-engine.h"
 #include "common.h"
+#include "message-types.h"
+#include "dcep-header.h"
+#include "query-compiler.h"
+#include "ns3/abort.h"
 #include "ns3/simulator.h"
 #include "ns3/config.h"
 #include "ns3/string.h"
+#include "ns3/double.h"
 #include "src/core/model/object-base.h"
 
 #include <ctime>
 #include <chrono>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 
 namespace ns3 {
 
@@ -80,10 +86,36 @@ NS_LOG_COMPONENT_DEFINE ("Dcep");
                       UintegerValue (0),
                       MakeUintegerAccessor (&Dcep::events_load),
                       MakeUintegerChecker<uint32_t> ())
-        .AddAttribute ("routing protocol", "The routing protocol being used",
+        .AddAttribute ("Queries", "The queries issued by a sink, see QueryCompiler. "
+        "By default the sink asks for A and B combined with the query operator",
+                        StringValue(""),
+                        MakeStringAccessor (&Dcep::queries),
+                        MakeStringChecker())
+        .AddAttribute ("QueryFile", "A file holding the queries issued by a sink, "
+        "overrides Queries",
+                        StringValue(""),
+                        MakeStringAccessor (&Dcep::query_file),
+                        MakeStringChecker())
+        .AddAttribute ("EventType", "The type of the events generated by a "
+        "datasource, overrides the event code",
+                        StringValue(""),
+                        MakeStringAccessor (&Dcep::event_type),
+                        MakeStringChecker())
+        .AddAttribute ("AdvertisementInterval", "How often a datasource advertises "
+        "the type of its events to the sink",
+                        TimeValue (Seconds (5.0)),
+                        MakeTimeAccessor (&Dcep::advertisementInterval),
+                        MakeTimeChecker ())
+        .AddAttribute ("routing protocol", "The routing protocol being used, "
+        "one of olsr, aodv, dsdv, dsr, static or nix",
                         StringValue("olsr"),
                         MakeStringAccessor (&Dcep::routing_protocol),
                         MakeStringChecker())
+        .AddAttribute ("query operator", "The operator combining the events of "
+        "types A and B in the query issued by the sink",
+                        StringValue("or"),
+                        MakeStringAccessor (&Dcep::query_operator),
+                        MakeStringChecker())
         .AddTraceSource ("RxFinalEvent",
                        "a new final event has been detected.",
                        MakeTraceSourceAccessor (&Dcep::RxFinalEvent))
@@ -91,7 +123,8 @@ NS_LOG_COMPONENT_DEFINE ("Dcep");
                        "",
                        MakeTraceSourceAccessor (&Dcep::RxFinalEventHops))
         .AddTraceSource ("RxFinalEventDelay",
-                       "",
+                       "The delay of a final event since its atomic events were "
+                       "produced, in microseconds.",
                        MakeTraceSourceAccessor (&Dcep::RxFinalEventDelay))
         
         ;
@@ -152,6 +185,11 @@ NS_LOG_COMPONENT_DEFINE ("Dcep");
         
         NS_LOG_INFO("STARTED DCEP APPLICATION AT NODE " << c_communication->GetLocalAddress());
         
+        if(datasource_node)
+        {
+            datasource->Advertise();
+        }
+        
         if(sink_node)
         {
             Simulator::Schedule (Seconds (20.0), &Sink::BuildAndSendQuery, sink);
@@ -217,7 +255,7 @@ NS_LOG_COMPONENT_DEFINE ("Dcep");
     }
     
     void
-    Dcep::rcvRemoteMsg(uint8_t* data, uint32_t size, uint16_t msg_type, uint64_t delay)
+    Dcep::rcvRemoteMsg(Ptr<Packet> packet, uint16_t msg_type, uint64_t delay)
     {
         
         Ptr<Placement> p = GetObject<Placement>();
@@ -227,11 +265,12 @@ NS_LOG_COMPONENT_DEFINE ("Dcep");
             case EVENT: /*handle event*/
             {
                 NS_LOG_INFO ("DCEP: RECEIVED EVENT MESSAGE");   
-                Ptr<Event> event = CreateObject<Event>();
-                
-                event->deserialize(data, size);
-                /* setting link delay from source to this node*/
-                event->delay = delay;
+                Ptr<Event> event = Create<Event>();
+                SerializedEvent message;
+                packet->RemoveHeader(message);
+                event->deserialize(message);
+                /* adding the link delay from the previous hop to this node*/
+                event->delay += delay;
                 
                 p->RcvCepEvent(event);
                 break; 
@@ -242,10 +281,56 @@ NS_LOG_COMPONENT_DEFINE ("Dcep");
             {
                 NS_LOG_INFO ("DCEP: RECEIVED QUERY MESSAGE");
                 Ptr<Query> q = CreateObject<Query>();
-                q->deserialize(data, size);
+                SerializedQuery message;
+                packet->RemoveHeader(message);
+                q->deserialize(message);
                 p->RecvQuery(q);
                 break;
             }
+            
+            case MIGRATION:
+            case RESUME:
+            case REDIRECT:
+            case REDIRECT_ACK:
+            case STREAM_MOVED:
+            case MIGRATION_ABORT:
+            {
+                NS_LOG_INFO ("DCEP: RECEIVED MIGRATION MESSAGE");
+                SerializedMigration message;
+                packet->RemoveHeader(message);
+                
+                Ptr<Query> q;
+                if (msg_type == MIGRATION)
+                {
+                    SerializedQuery qmessage;
+                    packet->RemoveHeader(qmessage);
+                    q = CreateObject<Query>();
+                    q->deserialize(qmessage);
+                }
+                
+                std::vector<Ptr<Event> > events;
+                for (uint32_t i = 0; i < message.event_count; i++)
+                {
+                    SerializedEvent emessage;
+                    packet->RemoveHeader(emessage);
+                    Ptr<Event> event = Create<Event>();
+                    event->deserialize(emessage);
+                    event->arrival = message.arrivals[i];
+                    events.push_back(event);
+                }
+                
+                p->RecvMigrationMessage(msg_type, message, q, events);
+                break;
+            }
+            
+            case ADVERTISEMENT:
+            {
+                NS_LOG_INFO ("DCEP: RECEIVED ADVERTISEMENT MESSAGE");
+                SerializedAdvertisement message;
+                packet->RemoveHeader(message);
+                p->RecvAdvertisement(message);
+                break;
+            }
                 
             default:
                 NS_LOG_INFO("dcep: unrecognized remote message");
@@ -298,71 +383,38 @@ NS_LOG_COMPONENT_DEFINE ("Dcep");
     void
     Sink::BuildAndSendQuery(){
 
-       uint32_t query_counter = 1;
-
-        /**
-         * create and configure the query
-         * 
-         */
        Ptr<Dcep> dcep = GetObject<Dcep> ();
+       StringValue file, text;
+       dcep->GetAttribute("QueryFile", file);
+       dcep->GetAttribute("Queries", text);
        
-       Ptr<Query> q1 = CreateObject<Query> ();
+       std::string queries = text.Get();
+       if (!file.Get().empty())
+       {
+           std::ifstream in(file.Get().c_str());
+           NS_ABORT_MSG_IF(!in, "CANNOT READ QUERY FILE " << file.Get());
+           std::stringstream content;
+           content << in.rdbuf();
+           queries = content.str();
+       }
+       else if (queries.empty())
+       {
+           /* the query of the experiments: A op B */
+           StringValue op;
+           dcep->GetAttribute("query operator", op);
+           queries = "SELECT A" + op.Get() + "B FROM " + op.Get() + "(A, B)";
+       }
        
-        q1->actionType = NOTIFICATION;
-
-        q1->id = query_counter++;
-
-        q1->isFinal = false;
-        q1->isAtomic = true;
-        q1->eventType = "A";
-        q1->output_dest = Ipv4Address::GetAny();
-        q1->inevent1 = "A";
-        q1->inevent2 = "";
-        q1->op = "true";
-        q1->assigned = false;
-        q1->currentHost.Set("0.0.0.0");
-        q1->parent_output = "AorB";
-        NS_LOG_INFO ("Setup query " << q1->eventType);
-        dcep->DispatchQuery(q1);
-        
-        /***************************************************************/
-        
-        Ptr<Query> q2 = CreateObject<Query> ();
-        q2->actionType = NOTIFICATION;
-
-        q2->id = query_counter++;
-
-        q2->isFinal = false;
-        q2->isAtomic = true;
-        q2->eventType = "B";
-        q2->output_dest = Ipv4Address::GetAny();
-        q2->inevent1 = "B";
-        q2->inevent2 = "";
-        q2->op = "true";
-        q2->assigned = false;
-        q2->currentHost.Set("0.0.0.0");
-        q2->parent_output = "AorB";
-        NS_LOG_INFO ("Setup query " << q2->eventType);
-        dcep->DispatchQuery(q2);
-        
-        Ptr<Query> q3 = CreateObject<Query> ();
-        q3->actionType = NOTIFICATION;
-
-        q3->id = query_counter++;
-
-        q3->isFinal = true;
-        q3->isAtomic = false;
-        q3->eventType = "AorB";
-        q3->output_dest = Ipv4Address::GetAny();
-        q3->inevent1 = "A";
-        q3->inevent2 = "B";
-        q3->op = "or";
-        q3->assigned = false;
-        q3->currentHost.Set("0.0.0.0");
-        NS_LOG_INFO ("Setup query " << q3->eventType);
-        dcep->DispatchQuery(q3);
-        
-
+       std::vector<Ptr<Query> > compiled;
+       QueryCompiler compiler;
+       compiler.Compile(queries, compiled);
+       
+       for (uint32_t i = 0; i < compiled.size(); i++)
+       {
+           NS_LOG_INFO ("Setup query " << EventTypeTable::GetName(compiled[i]->eventType));
+           nquery(compiled[i]);
+           dcep->DispatchQuery(compiled[i]);
+       }
     }
     
     
@@ -389,9 +441,16 @@ NS_LOG_COMPONENT_DEFINE ("Dcep");
     }
 
     DataSource::DataSource ()
-    : counter(0) 
+    : m_eventTypeId(NO_EVENT_TYPE),
+      counter(0),
+      interval(MilliSeconds (100)),
+      finished(false),
+      advertisedCounter(0)
     {
       NS_LOG_FUNCTION (this);
+      m_values = CreateObject<UniformRandomVariable> ();
+      m_values->SetAttribute ("Min", DoubleValue (0));
+      m_values->SetAttribute ("Max", DoubleValue (100));
       
     }
     
@@ -401,10 +460,91 @@ NS_LOG_COMPONENT_DEFINE ("Dcep");
       Ptr<Dcep> dcep = GetObject<Dcep>();
       UintegerValue ecode, nevents;
       
+      StringValue etype;
+      TimeValue advertise;
+      
       dcep->GetAttribute("event code", ecode);
       dcep->GetAttribute("number of events", nevents);
+      dcep->GetAttribute("EventType", etype);
+      dcep->GetAttribute("AdvertisementInterval", advertise);
       eventCode = ecode.Get();
       numEvents = nevents.Get();
+      advertisementInterval = advertise.Get();
+      
+      m_eventType = etype.Get();
+      if (m_eventType.empty() && (eventCode >= 1) && (eventCode <= 8))
+      {
+          /* event codes 1 to 8 stand for types A to H */
+          m_eventType = std::string(1, 'A' + eventCode - 1);
+      }
+      if (!m_eventType.empty())
+      {
+          m_eventTypeId = EventTypeTable::Intern(m_eventType);
+      }
+    }
+    
+    bool
+    DataSource::Produces(EventTypeId eType)
+    {
+        return (eType != NO_EVENT_TYPE) && (eType == m_eventTypeId) 
+                && GetObject<Dcep>()->isGenerator();
+    }
+    
+    void
+    DataSource::DoDispose (void)
+    {
+        Simulator::Cancel(advertiseEvent);
+        Simulator::Cancel(generateEvent);
+        Object::DoDispose();
+    }
+    
+    double
+    DataSource::GetRate()
+    {
+        Time elapsed = Simulator::Now() - advertisedAt;
+        if ((counter == 0) || !elapsed.IsStrictlyPositive())
+        {
+            /* not activated yet, the rate it will produce at once it is */
+            return 1.0 / interval.GetSeconds();
+        }
+        return (counter - advertisedCounter) / elapsed.GetSeconds();
+    }
+    
+    void
+    DataSource::Advertise()
+    {
+        if ((m_eventTypeId == NO_EVENT_TYPE) || finished)
+        {
+            return;
+        }
+        
+        Ptr<Communication> cm = GetObject<Communication>();
+        SerializedAdvertisement message;
+        message.origin = cm->GetLocalAddress();
+        /* the sink keeps the producer while up to two advertisements are lost */
+        message.lifetime = (advertisementInterval * 3).GetMilliSeconds();
+        message.types.push_back(m_eventTypeId);
+        message.rates.push_back(GetRate());
+        advertisedCounter = counter;
+        advertisedAt = Simulator::Now();
+        
+        if (cm->GetSinkAddress() == cm->GetLocalAddress())
+        {
+            GetObject<Placement>()->RecvAdvertisement(message);
+        }
+        else
+        {
+            DcepHeader dcepHeader;
+            dcepHeader.SetContentType(ADVERTISEMENT);
+            dcepHeader.setContentSize(message.GetSerializedSize());
+            
+            Ptr<Packet> p = Create<Packet> ();
+            p->AddHeader (message);
+            p->AddHeader (dcepHeader);
+            GetObject<Dcep>()->SendPacket(p, cm->GetSinkAddress());
+        }
+        
+        advertiseEvent = Simulator::Schedule (advertisementInterval, &DataSource::Advertise, this);
     }
 
     DataSource::~DataSource ()
@@ -419,56 +559,36 @@ NS_LOG_COMPONENT_DEFINE ("Dcep");
             
             NS_LOG_INFO ("Starting to generate events of type " << m_eventType );
             
-            
-            switch(eventCode)
-            {
-                case 1:
-                    m_eventType = "A";
-                    break;
-                case 2:
-                    m_eventType = "B";
-                    break;
-                case 3:
-                    m_eventType = "C";
-                    break;
-                case 4:
-                    m_eventType = "D";
-                    break;
-                case 5: 
-                    m_eventType = "E";
-                    break;
-                case 6:
-                    m_eventType = "F";
-                    break;
-                case 7:
-                    m_eventType = "G";
-                    break;
-                case 8:
-                    m_eventType = "H";
-                    break;
-                default:
-                    m_eventType = " ";
-                     
-            }
-            
-            if(m_eventType != " ")
+            if(m_eventTypeId != NO_EVENT_TYPE)
             {
                counter++;
-                Ptr<Event> e = CreateObject<Event>();
+                Ptr<Event> e = Create<Event>();
                 NS_LOG_INFO("creating event of type " << m_eventType);
-                e->type = m_eventType;
+                e->type = m_eventTypeId;
                 e->event_class = ATOMIC_EVENT;
                 e->delay = 0; //initializing delay
                 e->m_seq = counter;
                 e->hopsCount = 0;
                 e->prevHopsCount = 0;
+                e->value = m_values->GetValue();
+                for(uint32_t i = 0; i < EventTypeTable::GetAttributeCount(e->type); i++)
+                {
+                    e->attributes[i] = m_values->GetValue();
+                }
                 NS_LOG_INFO("Event number  " << e->m_seq);
                 dcep->DispatchAtomicEvent(e);
                 
                 NS_LOG_INFO("counter " << counter);
                 if(counter < numEvents)
                 {
-                    Simulator::Schedule (MilliSeconds (100), &DataSource::GenerateAtomicEvents, this);
+                    generateEvent = Simulator::Schedule (interval, &DataSource::GenerateAtomicEvents, this);
+                }
+                else
+                {
+                    /* the sink forgets this producer once the last advertisement expires */
+                    NS_LOG_INFO("DATASOURCE: ALL EVENTS GENERATED, STOP ADVERTISING");
+                    finished = true;
+                    Simulator::Cancel(advertiseEvent);
                 }
                     
               
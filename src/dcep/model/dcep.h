@@ -26,7 +26,9 @@
 #include "ns3/event-id.h"
 #include "ns3/application.h"
 #include "ns3/traced-callback.h"
+#include "ns3/random-variable-stream.h"
 #include "resource-manager.h"
+#include "event-type.h"
 
 namespace ns3 {
 
@@ -51,7 +53,11 @@ class Dcep : public Application
         
         void ActivateDatasource (Ptr<Query> q);
         void DispatchAtomicEvent (Ptr<Event> e);
-        void rcvRemoteMsg(uint8_t *data, uint32_t size, uint16_t msg_type, uint64_t delay);
+        /*
+         * p holds the message body, the communication layer has already
+         * removed the dcep header giving its type.
+         */
+        void rcvRemoteMsg(Ptr<Packet> p, uint16_t msg_type, uint64_t delay);
         void SendFinalEventToSink(Ptr<Event>);
 private:
     
@@ -64,9 +70,13 @@ private:
         uint16_t m_cepPort; 
         uint16_t event_code;
         uint32_t events_load;
-        uint16_t operators_load;
         std::string placementPolicy;
         std::string routing_protocol;
+        std::string query_operator;
+        std::string event_type;
+        std::string queries;
+        std::string query_file;
+        Time advertisementInterval;
         
         TracedCallback<uint32_t> RxFinalEvent;
         TracedCallback<uint32_t> RxFinalEventHops;
@@ -113,15 +123,38 @@ class DataSource : public Object
       
       void Configure();
       void GenerateAtomicEvents();
+      /* true if this node generates events of the given type */
+      bool Produces(EventTypeId eType);
+      /*
+       * tells the sink which type this node produces and at which rate,
+       * again every AdvertisementInterval so that the sink learns about
+       * new or moved datasources and forgets the ones which stopped.
+       * Stops once all the events have been generated.
+       */
+      void Advertise();
+      
+    protected:
+      virtual void DoDispose (void);
       
     private:
+      /* events per second, measured since the previous advertisement */
+      double GetRate();
 
       std::string m_eventType;
+      EventTypeId m_eventTypeId;
       uint32_t numEvents;
       uint32_t eventRate;
       uint32_t counter;
       uint32_t eventCode;
+      Time interval;//between two generated events
+      Time advertisementInterval;
+      EventId advertiseEvent;
+      EventId generateEvent;
+      bool finished;
+      uint32_t advertisedCounter;//counter at the previous advertisement
+      Time advertisedAt;
       TracedCallback<Ptr<Event>> nevent;
+      Ptr<UniformRandomVariable> m_values; //readings carried by the events
       
 
     };
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2018, Fabrice S. Bigirimana
+ * Copyright (c) 2018, University of Oslo
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ * 
+ */
+
+#include "event-type.h"
+#include "ns3/abort.h"
+
+namespace ns3
+{
+    EventTypeTable::EventTypeTable ()
+    {
+        /* id 0 is reserved for the empty type */
+        names.push_back("");
+        schemas.resize(1);
+        ids[""] = NO_EVENT_TYPE;
+    }
+    
+    EventTypeTable&
+    EventTypeTable::Get (void)
+    {
+        static EventTypeTable table;
+        return table;
+    }
+    
+    EventTypeId
+    EventTypeTable::Intern (const std::string &name)
+    {
+        EventTypeTable &table = Get();
+        std::unordered_map<std::string, EventTypeId>::const_iterator it = table.ids.find(name);
+        if(it != table.ids.end())
+        {
+            return it->second;
+        }
+        
+        EventTypeId id = table.names.size();
+        table.names.push_back(name);
+        table.schemas.resize(id + 1);
+        table.ids[name] = id;
+        return id;
+    }
+    
+    const std::string&
+    EventTypeTable::GetName (EventTypeId id)
+    {
+        EventTypeTable &table = Get();
+        NS_ABORT_MSG_IF (id >= table.names.size(), "UNKNOWN EVENT TYPE ID " << id);
+        return table.names[id];
+    }
+    
+    uint32_t
+    EventTypeTable::GetSize (void)
+    {
+        return Get().names.size();
+    }
+    
+    uint32_t
+    EventTypeTable::InternAttribute (EventTypeId type, const std::string &name)
+    {
+        EventTypeTable &table = Get();
+        NS_ABORT_MSG_IF (type >= table.names.size(), "UNKNOWN EVENT TYPE ID " << type);
+        std::vector<std::string> &schema = table.schemas[type];
+        for(uint32_t i = 0; i < schema.size(); i++)
+        {
+            if(schema[i] == name)
+            {
+                return i;
+            }
+        }
+        
+        NS_ABORT_MSG_IF (schema.size() >= MAX_EVENT_ATTRIBUTES, 
+                "TOO MANY ATTRIBUTES FOR EVENT TYPE " << table.names[type]);
+        schema.push_back(name);
+        return schema.size() - 1;
+    }
+    
+    bool
+    EventTypeTable::LookupAttribute (EventTypeId type, const std::string &name, uint32_t &index)
+    {
+        EventTypeTable &table = Get();
+        if(type >= table.names.size())
+        {
+            return false;
+        }
+        const std::vector<std::string> &schema = table.schemas[type];
+        for(uint32_t i = 0; i < schema.size(); i++)
+        {
+            if(schema[i] == name)
+            {
+                index = i;
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    uint32_t
+    EventTypeTable::GetAttributeCount (EventTypeId type)
+    {
+        EventTypeTable &table = Get();
+        NS_ABORT_MSG_IF (type >= table.names.size(), "UNKNOWN EVENT TYPE ID " << type);
+        return table.schemas[type].size();
+    }
+    
+    const std::string&
+    EventTypeTable::GetAttributeName (EventTypeId type, uint32_t index)
+    {
+        EventTypeTable &table = Get();
+        NS_ABORT_MSG_IF (index >= GetAttributeCount(type), "UNKNOWN ATTRIBUTE " << index);
+        return table.schemas[type][index];
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2018, Fabrice S. Bigirimana
+ * Copyright (c) 2018, University of Oslo
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ * 
+ */
+
+#ifndef EVENT_TYPE_H
+#define EVENT_TYPE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace ns3
+{
+    /**
+     * compact identifier of an event type. Event types are interned once 
+     * in the EventTypeTable and only handled by id inside the engine,
+     * the placement mechanism and the dcep state.
+     */
+    typedef uint32_t EventTypeId;
+    
+    /**
+     * the id of the empty event type, e.g. the missing second input of 
+     * an atomic query.
+     */
+#define NO_EVENT_TYPE 0
+    
+    /**
+     * upper bound on the number of payload attributes of an event type.
+     * Events keep their attributes in a fixed array of this size.
+     */
+#define MAX_EVENT_ATTRIBUTES 4
+    
+    /**
+     * global symbol table mapping event type names to ids and back.
+     * Names are only needed for logging and when events and queries
+     * are serialized.
+     * The table also holds the schema of each type: the names of its
+     * numeric payload attributes, in the order they are stored in events.
+     */
+    class EventTypeTable
+    {
+    public:
+        /**
+         * returns the id of the given type name, creating one if the
+         * name has not been seen before.
+         */
+        static EventTypeId Intern (const std::string &name);
+        static const std::string& GetName (EventTypeId id);
+        static uint32_t GetSize (void);
+        /**
+         * returns the index of the named attribute of the given type,
+         * adding it to the schema of the type if needed.
+         */
+        static uint32_t InternAttribute (EventTypeId type, const std::string &name);
+        /**
+         * finds the index of the named attribute of the given type without
+         * changing its schema, returns false if the type has no such attribute.
+         */
+        static bool LookupAttribute (EventTypeId type, const std::string &name, uint32_t &index);
+        static uint32_t GetAttributeCount (EventTypeId type);
+        static const std::string& GetAttributeName (EventTypeId type, uint32_t index);
+        
+    private:
+        EventTypeTable ();
+        static EventTypeTable& Get (void);
+        
+        std::unordered_map<std::string, EventTypeId> ids;
+        std::vector<std::string> names;
+        std::vector<std::vector<std::string> > schemas;
+    };
+}
+
+#endif /* EVENT_TYPE_H */
+
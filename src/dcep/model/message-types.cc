@@ -0,0 +1,637 @@
+/*
+ * Copyright (C) 2018, Fabrice S. Bigirimana
+ * Copyright (c) 2018, University of Oslo
+ * 
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ * 
+ */
+
+#include "message-types.h"
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include <cstring>
+
+namespace ns3
+{
+    NS_OBJECT_ENSURE_REGISTERED (SerializedQuery);
+    NS_OBJECT_ENSURE_REGISTERED (SerializedEvent);
+    NS_OBJECT_ENSURE_REGISTERED (SerializedMigration);
+    NS_OBJECT_ENSURE_REGISTERED (SerializedAdvertisement);
+    NS_OBJECT_ENSURE_REGISTERED (SerializedReliable);
+    NS_OBJECT_ENSURE_REGISTERED (SerializedAck);
+    
+    /* longest event type name or operator string which can be sent */
+#define MAX_STRING_SIZE 0xffff
+    
+    TypeId
+    DcepMessage::GetTypeId (void)
+    {
+        static TypeId tid = TypeId ("ns3::DcepMessage")
+        .SetParent<Header> ()
+        ;
+        return tid;
+    }
+    
+    void
+    DcepMessage::WriteString (Buffer::Iterator &start, const std::string &s)
+    {
+        NS_ABORT_MSG_IF (s.size() > MAX_STRING_SIZE, "STRING TOO LONG TO BE SERIALIZED");
+        start.WriteHtonU16 (s.size());
+        start.Write ((const uint8_t *) s.data(), s.size());
+    }
+    
+    std::string
+    DcepMessage::ReadString (Buffer::Iterator &start)
+    {
+        uint16_t size = start.ReadNtohU16 ();
+        std::string s (size, '\0');
+        start.Read ((uint8_t *) &s[0], size);
+        return s;
+    }
+    
+    uint32_t
+    DcepMessage::GetStringSize (const std::string &s)
+    {
+        return sizeof(uint16_t) + s.size();
+    }
+    
+    void
+    DcepMessage::WriteDouble (Buffer::Iterator &start, double d)
+    {
+        uint64_t bits;
+        std::memcpy (&bits, &d, sizeof(bits));
+        start.WriteHtonU64 (bits);
+    }
+    
+    double
+    DcepMessage::ReadDouble (Buffer::Iterator &start)
+    {
+        uint64_t bits = start.ReadNtohU64 ();
+        double d;
+        std::memcpy (&d, &bits, sizeof(d));
+        return d;
+    }
+    
+    void
+    DcepMessage::WriteEventType (Buffer::Iterator &start, EventTypeId type)
+    {
+        WriteString (start, EventTypeTable::GetName(type));
+    }
+    
+    EventTypeId
+    DcepMessage::ReadEventType (Buffer::Iterator &start)
+    {
+        return EventTypeTable::Intern (ReadString (start));
+    }
+    
+    uint32_t
+    DcepMessage::GetEventTypeSize (EventTypeId type)
+    {
+        return GetStringSize (EventTypeTable::GetName(type));
+    }
+    
+    
+    /************** QUERY MESSAGE **************
+     * ***********************************************
+     * *************************************************/
+    
+    TypeId
+    SerializedQuery::GetTypeId (void)
+    {
+        static TypeId tid = TypeId ("ns3::SerializedQuery")
+        .SetParent<DcepMessage> ()
+        .AddConstructor<SerializedQuery> ()
+        ;
+        return tid;
+    }
+    
+    TypeId
+    SerializedQuery::GetInstanceTypeId (void) const
+    {
+        return GetTypeId ();
+    }
+    
+    SerializedQuery::SerializedQuery ()
+    : q_id (0),
+      eventType (NO_EVENT_TYPE),
+      isFinal (false),
+      isAtomic (false),
+      actionType (0),
+      inputStream1_rate (0),
+      inputStream2_rate (0),
+      output_rate (0),
+      placement_steps (0),
+      inevent1 (NO_EVENT_TYPE),
+      inevent2 (NO_EVENT_TYPE),
+      parent_output (NO_EVENT_TYPE),
+      window_type (NO_WINDOW),
+      window_mode (SLIDING_WINDOW),
+      window_length (0),
+      window_count (0),
+      threshold (0),
+      report_period (0),
+      assigned (false)
+    {}
+    
+    void
+    SerializedQuery::Print (std::ostream &os) const
+    {
+        os << "query " << q_id << " type " << EventTypeTable::GetName(eventType)
+           << " op " << op;
+    }
+    
+    uint32_t
+    SerializedQuery::GetSerializedSize (void) const
+    {
+        uint32_t inevents_size = sizeof(uint16_t);
+        for (uint32_t i = 0; i < inevents.size (); i++)
+        {
+            inevents_size += GetEventTypeSize (inevents[i]);
+        }
+        uint32_t parents_size = sizeof(uint16_t) * 2 + 4 * other_output_dests.size ();
+        for (uint32_t i = 0; i < other_parent_outputs.size (); i++)
+        {
+            parents_size += GetEventTypeSize (other_parent_outputs[i]);
+        }
+        
+        return sizeof(uint32_t) /* q_id */
+                + GetEventTypeSize (eventType)
+                + 2 /* isFinal, isAtomic */
+                + sizeof(uint32_t) /* actionType */
+                + 4 * 4 /* addresses */
+                + sizeof(uint64_t) * 3 + sizeof(uint32_t) /* stream rates, placement steps */
+                + GetEventTypeSize (inevent1)
+                + GetEventTypeSize (inevent2)
+                + GetEventTypeSize (parent_output)
+                + parents_size
+                + inevents_size
+                + GetStringSize (op)
+                + GetStringSize (filter)
+                + 2 /* window type and mode */
+                + sizeof(uint64_t) + sizeof(uint32_t) /* window size */
+                + sizeof(uint64_t) * 2 /* threshold, report_period */
+                + 1 /* assigned */;
+    }
+    
+    void
+    SerializedQuery::Serialize (Buffer::Iterator start) const
+    {
+        start.WriteHtonU32 (q_id);
+        WriteEventType (start, eventType);
+        start.WriteU8 (isFinal);
+        start.WriteU8 (isAtomic);
+        start.WriteHtonU32 (actionType);
+        start.WriteHtonU32 (output_dest.Get());
+        start.WriteHtonU32 (inputStream1_address.Get());
+        start.WriteHtonU32 (inputStream2_address.Get());
+        start.WriteHtonU32 (currentHost.Get());
+        WriteDouble (start, inputStream1_rate);
+        WriteDouble (start, inputStream2_rate);
+        WriteDouble (start, output_rate);
+        start.WriteHtonU32 (placement_steps);
+        WriteEventType (start, inevent1);
+        WriteEventType (start, inevent2);
+        WriteEventType (start, parent_output);
+        start.WriteHtonU16 (other_parent_outputs.size ());
+        for (uint32_t i = 0; i < other_parent_outputs.size (); i++)
+        {
+            WriteEventType (start, other_parent_outputs[i]);
+        }
+        start.WriteHtonU16 (other_output_dests.size ());
+        for (uint32_t i = 0; i < other_output_dests.size (); i++)
+        {
+            start.WriteHtonU32 (other_output_dests[i].Get ());
+        }
+        start.WriteHtonU16 (inevents.size ());
+        for (uint32_t i = 0; i < inevents.size (); i++)
+        {
+            WriteEventType (start, inevents[i]);
+        }
+        WriteString (start, op);
+        WriteString (start, filter);
+        start.WriteU8 (window_type);
+        start.WriteU8 (window_mode);
+        start.WriteHtonU64 (window_length);
+        start.WriteHtonU32 (window_count);
+        WriteDouble (start, threshold);
+        start.WriteHtonU64 (report_period);
+        start.WriteU8 (assigned);
+    }
+    
+    uint32_t
+    SerializedQuery::Deserialize (Buffer::Iterator start)
+    {
+        q_id = start.ReadNtohU32 ();
+        eventType = ReadEventType (start);
+        isFinal = start.ReadU8 ();
+        isAtomic = start.ReadU8 ();
+        actionType = start.ReadNtohU32 ();
+        output_dest.Set (start.ReadNtohU32 ());
+        inputStream1_address.Set (start.ReadNtohU32 ());
+        inputStream2_address.Set (start.ReadNtohU32 ());
+        currentHost.Set (start.ReadNtohU32 ());
+        inputStream1_rate = ReadDouble (start);
+        inputStream2_rate = ReadDouble (start);
+        output_rate = ReadDouble (start);
+        placement_steps = start.ReadNtohU32 ();
+        inevent1 = ReadEventType (start);
+        inevent2 = ReadEventType (start);
+        parent_output = ReadEventType (start);
+        other_parent_outputs.resize (start.ReadNtohU16 ());
+        for (uint32_t i = 0; i < other_parent_outputs.size (); i++)
+        {
+            other_parent_outputs[i] = ReadEventType (start);
+        }
+        other_output_dests.resize (start.ReadNtohU16 ());
+        for (uint32_t i = 0; i < other_output_dests.size (); i++)
+        {
+            other_output_dests[i].Set (start.ReadNtohU32 ());
+        }
+        inevents.resize (start.ReadNtohU16 ());
+        for (uint32_t i = 0; i < inevents.size (); i++)
+        {
+            inevents[i] = ReadEventType (start);
+        }
+        op = ReadString (start);
+        filter = ReadString (start);
+        window_type = start.ReadU8 ();
+        window_mode = start.ReadU8 ();
+        window_length = start.ReadNtohU64 ();
+        window_count = start.ReadNtohU32 ();
+        threshold = ReadDouble (start);
+        report_period = start.ReadNtohU64 ();
+        assigned = start.ReadU8 ();
+        return GetSerializedSize ();
+    }
+    
+    
+    /************** EVENT MESSAGE **************
+     * ***********************************************
+     * *************************************************/
+    
+    TypeId
+    SerializedEvent::GetTypeId (void)
+    {
+        static TypeId tid = TypeId ("ns3::SerializedEvent")
+        .SetParent<DcepMessage> ()
+        .AddConstructor<SerializedEvent> ()
+        ;
+        return tid;
+    }
+    
+    TypeId
+    SerializedEvent::GetInstanceTypeId (void) const
+    {
+        return GetTypeId ();
+    }
+    
+    SerializedEvent::SerializedEvent ()
+    : type (NO_EVENT_TYPE),
+      event_class (0),
+      delay (0),
+      m_seq (0),
+      hopsCount (0),
+      prevHopsCount (0),
+      value (0),
+      attribute_count (0)
+    {}
+    
+    void
+    SerializedEvent::Print (std::ostream &os) const
+    {
+        os << "event type " << EventTypeTable::GetName(type) << " seq " << m_seq;
+    }
+    
+    uint32_t
+    SerializedEvent::GetSerializedSize (void) const
+    {
+        return GetEventTypeSize (type)
+                + 1 /* event_class */
+                + sizeof(uint64_t) * 2 /* delay, m_seq */
+                + sizeof(uint32_t) * 2 /* hop counts */
+                + sizeof(uint64_t) /* value */
+                + 1 + attribute_count * sizeof(uint64_t) /* attributes */;
+    }
+    
+    void
+    SerializedEvent::Serialize (Buffer::Iterator start) const
+    {
+        WriteEventType (start, type);
+        start.WriteU8 (event_class);
+        start.WriteHtonU64 (delay);
+        start.WriteHtonU64 (m_seq);
+        start.WriteHtonU32 (hopsCount);
+        start.WriteHtonU32 (prevHopsCount);
+        WriteDouble (start, value);
+        start.WriteU8 (attribute_count);
+        for (uint32_t i = 0; i < attribute_count; i++)
+        {
+            WriteDouble (start, attributes[i]);
+        }
+    }
+    
+    uint32_t
+    SerializedEvent::Deserialize (Buffer::Iterator start)
+    {
+        type = ReadEventType (start);
+        event_class = start.ReadU8 ();
+        delay = start.ReadNtohU64 ();
+        m_seq = start.ReadNtohU64 ();
+        hopsCount = start.ReadNtohU32 ();
+        prevHopsCount = start.ReadNtohU32 ();
+        value = ReadDouble (start);
+        attribute_count = start.ReadU8 ();
+        NS_ABORT_MSG_IF (attribute_count > MAX_EVENT_ATTRIBUTES, "TOO MANY EVENT ATTRIBUTES");
+        for (uint32_t i = 0; i < attribute_count; i++)
+        {
+            attributes[i] = ReadDouble (start);
+        }
+        return GetSerializedSize ();
+    }
+    
+    
+    /************** MIGRATION MESSAGE **************
+     * ***********************************************
+     * *************************************************/
+    
+    TypeId
+    SerializedMigration::GetTypeId (void)
+    {
+        static TypeId tid = TypeId ("ns3::SerializedMigration")
+        .SetParent<DcepMessage> ()
+        .AddConstructor<SerializedMigration> ()
+        ;
+        return tid;
+    }
+    
+    TypeId
+    SerializedMigration::GetInstanceTypeId (void) const
+    {
+        return GetTypeId ();
+    }
+    
+    SerializedMigration::SerializedMigration ()
+    : eventType (NO_EVENT_TYPE),
+      stream (NO_EVENT_TYPE),
+      host (Ipv4Address::GetAny ()),
+      origin (Ipv4Address::GetAny ()),
+      output_dest (Ipv4Address::GetAny ()),
+      event_count (0)
+    {}
+    
+    void
+    SerializedMigration::Print (std::ostream &os) const
+    {
+        os << "operator " << EventTypeTable::GetName(eventType) << " host " << host
+                << " origin " << origin << " events " << event_count;
+    }
+    
+    uint32_t
+    SerializedMigration::GetSerializedSize (void) const
+    {
+        return GetEventTypeSize (eventType)
+                + GetEventTypeSize (stream)
+                + sizeof(uint32_t) * 3 /* addresses */
+                + sizeof(uint32_t) /* event_count */
+                + sizeof(uint64_t) * event_count /* arrivals */;
+    }
+    
+    void
+    SerializedMigration::Serialize (Buffer::Iterator start) const
+    {
+        WriteEventType (start, eventType);
+        WriteEventType (start, stream);
+        start.WriteHtonU32 (host.Get ());
+        start.WriteHtonU32 (origin.Get ());
+        start.WriteHtonU32 (output_dest.Get ());
+        start.WriteHtonU32 (event_count);
+        NS_ASSERT (arrivals.size () == event_count);
+        for (uint32_t i = 0; i < event_count; i++)
+        {
+            start.WriteHtonU64 (arrivals[i].GetTimeStep ());
+        }
+    }
+    
+    uint32_t
+    SerializedMigration::Deserialize (Buffer::Iterator start)
+    {
+        eventType = ReadEventType (start);
+        stream = ReadEventType (start);
+        host.Set (start.ReadNtohU32 ());
+        origin.Set (start.ReadNtohU32 ());
+        output_dest.Set (start.ReadNtohU32 ());
+        event_count = start.ReadNtohU32 ();
+        arrivals.resize (event_count);
+        for (uint32_t i = 0; i < event_count; i++)
+        {
+            arrivals[i] = TimeStep (start.ReadNtohU64 ());
+        }
+        return GetSerializedSize ();
+    }
+    
+    
+    /************** ADVERTISEMENT MESSAGE ************
+     * ***********************************************
+     * *************************************************/
+    
+    TypeId
+    SerializedAdvertisement::GetTypeId (void)
+    {
+        static TypeId tid = TypeId ("ns3::SerializedAdvertisement")
+        .SetParent<DcepMessage> ()
+        .AddConstructor<SerializedAdvertisement> ()
+        ;
+        return tid;
+    }
+    
+    TypeId
+    SerializedAdvertisement::GetInstanceTypeId (void) const
+    {
+        return GetTypeId ();
+    }
+    
+    SerializedAdvertisement::SerializedAdvertisement ()
+    : origin (Ipv4Address::GetAny ()),
+      lifetime (0)
+    {}
+    
+    void
+    SerializedAdvertisement::Print (std::ostream &os) const
+    {
+        os << "producer " << origin;
+        for (uint32_t i = 0; i < types.size(); i++)
+        {
+            os << " " << EventTypeTable::GetName(types[i]) << "@" << rates[i];
+        }
+    }
+    
+    uint32_t
+    SerializedAdvertisement::GetSerializedSize (void) const
+    {
+        uint32_t size = sizeof(uint32_t) /* origin */
+                + sizeof(uint32_t) /* lifetime */
+                + sizeof(uint16_t) /* number of types */;
+        for (uint32_t i = 0; i < types.size(); i++)
+        {
+            size += GetEventTypeSize (types[i]) + sizeof(uint64_t) /* rate */;
+        }
+        return size;
+    }
+    
+    void
+    SerializedAdvertisement::Serialize (Buffer::Iterator start) const
+    {
+        NS_ABORT_MSG_IF (types.size() != rates.size(), "ONE RATE PER ADVERTISED TYPE");
+        NS_ABORT_MSG_IF (types.size() > 0xffff, "TOO MANY TYPES TO ADVERTISE");
+        start.WriteHtonU32 (origin.Get ());
+        start.WriteHtonU32 (lifetime);
+        start.WriteHtonU16 (types.size());
+        for (uint32_t i = 0; i < types.size(); i++)
+        {
+            WriteEventType (start, types[i]);
+            WriteDouble (start, rates[i]);
+        }
+    }
+    
+    uint32_t
+    SerializedAdvertisement::Deserialize (Buffer::Iterator start)
+    {
+        origin.Set (start.ReadNtohU32 ());
+        lifetime = start.ReadNtohU32 ();
+        uint16_t count = start.ReadNtohU16 ();
+        types.clear();
+        rates.clear();
+        for (uint32_t i = 0; i < count; i++)
+        {
+            types.push_back (ReadEventType (start));
+            rates.push_back (ReadDouble (start));
+        }
+        return GetSerializedSize ();
+    }
+    
+    
+    /************** RELIABILITY MESSAGES *************
+     * ***********************************************
+     * *************************************************/
+    
+    TypeId
+    SerializedReliable::GetTypeId (void)
+    {
+        static TypeId tid = TypeId ("ns3::SerializedReliable")
+        .SetParent<DcepMessage> ()
+        .AddConstructor<SerializedReliable> ()
+        ;
+        return tid;
+    }
+    
+    TypeId
+    SerializedReliable::GetInstanceTypeId (void) const
+    {
+        return GetTypeId ();
+    }
+    
+    SerializedReliable::SerializedReliable ()
+    : seq (0),
+      lowest (0)
+    {}
+    
+    void
+    SerializedReliable::Print (std::ostream &os) const
+    {
+        os << "seq " << seq << " lowest " << lowest;
+    }
+    
+    uint32_t
+    SerializedReliable::GetSerializedSize (void) const
+    {
+        return sizeof(uint32_t) * 2;
+    }
+    
+    void
+    SerializedReliable::Serialize (Buffer::Iterator start) const
+    {
+        start.WriteHtonU32 (seq);
+        start.WriteHtonU32 (lowest);
+    }
+    
+    uint32_t
+    SerializedReliable::Deserialize (Buffer::Iterator start)
+    {
+        seq = start.ReadNtohU32 ();
+        lowest = start.ReadNtohU32 ();
+        return GetSerializedSize ();
+    }
+    
+    TypeId
+    SerializedAck::GetTypeId (void)
+    {
+        static TypeId tid = TypeId ("ns3::SerializedAck")
+        .SetParent<DcepMessage> ()
+        .AddConstructor<SerializedAck> ()
+        ;
+        return tid;
+    }
+    
+    TypeId
+    SerializedAck::GetInstanceTypeId (void) const
+    {
+        return GetTypeId ();
+    }
+    
+    SerializedAck::SerializedAck ()
+    : cumulative (0)
+    {}
+    
+    void
+    SerializedAck::Print (std::ostream &os) const
+    {
+        os << "ack " << cumulative;
+        for (uint32_t i = 0; i < selective.size(); i++)
+        {
+            os << " " << selective[i];
+        }
+    }
+    
+    uint32_t
+    SerializedAck::GetSerializedSize (void) const
+    {
+        return sizeof(uint32_t) /* cumulative */
+                + sizeof(uint16_t) /* number of selective acks */
+                + selective.size() * sizeof(uint32_t);
+    }
+    
+    void
+    SerializedAck::Serialize (Buffer::Iterator start) const
+    {
+        NS_ABORT_MSG_IF (selective.size() > 0xffff, "TOO MANY SELECTIVE ACKS");
+        start.WriteHtonU32 (cumulative);
+        start.WriteHtonU16 (selective.size());
+        for (uint32_t i = 0; i < selective.size(); i++)
+        {
+            start.WriteHtonU32 (selective[i]);
+        }
+    }
+    
+    uint32_t
+    SerializedAck::Deserialize (Buffer::Iterator start)
+    {
+        cumulative = start.ReadNtohU32 ();
+        uint16_t count = start.ReadNtohU16 ();
+        selective.clear();
+        for (uint32_t i = 0; i < count; i++)
+        {
+            selective.push_back (start.ReadNtohU32 ());
+        }
+        return GetSerializedSize ();
+    }
+}
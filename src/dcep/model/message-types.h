@@ -20,53 +20,197 @@
 #define MESSAGE_H
 
 #include "ns3/object-factory.h"
+#include "ns3/header.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
 #include "common.h"
+#include "event-type.h"
 #include <stdint.h>
+#include <vector>
 
 
 namespace ns3
 {
     
-    class DcepMessage
+    /**
+     * Wire formats of the DCEP messages. Each message is a fixed layout
+     * header written straight into the packet buffer, in network byte 
+     * order. Event types travel as length prefixed names and are interned
+     * again on the receiving node.
+     */
+    class DcepMessage : public Header
     {
     public:
-        uint32_t size;
-        uint16_t msg_type;
+        static TypeId GetTypeId (void);
+        
+    protected:
+        static void WriteEventType (Buffer::Iterator &start, EventTypeId type);
+        static EventTypeId ReadEventType (Buffer::Iterator &start);
+        static uint32_t GetEventTypeSize (EventTypeId type);
+        static void WriteString (Buffer::Iterator &start, const std::string &s);
+        static std::string ReadString (Buffer::Iterator &start);
+        static uint32_t GetStringSize (const std::string &s);
+        /* doubles are sent as their IEEE 754 bit pattern */
+        static void WriteDouble (Buffer::Iterator &start, double d);
+        static double ReadDouble (Buffer::Iterator &start);
     };
     
     class SerializedQuery: public DcepMessage
     {
     public: 
+        SerializedQuery ();
+        
+        static TypeId GetTypeId (void);
+        virtual TypeId GetInstanceTypeId (void) const;
+        virtual void Print (std::ostream &os) const;
+        virtual void Serialize (Buffer::Iterator start) const;
+        virtual uint32_t Deserialize (Buffer::Iterator start);
+        virtual uint32_t GetSerializedSize (void) const;
         
         uint32_t q_id;
-       // char event1[MAX_ATTR_SIZE];
-       // char event2[MAX_ATTR_SIZE];
-        std::string eventType;
-        //char op[MAX_ATTR_SIZE];
+        EventTypeId eventType;
         bool isFinal;
         bool isAtomic;
         uint32_t actionType;
-        uint8_t output_dest[4];
-        uint8_t inputStream1_address[4];
-        uint8_t inputStream2_address[4];
-        uint8_t currentHost[4];
-        std::string inevent1;
-        std::string inevent2;
-        std::string parent_output;
+        Ipv4Address output_dest;
+        Ipv4Address inputStream1_address;
+        Ipv4Address inputStream2_address;
+        Ipv4Address currentHost;
+        double inputStream1_rate;
+        double inputStream2_rate;
+        double output_rate;
+        uint32_t placement_steps;
+        EventTypeId inevent1;
+        EventTypeId inevent2;
+        EventTypeId parent_output;
+        std::vector<EventTypeId> other_parent_outputs;
+        std::vector<Ipv4Address> other_output_dests;
+        std::vector<EventTypeId> inevents;
         std::string op;
+        std::string filter;
+        uint32_t window_type;
+        uint32_t window_mode;
+        uint64_t window_length;//in milliseconds
+        uint32_t window_count;
+        double threshold;
+        uint64_t report_period;//in milliseconds
         bool assigned;
     };
     
     class SerializedEvent: public DcepMessage
     {
     public:
-        std::string type;
+        SerializedEvent ();
+        
+        static TypeId GetTypeId (void);
+        virtual TypeId GetInstanceTypeId (void) const;
+        virtual void Print (std::ostream &os) const;
+        virtual void Serialize (Buffer::Iterator start) const;
+        virtual uint32_t Deserialize (Buffer::Iterator start);
+        virtual uint32_t GetSerializedSize (void) const;
+        
+        EventTypeId type;
         uint32_t event_class;
         uint64_t delay;
         uint64_t m_seq;
         uint32_t hopsCount;
         uint32_t prevHopsCount;
+        double value;
+        uint8_t attribute_count;
+        double attributes[MAX_EVENT_ATTRIBUTES];
+        
+    };
+    
+    /**
+     * Control message of the operator migration protocol. The operator 
+     * is identified by the type of the events it produces. MIGRATION 
+     * messages are followed by the query of the operator, MIGRATION and
+     * RESUME messages by event_count events, whose arrival times are
+     * carried here.
+     */
+    class SerializedMigration: public DcepMessage
+    {
+    public:
+        SerializedMigration ();
+        
+        static TypeId GetTypeId (void);
+        virtual TypeId GetInstanceTypeId (void) const;
+        virtual void Print (std::ostream &os) const;
+        virtual void Serialize (Buffer::Iterator start) const;
+        virtual uint32_t Deserialize (Buffer::Iterator start);
+        virtual uint32_t GetSerializedSize (void) const;
+        
+        EventTypeId eventType;
+        EventTypeId stream;//the input stream being redirected
+        Ipv4Address host;//the new host of the operator
+        Ipv4Address origin;//the previous host, where acks go
+        Ipv4Address output_dest;
+        uint32_t event_count;
+        std::vector<Time> arrivals;//one per event, see Event::arrival
+    };
+    
+    /**
+     * Sent periodically by a datasource to the sink, with the event types
+     * it produces and their rates in events per second. The producer is
+     * forgotten if it does not advertise again within lifetime.
+     */
+    class SerializedAdvertisement: public DcepMessage
+    {
+    public:
+        SerializedAdvertisement ();
+        
+        static TypeId GetTypeId (void);
+        virtual TypeId GetInstanceTypeId (void) const;
+        virtual void Print (std::ostream &os) const;
+        virtual void Serialize (Buffer::Iterator start) const;
+        virtual uint32_t Deserialize (Buffer::Iterator start);
+        virtual uint32_t GetSerializedSize (void) const;
+        
+        Ipv4Address origin;
+        uint32_t lifetime;//milliseconds
+        std::vector<EventTypeId> types;
+        std::vector<double> rates;
+    };
+    
+    /**
+     * Precedes a message sent reliably, numbered per destination from 1.
+     * The messages before lowest were acknowledged or given up by the
+     * sender, the receiver does not wait for them anymore.
+     */
+    class SerializedReliable: public DcepMessage
+    {
+    public:
+        SerializedReliable ();
+        
+        static TypeId GetTypeId (void);
+        virtual TypeId GetInstanceTypeId (void) const;
+        virtual void Print (std::ostream &os) const;
+        virtual void Serialize (Buffer::Iterator start) const;
+        virtual uint32_t Deserialize (Buffer::Iterator start);
+        virtual uint32_t GetSerializedSize (void) const;
+        
+        uint32_t seq;
+        uint32_t lowest;
+    };
+    
+    /**
+     * Acknowledges every reliable message up to cumulative, and the ones
+     * received beyond it listed in selective.
+     */
+    class SerializedAck: public DcepMessage
+    {
+    public:
+        SerializedAck ();
+        
+        static TypeId GetTypeId (void);
+        virtual TypeId GetInstanceTypeId (void) const;
+        virtual void Print (std::ostream &os) const;
+        virtual void Serialize (Buffer::Iterator start) const;
+        virtual uint32_t Deserialize (Buffer::Iterator start);
+        virtual uint32_t GetSerializedSize (void) const;
         
+        uint32_t cumulative;
+        std::vector<uint32_t> selective;
     };
     
     
@@ -35,12 +35,15 @@
 #include "resource-manager.h"
 #include "src/network/utils/ipv4-address.h"
 #include "dcep-state.h"
+#include "ns3/double.h"
+#include <algorithm>
 
 namespace ns3 {
 
     NS_OBJECT_ENSURE_REGISTERED(Placement);
     NS_OBJECT_ENSURE_REGISTERED(PlacementPolicy);
     NS_OBJECT_ENSURE_REGISTERED(CentralizedPlacementPolicy);
+    NS_OBJECT_ENSURE_REGISTERED(DistributedPlacementPolicy);
     NS_LOG_COMPONENT_DEFINE("Placement");
 
         /* ... */
@@ -49,6 +52,40 @@ namespace ns3 {
         static TypeId tid = TypeId("ns3::Placement")
                 .SetParent<Object> ()
                 .AddConstructor<Placement> ()
+                .AddAttribute ("PendingQueueCapacity",
+                               "The number of events waiting for a route to one destination.",
+                               UintegerValue (100),
+                               MakeUintegerAccessor (&Placement::pendingCapacity),
+                               MakeUintegerChecker<uint32_t> (1))
+                .AddAttribute ("PendingEventMaxAge",
+                               "How long an event may wait for a route before it is dropped.",
+                               TimeValue (Seconds (10.0)),
+                               MakeTimeAccessor (&Placement::pendingMaxAge),
+                               MakeTimeChecker ())
+                .AddAttribute ("PendingCheckInterval",
+                               "How often the events waiting for a route are checked.",
+                               TimeValue (Seconds (1.0)),
+                               MakeTimeAccessor (&Placement::pendingCheckInterval),
+                               MakeTimeChecker ())
+                .AddAttribute ("PendingFlushHoldTime",
+                               "The shortest time between two flushes of the events waiting for a route when the routes change.",
+                               TimeValue (MilliSeconds (100)),
+                               MakeTimeAccessor (&Placement::pendingFlushHold),
+                               MakeTimeChecker ())
+                .AddAttribute ("MigrationTimeout",
+                               "How long the previous host of a migrated operator waits for its acknowledgements before taking it back, the new host waits twice as long for its inputs before resuming it.",
+                               TimeValue (Seconds (5.0)),
+                               MakeTimeAccessor (&Placement::migrationTimeout),
+                               MakeTimeChecker ())
+                .AddTraceSource("PendingOverflowDrops",
+                "The number of events dropped because their pending queue was full",
+                MakeTraceSourceAccessor(&Placement::pendingOverflowDrops))
+                .AddTraceSource("PendingExpiredDrops",
+                "The number of events dropped because no route was found in time",
+                MakeTraceSourceAccessor(&Placement::pendingExpiredDrops))
+                .AddTraceSource("UnclaimedEventDrops",
+                "The number of events dropped because no local operator consumed them in time",
+                MakeTraceSourceAccessor(&Placement::unclaimedDrops))
                 .AddTraceSource("activate datasource",
                 "when an atomic query for this data source is received.",
                 MakeTraceSourceAccessor(&Placement::activateDatasource))
@@ -58,10 +95,25 @@ namespace ns3 {
                 .AddTraceSource("new event produced",
                 "A new event is produced by the local CEPEngine",
                 MakeTraceSourceAccessor(&Placement::m_newEventProduced))
+                .AddTraceSource("operator migrated",
+                "An operator moved from or to this node, with its new host",
+                MakeTraceSourceAccessor(&Placement::operatorMigrated))
                 
                 ;
         return tid;
     }
+    
+    Placement::Placement()
+    : pendingCapacity(100),
+      pendingMaxAge(Seconds(10.0)),
+      pendingCheckInterval(Seconds(1.0)),
+      pendingFlushHold(MilliSeconds(100)),
+      lastPendingFlush(Time::Min()),
+      pendingOverflowDrops(0),
+      pendingExpiredDrops(0),
+      migrationTimeout(Seconds(5.0)),
+      unclaimedDrops(0)
+    {}
 
     void
     Placement::configure() {
@@ -82,6 +134,11 @@ namespace ns3 {
                 p_policy = CreateObject<CentralizedPlacementPolicy>();
 
             }
+            else if (s1.Get() == "distributed")
+            {
+                NS_LOG_INFO("Distributed placement mechanism");
+                p_policy = CreateObject<DistributedPlacementPolicy>();
+            }
             else
             {
                 NS_ABORT_MSG ("UNKNOWN PLACEMENT POLICY");
@@ -91,14 +148,22 @@ namespace ns3 {
             p_policy->configure();
             
             
-            Ptr<ResourceManager> rm = CreateObject<ResourceManager>();
-            AggregateObject(rm);
-            rm->Configure();
+            /* unless one was given the routes it should read */
+            Ptr<ResourceManager> rm = GetObject<ResourceManager>();
+            if (rm == 0)
+            {
+                rm = CreateObject<ResourceManager>();
+                AggregateObject(rm);
+                rm->Configure();
+            }
+            rm->TraceConnectWithoutContext("RoutesChanged", 
+                    MakeCallback(&Placement::RoutesChanged, this));
     
             
             /* Aggregate dcep state object*/
             Ptr<DcepState> dstate = CreateObject<DcepState>();
             AggregateObject(dstate);
+            dstate->Configure();
             
         }
 
@@ -121,15 +186,83 @@ namespace ns3 {
         }
         else 
         {
-            if(GetObject<DcepState>()->IsExpected(e))
+            DeliverEvent(e);
+        }
+    }
+    
+    void
+    Placement::DeliverEvent(Ptr<Event> e)
+    {
+        Ptr<DcepState> dstate = GetObject<DcepState>();
+        Ipv4Address local = GetObject<Communication>()->GetLocalAddress();
+        bool delivered = false;
+        
+        std::vector<Ipv4Address> forwarded;
+        const std::vector<Ptr<EventRoutingTableEntry> >& consumers = dstate->GetConsumers(e->type);
+        for (uint32_t i = 0; i < consumers.size(); i++)
+        {
+            Ptr<EventRoutingTableEntry> consumer = consumers[i];
+            if ((consumer->state == FREEZED) || (consumer->state == RESUMING))
             {
-                SendEventToCepEngine(e);
+                consumer->freeze_queue.push_back(e);
+                delivered = true;
             }
-            else
+            else if ((consumer->state == DEACTIVATED) && !consumer->current_processor.IsAny()
+                    && !consumer->current_processor.IsEqual(local)
+                    && (std::find(forwarded.begin(), forwarded.end(), consumer->current_processor) == forwarded.end()))
             {
-                NS_ABORT_MSG("PLACEMENT: UNEXPECTED EVENT");
+                /* sent before the input stream was redirected */
+                NS_LOG_INFO ("PLACEMENT: FORWARDING EVENT TO MIGRATED OPERATOR");
+                forwarded.push_back(consumer->current_processor);
+                SendCepEvent(Create<Event>(e), consumer->current_processor);
+                delivered = true;
             }
         }
+        
+        if (dstate->IsExpected(e))
+        {
+            SendEventToCepEngine(e);
+            delivered = true;
+        }
+        
+        if (!delivered)
+        {
+            HoldUnclaimedEvent(e);
+        }
+    }
+    
+    void
+    Placement::HoldUnclaimedEvent(Ptr<Event> e)
+    {
+        NS_LOG_INFO ("PLACEMENT: HOLDING UNCLAIMED EVENT " << EventTypeTable::GetName(e->type));
+        PendingEvent held;
+        held.event = e;
+        held.queued = Simulator::Now();
+        unclaimed.push_back(held);
+        
+        if (!unclaimedCheck.IsRunning())
+        {
+            unclaimedCheck = Simulator::Schedule(migrationTimeout, &Placement::DropUnclaimedEvents, this);
+        }
+    }
+    
+    void
+    Placement::DropUnclaimedEvents()
+    {
+        Time now = Simulator::Now();
+        while (!unclaimed.empty() && ((now - unclaimed.front().queued) >= migrationTimeout))
+        {
+            NS_LOG_INFO ("PLACEMENT: DROPPING UNCLAIMED EVENT " 
+                    << EventTypeTable::GetName(unclaimed.front().event->type));
+            unclaimed.pop_front();
+            unclaimedDrops++;
+        }
+        
+        if (!unclaimed.empty())
+        {
+            unclaimedCheck = Simulator::Schedule(unclaimed.front().queued + migrationTimeout - now,
+                    &Placement::DropUnclaimedEvents, this);
+        }
     }
     
     
@@ -143,7 +276,16 @@ namespace ns3 {
         
         if (e->event_class == FINAL_EVENT)
         {
-            SendEventToSink (e);
+            Ptr<Communication> cm = GetObject<Communication>();
+            if (cm->GetLocalAddress().IsEqual(cm->GetSinkAddress()))
+            {
+                SendEventToSink (e);
+            }
+            else
+            {
+                /* the root operator is not placed on the sink */
+                SendCepEvent (e, cm->GetSinkAddress());
+            }
         }
         else
         {
@@ -151,7 +293,7 @@ namespace ns3 {
             {
                 if (dstate->IsActive(e->type))
                 {
-                    SendEventToCepEngine(e);
+                    DeliverEvent(e);
                 }
                 else
                 {
@@ -169,6 +311,13 @@ namespace ns3 {
                     NS_ABORT_MSG ("PLACEMENT MECHANISM: NO DESTINATION PROVIDED FOR CURRENT EVENT");
                 }
             }
+            
+            /* the other operators reading a shared atomic stream */
+            Ptr<Query> q = dstate->GetQuery(e->type);
+            if (q)
+            {
+                ForwardToOtherParents(e, q, dest);
+            }
         }
          
     }
@@ -180,6 +329,32 @@ namespace ns3 {
         GetObject<CEPEngine>()->ProcessCepEvent(e);
     }
     
+    void
+    Placement::ForwardToOtherParents(Ptr<Event> e, Ptr<Query> q, Ipv4Address dest)
+    {
+        Ipv4Address local = GetObject<Communication>()->GetLocalAddress();
+        std::vector<Ipv4Address> sent(1, dest);
+        for (uint32_t i = 0; i < q->other_output_dests.size(); i++)
+        {
+            Ipv4Address other = q->other_output_dests[i];
+            if (other.IsAny() || (std::find(sent.begin(), sent.end(), other) != sent.end()))
+            {
+                continue;
+            }
+            sent.push_back(other);
+            
+            /* each host gets its own copy, a local one reaches every local reader */
+            if (other.IsEqual(local))
+            {
+                DeliverEvent(e);
+            }
+            else
+            {
+                SendCepEvent(Create<Event>(e), other);
+            }
+        }
+    }
+    
     void
     Placement::SendEventToSink(Ptr<Event> e)
     {
@@ -190,32 +365,131 @@ namespace ns3 {
     void
     Placement::SendCepEvent(Ptr<Event> e, Ipv4Address dest)
     {
-        olsr::RoutingTableEntry entry;
+        RouteInfo route;
+        std::unordered_map<uint32_t, std::deque<PendingEvent> >::const_iterator it 
+                = pending.find(dest.Get());
         
-        entry.destAddr = dest;
-        GetObject<ResourceManager>()->getRoute(entry);
-        if(entry.distance > 0)
+        /* events already waiting for dest go first */
+        if ((it == pending.end() || it->second.empty()) 
+                && GetObject<ResourceManager>()->getRoute(dest, route))
         {
-            //set here and when nely produced
-            e->hopsCount = entry.distance + e->hopsCount;
-            
-            SerializedEvent *message = e->serialize();
-            uint8_t *buffer = new uint8_t[message->size];
-            memcpy(buffer, message, message->size);
-            DcepHeader dcepHeader;
-            dcepHeader.SetContentType(EVENT);
-            dcepHeader.setContentSize(message->size);
+            TransmitCepEvent(e, dest, route.distance);
+        }
+        else
+        {
+            QueuePendingEvent(e, dest);
+        }
+    }
+    
+    void
+    Placement::TransmitCepEvent(Ptr<Event> e, Ipv4Address dest, uint32_t distance)
+    {
+        //set here and when nely produced
+        if (distance != RouteInfo::UNKNOWN_DISTANCE)
+        {
+            e->hopsCount = distance + e->hopsCount;
+        }
+        
+        SerializedEvent message = e->serialize();
+        DcepHeader dcepHeader;
+        dcepHeader.SetContentType(EVENT);
+        dcepHeader.SetTrafficClass(Communication::GetEventTrafficClass(e->event_class));
+        dcepHeader.setContentSize(message.GetSerializedSize());
 
-            Ptr<Packet> p = Create<Packet> (buffer, message->size);
+        Ptr<Packet> p = Create<Packet> ();
 
-            p->AddHeader (dcepHeader);
+        p->AddHeader (message);
+        p->AddHeader (dcepHeader);
+        
+        GetObject<Dcep>()->SendPacket(p, dest);
+    }
+    
+    void
+    Placement::QueuePendingEvent(Ptr<Event> e, Ipv4Address dest)
+    {
+        std::deque<PendingEvent> &queue = pending[dest.Get()];
+        if (queue.size() >= pendingCapacity)
+        {
+            NS_LOG_INFO("NO ROUTE TO " << dest << ", DROPPING THE OLDEST PENDING EVENT");
+            queue.pop_front();
+            pendingOverflowDrops++;
+        }
+        
+        PendingEvent pe;
+        pe.event = e;
+        pe.queued = Simulator::Now();
+        queue.push_back(pe);
+        
+        if (!pendingCheck.IsRunning())
+        {
+            pendingCheck = Simulator::Schedule(pendingCheckInterval, &Placement::FlushPending, this);
+        }
+    }
+    
+    void
+    Placement::RoutesChanged(void)
+    {
+        /* 
+         * olsr changes its routes in bursts, every lookup after a change
+         * copies its table again
+         */
+        if (pending.empty() || pendingFlush.IsRunning())
+        {
+            return;
+        }
+        
+        Time next = lastPendingFlush + pendingFlushHold;
+        pendingFlush = Simulator::Schedule(std::max(next - Simulator::Now(), Seconds(0)), 
+                &Placement::FlushPending, this);
+    }
+    
+    void
+    Placement::FlushPending(void)
+    {
+        if (pending.empty())
+        {
+            return;
+        }
+        
+        lastPendingFlush = Simulator::Now();
+        Ptr<ResourceManager> rm = GetObject<ResourceManager>();
+        std::unordered_map<uint32_t, std::deque<PendingEvent> >::iterator it = pending.begin();
+        while (it != pending.end())
+        {
+            Ipv4Address dest(it->first);
+            std::deque<PendingEvent> &queue = it->second;
+            RouteInfo route;
+            
+            if (rm->getRoute(dest, route))
+            {
+                while (!queue.empty())
+                {
+                    TransmitCepEvent(queue.front().event, dest, route.distance);
+                    queue.pop_front();
+                }
+            }
+            else
+            {
+                while (!queue.empty() && Simulator::Now() - queue.front().queued >= pendingMaxAge)
+                {
+                    queue.pop_front();
+                    pendingExpiredDrops++;
+                }
+            }
             
-            GetObject<Dcep>()->SendPacket(p, dest);
+            if (queue.empty())
+            {
+                it = pending.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
         }
-        else
+        
+        if (!pending.empty() && !pendingCheck.IsRunning())
         {
-           eventsList.push_back(e);
-            Simulator::Schedule(MilliSeconds(100.0), &Placement::SendCepEvent, this, e, dest);
+            pendingCheck = Simulator::Schedule(pendingCheckInterval, &Placement::FlushPending, this);
         }
     }
     
@@ -230,48 +504,35 @@ namespace ns3 {
     Placement::RecvQuery(Ptr<Query> q) 
     {
         q_queue.push_back(q);
-        Simulator::Schedule(Seconds(0.0), &PlacementPolicy::DoPlacement, GetObject<PlacementPolicy>());
-    }
-    
-    
-    uint32_t 
-    Placement::RemoveQuery(Ptr<Query> q) 
-    {
-        std::vector<Ptr<Query> >::iterator it;
-        for (it = q_queue.begin(); it != q_queue.end(); it++)
-        {
-            Ptr<Query> qry = *it;
-            if (qry->id == q->id)
-            {
-                q_queue.erase(it);
-                break;
-            }
-                
-        }
-        return q_queue.size();
+        GetObject<PlacementPolicy>()->SchedulePlacement();
     }
 
 
     void 
-    Placement::ForwardRemoteQuery(std::string eType)
+    Placement::ForwardRemoteQuery(EventTypeId eType)
     {
         NS_LOG_INFO ("PLACEMENT: SENDING QUERY TO REMOTE NODE");
         
         Ptr<DcepState> dstate = GetObject<DcepState>();
-        SerializedQuery *message= dstate->GetQuery(eType)->serialize();
-        NS_LOG_INFO ("QUERY BEING SENT " << message->eventType);
-        uint8_t *buffer = new uint8_t[message->size];
-        memcpy(buffer, message, message->size);
+        SendRemoteQuery(dstate->GetQuery(eType), dstate->GetNextHop(eType));
+    }
+    
+    void 
+    Placement::SendRemoteQuery(Ptr<Query> q, Ipv4Address dest)
+    {
+        SerializedQuery message = q->serialize();
+        NS_LOG_INFO ("QUERY BEING SENT " << EventTypeTable::GetName(message.eventType));
 
         uint16_t msgType = QUERY;
         DcepHeader dcepHeader;
         dcepHeader.SetContentType(msgType);
-        dcepHeader.setContentSize(message->size);
+        dcepHeader.setContentSize(message.GetSerializedSize());
 
-        Ptr<Packet> p = Create<Packet> (buffer, message->size);
+        Ptr<Packet> p = Create<Packet> ();
         
+        p->AddHeader (message);
         p->AddHeader (dcepHeader);
-        GetObject<Dcep>()->SendPacket(p, dstate->GetNextHop(eType));
+        GetObject<Dcep>()->SendPacket(p, dest);
 
     }
     
@@ -281,7 +542,7 @@ namespace ns3 {
         GetObject<CEPEngine>()->RecvQuery(q);
     }
 
-    void Placement::ForwardQuery(std::string eType) 
+    void Placement::ForwardQuery(EventTypeId eType) 
     {
 
         NS_LOG_INFO("Forwarding partial query to its destination");
@@ -311,129 +572,642 @@ namespace ns3 {
  
     }
     
-    /*
-     * ********************** PLACEMENT POLICIES ***********************
-     * *****************************************************************
-     * *****************************************************************
-     */
-
-
-    TypeId PlacementPolicy::GetTypeId(void) {
-        static TypeId tid = TypeId("ns3::PlacementPolicy")
-        .SetParent<Object>()
-        .AddTraceSource("New host found",
-                "A new host has been found",
-                MakeTraceSourceAccessor(&PlacementPolicy::newHostFound))
-        .AddTraceSource("new local placement",
-                "a query placed on a remote node.",
-                MakeTraceSourceAccessor(&PlacementPolicy::newLocalPlacement))
-        ;
-        return tid;
+    void
+    Placement::RecvAdvertisement(const SerializedAdvertisement &message)
+    {
+        Ptr<DcepState> dstate = GetObject<DcepState>();
+        Time lifetime = MilliSeconds(message.lifetime);
+        bool discovered = false;
+        
+        for (uint32_t i = 0; i < message.types.size(); i++)
+        {
+            if (dstate->AddProducer(message.types[i], message.origin, message.rates[i], lifetime))
+            {
+                discovered = true;
+            }
+        }
+        
+        if (discovered && !q_queue.empty())
+        {
+            GetObject<PlacementPolicy>()->SchedulePlacement();
+        }
     }
-
-    TypeId CentralizedPlacementPolicy::GetTypeId(void) {
-        static TypeId tid = TypeId("ns3::CentralizedPlacementPolicy")
-                .SetParent<PlacementPolicy> ()
-                .AddConstructor<CentralizedPlacementPolicy> ()
-
-                ;
-        return tid;
+    
+    /*************************************************
+     * *********************** OPERATOR MIGRATION *********************************
+     * ****************************************************************************
+     */
+    
+    bool
+    Placement::MigrateOperator(EventTypeId eType, Ipv4Address host)
+    {
+        Ptr<DcepState> dstate = GetObject<DcepState>();
+        Ptr<EventRoutingTableEntry> entry = dstate->GetEntry(eType);
+        Ipv4Address local = GetObject<Communication>()->GetLocalAddress();
+        
+        if (!entry || (entry->state != ACTIVE) || entry->source_query->isAtomic 
+                || host.IsAny() || host.IsEqual(local))
+        {
+            return false;
+        }
+        
+        Ptr<Query> q = entry->source_query;
+        std::vector<EventTypeId> streams;
+        std::vector<Ipv4Address> sources;
+        if (q->inevent1 != NO_EVENT_TYPE)
+        {
+            streams.push_back(q->inevent1);
+            sources.push_back(q->inputStream1_address);
+        }
+        if ((q->inevent2 != NO_EVENT_TYPE) && (q->inevent2 != q->inevent1))
+        {
+            streams.push_back(q->inevent2);
+            sources.push_back(q->inputStream2_address);
+        }
+        if (!q->inevents.empty() 
+                || (std::find(sources.begin(), sources.end(), Ipv4Address::GetAny()) != sources.end()))
+        {
+            /* the input streams cannot be redirected */
+            return false;
+        }
+        
+        NS_LOG_INFO ("PLACEMENT: MIGRATING " << EventTypeTable::GetName(eType) << " TO " << host);
+        dstate->SetState(eType, FREEZED);
+        dstate->SetCurrentProcessor(eType, host);
+        dstate->SetNextHop(eType, host);
+        /* one per input stream, and one from host */
+        entry->freezeAck_counter = streams.size() + 1;
+        
+        std::vector<Ptr<Event> > state;
+        GetObject<CEPEngine>()->RemoveQuery(q, state);
+        /* inputs still waiting for the CPU are handed over with the frozen ones */
+        GetObject<CEPEngine>()->TakeOrphanedEvents(streams, entry->freeze_queue);
+        
+        Migration &migration = migrations[eType];
+        migration.state = state;
+        migration.streams = streams;
+        migration.sources = sources;
+        migration.timeout = Simulator::Schedule(migrationTimeout, &Placement::ExpireMigration, this, eType);
+        
+        SerializedMigration message;
+        message.eventType = eType;
+        message.host = host;
+        message.origin = local;
+        message.output_dest = q->output_dest;
+        SendMigrationMessage(MIGRATION, message, q, state, host);
+        
+        std::vector<Ptr<Event> > none;
+        for (uint32_t i = 0; i < streams.size(); i++)
+        {
+            message.stream = streams[i];
+            SendMigrationMessage(REDIRECT, message, 0, none, sources[i]);
+        }
+        return true;
     }
-
+    
     void
-    CentralizedPlacementPolicy::configure() {
+    Placement::SendMigrationMessage(uint16_t type, const SerializedMigration &message,
+            Ptr<Query> q, const std::vector<Ptr<Event> > &events, Ipv4Address dest)
+    {
+        SerializedMigration header = message;
+        header.event_count = events.size();
+        header.arrivals.resize(events.size());
+        for (uint32_t i = 0; i < events.size(); i++)
+        {
+            header.arrivals[i] = events[i]->arrival;
+        }
+        
+        if (dest.IsEqual(GetObject<Communication>()->GetLocalAddress()))
+        {
+            Simulator::ScheduleNow(&Placement::RecvMigrationMessage, this, type, header, q, events);
+            return;
+        }
         
+        Ptr<Packet> p = Create<Packet> ();
+        uint32_t size = header.GetSerializedSize();
+        for (uint32_t i = events.size(); i > 0; i--)
+        {
+            SerializedEvent event = events[i-1]->serialize();
+            size += event.GetSerializedSize();
+            p->AddHeader (event);
+        }
+        if (q)
+        {
+            SerializedQuery query = q->serialize();
+            size += query.GetSerializedSize();
+            p->AddHeader (query);
+        }
+        p->AddHeader (header);
+        
+        DcepHeader dcepHeader;
+        dcepHeader.SetContentType(type);
+        dcepHeader.setContentSize(size);
+        p->AddHeader (dcepHeader);
+        GetObject<Dcep>()->SendPacket(p, dest);
     }
-
+    
     void
-    CentralizedPlacementPolicy::DoPlacement() 
+    Placement::RecvMigrationMessage(uint16_t type, const SerializedMigration &message, 
+            Ptr<Query> q, const std::vector<Ptr<Event> > &events)
     {
-        NS_LOG_INFO ("Doing centralized placement");
-        Ptr<Placement> p = GetObject<Placement>();
-
-        std::vector<Ptr < Query>>::iterator it;
-        std::vector<Ptr < Query>> qs = p->q_queue;
-
-        for (it = qs.begin(); it != qs.end(); ++it) {
-
-            Ptr<Query> q = *it;
-            if (!PlaceQuery(q)) 
-            {
-                Simulator::Schedule(Seconds(3.0), &CentralizedPlacementPolicy::DoPlacement, this);
-            } else
-                p->RemoveQuery(q);
+        switch (type)
+        {
+            case MIGRATION:
+                RecvOperatorState(message, q, events);
+                break;
+            case RESUME:
+                ResumeOperator(message, events);
+                break;
+            case REDIRECT:
+                RedirectStream(message);
+                break;
+            case REDIRECT_ACK:
+                RecvRedirectAck(message);
+                break;
+            case STREAM_MOVED:
+                RecvStreamMoved(message);
+                break;
+            case MIGRATION_ABORT:
+                AbortMigration(message);
+                break;
+            default:
+                NS_ABORT_MSG ("UNKNOWN MIGRATION MESSAGE");
         }
-
     }
-
-    bool
-    CentralizedPlacementPolicy::doAdaptation(std::string eType) 
+    
+    void
+    Placement::RecvOperatorState(const SerializedMigration &message, Ptr<Query> q, 
+            const std::vector<Ptr<Event> > &events)
     {
-        return false;
-    }
-
-    bool
-    CentralizedPlacementPolicy::PlaceQuery(Ptr<Query> q) {
-        
-        Ptr<Placement> p = GetObject<Placement>();
+        NS_LOG_INFO ("PLACEMENT: RECEIVED OPERATOR " << EventTypeTable::GetName(message.eventType)
+                << " FROM " << message.origin);
         Ptr<DcepState> dstate = GetObject<DcepState>();
-        dstate->CreateEventRoutingTableEntry(q);
-        Ptr<Communication> cm = GetObject<Communication>();
-        bool placed = false;
-
-        if (!q->isAtomic) 
+        Ipv4Address local = GetObject<Communication>()->GetLocalAddress();
+        
+        Ptr<EventRoutingTableEntry> entry = dstate->GetEntry(q->eventType);
+        if (entry && ((entry->state == ACTIVE) || (entry->state == RESUMING)))
         {
-            dstate->SetNextHop(q->eventType, cm->GetLocalAddress());
-            placed = true;
+            NS_LOG_INFO ("PLACEMENT: OPERATOR " << EventTypeTable::GetName(q->eventType) << " IS ALREADY HERE");
+            return;
         }
-        else if (q->isAtomic) 
+        
+        dstate->CreateEventRoutingTableEntry(q);
+        dstate->SetCurrentProcessor(q->eventType, local);
+        dstate->SetNextHop(q->eventType, local);
+        dstate->SetOutDest(q->eventType, message.output_dest);
+        dstate->SetState(q->eventType, RESUMING);
+        entry = dstate->GetEntry(q->eventType);
+        
+        /* inputs redirected here before the operator arrived */
+        std::vector<EventTypeId> inputs;
+        DcepState::GetInputs(q, inputs);
+        std::deque<PendingEvent> others;
+        for (uint32_t i = 0; i < unclaimed.size(); i++)
         {
-            olsr::RoutingTableEntry entry;
-
-            if(q->eventType == "A")
+            if (std::find(inputs.begin(), inputs.end(), unclaimed[i].event->type) != inputs.end())
             {
-                dstate->SetNextHop(q->eventType, Ipv4Address("10.0.0.2"));
-                placed = true;
-                
+                entry->freeze_queue.push_back(unclaimed[i].event);
             }
-            else if(q->eventType == "B")
+            else
             {
-                dstate->SetNextHop(q->eventType, Ipv4Address("10.0.0.3"));
-                placed = true;
-                
+                others.push_back(unclaimed[i]);
             }
-            else if (q->eventType == "C") 
-            {
-                dstate->SetNextHop(q->eventType, Ipv4Address("10.0.0.4"));
-                placed = true;
-                
-            } else if (q->eventType == "D") 
+        }
+        unclaimed.swap(others);
+        
+        Migration &migration = migrations[q->eventType];
+        migration.state = events;
+        migration.origin = message.origin;
+        migration.output_dest = message.output_dest;
+        migration.timeout = Simulator::Schedule(migrationTimeout + migrationTimeout, 
+                &Placement::ExpireMigration, this, q->eventType);
+        
+        std::vector<Ptr<Event> > none;
+        SendMigrationMessage(REDIRECT_ACK, message, 0, none, message.origin);
+    }
+    
+    void
+    Placement::RedirectStream(const SerializedMigration &message)
+    {
+        Ptr<DcepState> dstate = GetObject<DcepState>();
+        Ptr<EventRoutingTableEntry> entry = dstate->GetEntry(message.stream);
+        Ipv4Address local = GetObject<Communication>()->GetLocalAddress();
+        
+        if (entry && ((entry->state == ACTIVE) || (entry->state == FREEZED) 
+                || (entry->state == RESUMING) || (entry->state == RETRANSMITING)))
+        {
+            NS_LOG_INFO ("PLACEMENT: REDIRECTING " << EventTypeTable::GetName(message.stream) 
+                    << " TO " << message.host);
+            /* only the part of a shared stream read by the moved operator */
+            Ptr<Query> q = entry->source_query;
+            std::vector<EventTypeId>::const_iterator other = std::find(q->other_parent_outputs.begin(),
+                    q->other_parent_outputs.end(), message.eventType);
+            uint32_t index = other - q->other_parent_outputs.begin();
+            if (index < q->other_output_dests.size())
             {
-                dstate->SetNextHop(q->eventType, Ipv4Address("10.0.0.5"));
-                placed = true;
-                
+                q->other_output_dests[index] = message.host;
             }
-            else if (q->eventType == "E") 
+            else
             {
-                dstate->SetNextHop(q->eventType, Ipv4Address("10.0.0.6"));
-                placed = true;
+                dstate->SetOutDest(message.stream, message.host);
             }
-            else if (q->eventType == "F") 
+        }
+        else if (entry && !entry->current_processor.IsAny() && !entry->current_processor.IsEqual(local))
+        {
+            /* the stream is produced elsewhere now */
+            std::vector<Ptr<Event> > none;
+            SendMigrationMessage(REDIRECT, message, 0, none, entry->current_processor);
+            return;
+        }
+        else
+        {
+            NS_LOG_INFO ("PLACEMENT: NO PRODUCER FOR " << EventTypeTable::GetName(message.stream));
+        }
+        
+        std::vector<Ptr<Event> > none;
+        SendMigrationMessage(REDIRECT_ACK, message, 0, none, message.origin);
+    }
+    
+    void
+    Placement::RecvRedirectAck(const SerializedMigration &message)
+    {
+        Ptr<EventRoutingTableEntry> entry = GetObject<DcepState>()->GetEntry(message.eventType);
+        if (!entry || (entry->state != FREEZED) || (entry->freezeAck_counter == 0))
+        {
+            return;
+        }
+        
+        entry->freezeAck_counter--;
+        if (entry->freezeAck_counter == 0)
+        {
+            FinishMigration(message.eventType);
+        }
+    }
+    
+    void
+    Placement::FinishMigration(EventTypeId eType)
+    {
+        Ptr<DcepState> dstate = GetObject<DcepState>();
+        Ptr<EventRoutingTableEntry> entry = dstate->GetEntry(eType);
+        Ipv4Address host = entry->current_processor;
+        
+        Simulator::Cancel(migrations[eType].timeout);
+        migrations.erase(eType);
+        dstate->SetState(eType, RETRANSMITING);
+        NS_LOG_INFO ("PLACEMENT: SENDING " << entry->freeze_queue.size() << " HELD EVENTS OF " 
+                << EventTypeTable::GetName(eType) << " TO " << host);
+        
+        SerializedMigration message;
+        message.eventType = eType;
+        message.host = host;
+        message.origin = GetObject<Communication>()->GetLocalAddress();
+        message.output_dest = entry->source_query->output_dest;
+        SendMigrationMessage(RESUME, message, 0, entry->freeze_queue, host);
+        entry->freeze_queue.clear();
+        
+        dstate->SetState(eType, DEACTIVATED);
+        operatorMigrated(eType, host);
+    }
+    
+    void
+    Placement::ResumeOperator(const SerializedMigration &message, const std::vector<Ptr<Event> > &events)
+    {
+        Ptr<DcepState> dstate = GetObject<DcepState>();
+        Ptr<EventRoutingTableEntry> entry = dstate->GetEntry(message.eventType);
+        Ptr<Communication> cm = GetObject<Communication>();
+        
+        if (!entry || (entry->state != RESUMING))
+        {
+            /* resumed on timeout already, or a duplicate */
+            NS_LOG_INFO ("PLACEMENT: IGNORING RESUME OF " << EventTypeTable::GetName(message.eventType));
+            return;
+        }
+        
+        NS_LOG_INFO ("PLACEMENT: RESUMING " << EventTypeTable::GetName(message.eventType));
+        Ptr<Query> q = entry->source_query;
+        dstate->SetOutDest(message.eventType, message.output_dest);
+        Ptr<CEPEngine> cep = GetObject<CEPEngine>();
+        cep->RecvQuery(q);
+        cep->RestoreState(q, migrations[message.eventType].state);
+        Simulator::Cancel(migrations[message.eventType].timeout);
+        migrations.erase(message.eventType);
+        dstate->SetState(message.eventType, ACTIVE);
+        
+        /* the inputs held by the previous host came first */
+        std::vector<Ptr<Event> > held;
+        held.swap(entry->freeze_queue);
+        for (uint32_t i = 0; i < events.size(); i++)
+        {
+            DeliverEvent(events[i]);
+        }
+        for (uint32_t i = 0; i < held.size(); i++)
+        {
+            DeliverEvent(held[i]);
+        }
+        
+        SerializedMigration moved;
+        moved.eventType = message.eventType;
+        moved.host = cm->GetLocalAddress();
+        moved.origin = message.origin;
+        std::vector<Ptr<Event> > none;
+        SendMigrationMessage(STREAM_MOVED, moved, 0, none, message.output_dest);
+        if (!message.output_dest.IsEqual(cm->GetSinkAddress()))
+        {
+            SendMigrationMessage(STREAM_MOVED, moved, 0, none, cm->GetSinkAddress());
+        }
+        operatorMigrated(message.eventType, cm->GetLocalAddress());
+    }
+    
+    void
+    Placement::ExpireMigration(EventTypeId eType)
+    {
+        Ptr<EventRoutingTableEntry> entry = GetObject<DcepState>()->GetEntry(eType);
+        if (entry && (entry->state == FREEZED))
+        {
+            RollBackMigration(eType);
+        }
+        else if (entry && (entry->state == RESUMING))
+        {
+            NS_LOG_INFO ("PLACEMENT: " << EventTypeTable::GetName(eType) 
+                    << " RESUMES WITHOUT THE INPUTS HELD BY " << migrations[eType].origin);
+            SerializedMigration message;
+            message.eventType = eType;
+            message.host = GetObject<Communication>()->GetLocalAddress();
+            message.origin = migrations[eType].origin;
+            message.output_dest = migrations[eType].output_dest;
+            std::vector<Ptr<Event> > none;
+            ResumeOperator(message, none);
+        }
+    }
+    
+    void
+    Placement::RollBackMigration(EventTypeId eType)
+    {
+        Ptr<DcepState> dstate = GetObject<DcepState>();
+        Ptr<EventRoutingTableEntry> entry = dstate->GetEntry(eType);
+        Ipv4Address local = GetObject<Communication>()->GetLocalAddress();
+        Ipv4Address host = entry->current_processor;
+        Migration migration = migrations[eType];
+        migrations.erase(eType);
+        
+        NS_LOG_INFO ("PLACEMENT: MIGRATION OF " << EventTypeTable::GetName(eType) << " TO " << host
+                << " TIMED OUT, TAKING IT BACK");
+        Ptr<Query> q = entry->source_query;
+        Ptr<CEPEngine> cep = GetObject<CEPEngine>();
+        cep->RecvQuery(q);
+        cep->RestoreState(q, migration.state);
+        dstate->SetCurrentProcessor(eType, local);
+        dstate->SetNextHop(eType, local);
+        dstate->SetState(eType, ACTIVE);
+        entry->freezeAck_counter = 0;
+        
+        SerializedMigration message;
+        message.eventType = eType;
+        message.host = local;
+        message.origin = local;
+        message.output_dest = q->output_dest;
+        std::vector<Ptr<Event> > none;
+        SendMigrationMessage(MIGRATION_ABORT, message, 0, none, host);
+        for (uint32_t i = 0; i < migration.streams.size(); i++)
+        {
+            message.stream = migration.streams[i];
+            SendMigrationMessage(REDIRECT, message, 0, none, migration.sources[i]);
+        }
+        
+        std::vector<Ptr<Event> > held;
+        held.swap(entry->freeze_queue);
+        for (uint32_t i = 0; i < held.size(); i++)
+        {
+            DeliverEvent(held[i]);
+        }
+    }
+    
+    void
+    Placement::AbortMigration(const SerializedMigration &message)
+    {
+        Ptr<DcepState> dstate = GetObject<DcepState>();
+        Ptr<EventRoutingTableEntry> entry = dstate->GetEntry(message.eventType);
+        if (!entry || (entry->state != RESUMING))
+        {
+            return;
+        }
+        
+        NS_LOG_INFO ("PLACEMENT: MIGRATION OF " << EventTypeTable::GetName(message.eventType) 
+                << " ABORTED, " << message.origin << " KEEPS IT");
+        Simulator::Cancel(migrations[message.eventType].timeout);
+        migrations.erase(message.eventType);
+        dstate->SetState(message.eventType, DEACTIVATED);
+        dstate->SetCurrentProcessor(message.eventType, message.origin);
+        dstate->SetNextHop(message.eventType, message.origin);
+        
+        /* the other local consumers had these already */
+        std::vector<Ptr<Event> > held;
+        held.swap(entry->freeze_queue);
+        for (uint32_t i = 0; i < held.size(); i++)
+        {
+            SendCepEvent(Create<Event>(held[i]), message.origin);
+        }
+    }
+    
+    void
+    Placement::RecvStreamMoved(const SerializedMigration &message)
+    {
+        Ptr<DcepState> dstate = GetObject<DcepState>();
+        Ipv4Address local = GetObject<Communication>()->GetLocalAddress();
+        
+        Ptr<EventRoutingTableEntry> entry = dstate->GetEntry(message.eventType);
+        if (entry && ((entry->state == UNDEFINED) || (entry->state == DEACTIVATED)))
+        {
+            dstate->SetCurrentProcessor(message.eventType, message.host);
+            dstate->SetNextHop(message.eventType, message.host);
+        }
+        
+        std::vector<Ipv4Address> forwarded;
+        const std::vector<Ptr<EventRoutingTableEntry> >& consumers = dstate->GetConsumers(message.eventType);
+        for (uint32_t i = 0; i < consumers.size(); i++)
+        {
+            Ptr<Query> q = consumers[i]->source_query;
+            if (q->inevent1 == message.eventType)
             {
-                dstate->SetNextHop(q->eventType, Ipv4Address("10.0.0.7"));
-                placed = true;
+                q->inputStream1_address = message.host;
             }
-            else if (q->eventType == "G") 
+            if (q->inevent2 == message.eventType)
             {
-                dstate->SetNextHop(q->eventType, Ipv4Address("10.0.0.8"));
-                placed = true;
+                q->inputStream2_address = message.host;
             }
-            else if (q->eventType == "H") 
+            
+            Ipv4Address host = consumers[i]->current_processor;
+            if ((consumers[i]->state == DEACTIVATED) && !host.IsAny() && !host.IsEqual(local)
+                    && (std::find(forwarded.begin(), forwarded.end(), host) == forwarded.end()))
             {
-                dstate->SetNextHop(q->eventType, Ipv4Address("10.0.0.9"));
-                placed = true;
+                forwarded.push_back(host);
+                std::vector<Ptr<Event> > none;
+                SendMigrationMessage(STREAM_MOVED, message, 0, none, host);
+            }
+        }
+    }
+    
+    /*
+     * ********************** PLACEMENT POLICIES ***********************
+     * *****************************************************************
+     * *****************************************************************
+     */
+
+
+    TypeId PlacementPolicy::GetTypeId(void) {
+        static TypeId tid = TypeId("ns3::PlacementPolicy")
+        .SetParent<Object>()
+        .AddAttribute ("RetryDelay",
+                       "The delay before queries which could not be placed are tried again.",
+                       TimeValue (Seconds (3.0)),
+                       MakeTimeAccessor (&PlacementPolicy::initialRetryDelay),
+                       MakeTimeChecker ())
+        .AddAttribute ("MaxRetryDelay",
+                       "The retry delay doubles after every pass placing no query, up to this value.",
+                       TimeValue (Seconds (48.0)),
+                       MakeTimeAccessor (&PlacementPolicy::maxRetryDelay),
+                       MakeTimeChecker ())
+        .AddTraceSource("New host found",
+                "A new host has been found",
+                MakeTraceSourceAccessor(&PlacementPolicy::newHostFound))
+        .AddTraceSource("new local placement",
+                "a query placed on a remote node.",
+                MakeTraceSourceAccessor(&PlacementPolicy::newLocalPlacement))
+        ;
+        return tid;
+    }
+
+    PlacementPolicy::PlacementPolicy()
+    : initialRetryDelay(Seconds(3.0)),
+      maxRetryDelay(Seconds(48.0))
+    {
+        retryDelay = initialRetryDelay;
+    }
+    
+    void
+    PlacementPolicy::SchedulePlacement()
+    {
+        if (!passEvent.IsRunning())
+        {
+            passEvent = Simulator::ScheduleNow(&PlacementPolicy::DoPlacement, this);
+        }
+    }
+    
+    void
+    PlacementPolicy::PlacePending()
+    {
+        Ptr<Placement> p = GetObject<Placement>();
+        
+        /* queries received while placing are appended to the emptied queue */
+        std::vector<Ptr<Query> > batch;
+        batch.swap(p->q_queue);
+        
+        bool progress = false;
+        for (uint32_t i = 0; i < batch.size(); i++)
+        {
+            if (PlaceQuery(batch[i]))
+            {
+                progress = true;
+            }
+            else
+            {
+                p->q_queue.push_back(batch[i]);
             }
+        }
+        
+        if (p->q_queue.empty())
+        {
+            Simulator::Cancel(retryEvent);
+            retryDelay = initialRetryDelay;
+            return;
+        }
+        
+        if (progress)
+        {
+            retryDelay = initialRetryDelay;
+        }
+        if (!retryEvent.IsRunning())
+        {
+            NS_LOG_INFO ("PLACEMENT: " << p->q_queue.size() << " QUERIES PENDING, RETRYING IN " 
+                    << retryDelay.GetSeconds() << "s");
+            retryEvent = Simulator::Schedule(retryDelay, &PlacementPolicy::DoPlacement, this);
+            retryDelay = std::min(retryDelay * 2, maxRetryDelay);
+        }
+    }
+    
+    void
+    PlacementPolicy::GetProducers(EventTypeId eType, std::vector<Ipv4Address> &producers)
+    {
+        Ptr<DataSource> datasource = GetObject<DataSource>();
+        if (datasource && datasource->Produces(eType))
+        {
+            /* a datasource places its own atomic query without advertising to itself */
+            producers.clear();
+            producers.push_back(GetObject<Communication>()->GetLocalAddress());
+            return;
+        }
+        GetObject<DcepState>()->GetProducers(eType, producers);
+    }
+    
+    Ipv4Address
+    PlacementPolicy::GetProducer(EventTypeId eType)
+    {
+        std::vector<Ipv4Address> producers;
+        GetProducers(eType, producers);
+        return producers.empty() ? Ipv4Address::GetAny() : producers[0];
+    }
+
+    TypeId CentralizedPlacementPolicy::GetTypeId(void) {
+        static TypeId tid = TypeId("ns3::CentralizedPlacementPolicy")
+                .SetParent<PlacementPolicy> ()
+                .AddConstructor<CentralizedPlacementPolicy> ()
+
+                ;
+        return tid;
+    }
+
+    void
+    CentralizedPlacementPolicy::configure() {
+        
+    }
+
+    void
+    CentralizedPlacementPolicy::DoPlacement() 
+    {
+        NS_LOG_INFO ("Doing centralized placement");
+        PlacePending();
+    }
+
+    bool
+    CentralizedPlacementPolicy::doAdaptation(EventTypeId eType) 
+    {
+        return false;
+    }
+
+    bool
+    CentralizedPlacementPolicy::PlaceQuery(Ptr<Query> q) {
+        
+        Ptr<Placement> p = GetObject<Placement>();
+        Ptr<DcepState> dstate = GetObject<DcepState>();
+        dstate->CreateEventRoutingTableEntry(q);
+        Ptr<Communication> cm = GetObject<Communication>();
+        bool placed = false;
 
+        if (!q->isAtomic) 
+        {
+            dstate->SetNextHop(q->eventType, cm->GetLocalAddress());
+            placed = true;
+        }
+        else if (q->isAtomic) 
+        {
+            std::vector<Ipv4Address> producers;
+            GetProducers(q->eventType, producers);
+            if (!producers.empty())
+            {
+                dstate->SetNextHop(q->eventType, producers[0]);
+                dstate->GetEntry(q->eventType)->dataSources = producers;
+                placed = true;
+            }
         }
 
         if (placed) 
@@ -450,12 +1224,507 @@ namespace ns3 {
             }
             
             p->ForwardQuery(q->eventType);
+            
+            /* every producer of the type sends its events to the sink */
+            const std::vector<Ipv4Address> &producers = dstate->GetEntry(q->eventType)->dataSources;
+            for (uint32_t i = 1; i < producers.size(); i++)
+            {
+                p->SendRemoteQuery(q, producers[i]);
+            }
         }
 
         return placed;
     }
     
-
     
+    TypeId DistributedPlacementPolicy::GetTypeId(void) {
+        static TypeId tid = TypeId("ns3::DistributedPlacementPolicy")
+                .SetParent<PlacementPolicy> ()
+                .AddConstructor<DistributedPlacementPolicy> ()
+                .AddAttribute ("DefaultEventRate",
+                               "The rate assumed for atomic event types which have been neither observed nor advertised yet, per second.",
+                               DoubleValue (10.0),
+                               MakeDoubleAccessor (&DistributedPlacementPolicy::defaultRate),
+                               MakeDoubleChecker<double> (0.0))
+                .AddAttribute ("MaxPlacementSteps",
+                               "The number of hops after which a query is placed wherever it is.",
+                               UintegerValue (16),
+                               MakeUintegerAccessor (&DistributedPlacementPolicy::maxSteps),
+                               MakeUintegerChecker<uint32_t> ())
+                .AddAttribute ("MigrationThreshold",
+                               "The share of the traffic of an operator a move must save for the operator to be migrated.",
+                               DoubleValue (0.2),
+                               MakeDoubleAccessor (&DistributedPlacementPolicy::migrationThreshold),
+                               MakeDoubleChecker<double> (0.0, 1.0))
+                .AddAttribute ("MonitoringInterval",
+                               "How often the placement of the hosted operators is checked.",
+                               TimeValue (Seconds (5.0)),
+                               MakeTimeAccessor (&DistributedPlacementPolicy::monitoringInterval),
+                               MakeTimeChecker ())
+                ;
+        return tid;
+    }
+    
+    DistributedPlacementPolicy::DistributedPlacementPolicy()
+    : defaultRate(10.0),
+      maxSteps(16),
+      migrationThreshold(0.2),
+      monitoringInterval(Seconds(5.0))
+    {}
+    
+    void
+    DistributedPlacementPolicy::configure() 
+    {
+        Ptr<Placement> p = GetObject<Placement>();
+        p->TraceConnectWithoutContext("Remote event received",
+                MakeCallback(&DistributedPlacementPolicy::CountEvent, this));
+        p->TraceConnectWithoutContext("new event produced",
+                MakeCallback(&DistributedPlacementPolicy::CountEvent, this));
+        p->TraceConnectWithoutContext("operator migrated",
+                MakeCallback(&DistributedPlacementPolicy::OperatorMigrated, this));
+    }
+    
+    bool
+    DistributedPlacementPolicy::doAdaptation(EventTypeId eType) 
+    {
+        Ptr<DcepState> dstate = GetObject<DcepState>();
+        if (dstate->GetState(eType) != ACTIVE)
+        {
+            return false;
+        }
+        
+        Ptr<Query> q = dstate->GetQuery(eType);
+        if (q->isAtomic || SharesInputs(q))
+        {
+            return false;
+        }
+        
+        double rates[3] = {GetObservedRate(q->inevent1, q->inputStream1_rate), 
+            (q->inevent2 == NO_EVENT_TYPE) ? 0 : GetObservedRate(q->inevent2, q->inputStream2_rate),
+            GetObservedRate(q->eventType, q->output_rate)};
+        double heaviest;
+        double total;
+        Ipv4Address next = GetHeaviestNeighbor(q, rates, heaviest, total);
+        
+        /* one hop closer to the heaviest ends, one hop further from the others */
+        double saving = 2 * heaviest - total;
+        if (next.IsAny() || (saving <= migrationThreshold * total))
+        {
+            return false;
+        }
+        
+        NS_LOG_INFO ("PLACEMENT: MOVING " << EventTypeTable::GetName(eType) << " TO " << next 
+                << " SAVES " << saving << " OF " << total);
+        return GetObject<Placement>()->MigrateOperator(eType, next);
+    }
+    
+    double
+    DistributedPlacementPolicy::GetObservedRate(EventTypeId eType, double fallback)
+    {
+        std::unordered_map<EventTypeId, RateCounter>::const_iterator it = observed.find(eType);
+        if (it != observed.end())
+        {
+            Time elapsed = Simulator::Now() - it->second.first;
+            if (elapsed.GetSeconds() >= 1.0)
+            {
+                return it->second.count / elapsed.GetSeconds();
+            }
+        }
+        return fallback;
+    }
+    
+    /* 
+     * another local operator consuming the same inputs would lose them 
+     * once they are redirected
+     */
+    bool
+    DistributedPlacementPolicy::SharesInputs(Ptr<Query> q)
+    {
+        Ptr<DcepState> dstate = GetObject<DcepState>();
+        EventTypeId inputs[2] = {q->inevent1, q->inevent2};
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            const std::vector<Ptr<EventRoutingTableEntry> >& consumers = dstate->GetConsumers(inputs[i]);
+            for (uint32_t j = 0; j < consumers.size(); j++)
+            {
+                if ((consumers[j]->source_query->eventType != q->eventType) 
+                        && (consumers[j]->state != UNDEFINED) && (consumers[j]->state != DEACTIVATED))
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+    
+    void
+    DistributedPlacementPolicy::Monitor()
+    {
+        std::vector<EventTypeId> operators = hosted;
+        for (uint32_t i = 0; i < operators.size(); i++)
+        {
+            doAdaptation(operators[i]);
+        }
+        
+        if (!hosted.empty())
+        {
+            monitorEvent = Simulator::Schedule(monitoringInterval, &DistributedPlacementPolicy::Monitor, this);
+        }
+    }
+    
+    void
+    DistributedPlacementPolicy::OperatorMigrated(EventTypeId eType, Ipv4Address host)
+    {
+        std::vector<EventTypeId>::iterator it = std::find(hosted.begin(), hosted.end(), eType);
+        if (host.IsEqual(GetObject<Communication>()->GetLocalAddress()))
+        {
+            if (it == hosted.end())
+            {
+                hosted.push_back(eType);
+            }
+            if (!monitorEvent.IsRunning())
+            {
+                monitorEvent = Simulator::Schedule(monitoringInterval, &DistributedPlacementPolicy::Monitor, this);
+            }
+        }
+        else if (it != hosted.end())
+        {
+            hosted.erase(it);
+        }
+    }
+    
+    bool
+    DistributedPlacementPolicy::IsOrigin()
+    {
+        Ptr<Communication> cm = GetObject<Communication>();
+        return cm->GetLocalAddress().IsEqual(cm->GetSinkAddress());
+    }
+    
+    void
+    DistributedPlacementPolicy::CountEvent(Ptr<Event> e)
+    {
+        std::unordered_map<EventTypeId, RateCounter>::iterator it = observed.find(e->type);
+        if (it == observed.end())
+        {
+            RateCounter counter;
+            counter.count = 1;
+            counter.first = Simulator::Now();
+            observed[e->type] = counter;
+        }
+        else
+        {
+            it->second.count++;
+        }
+    }
+    
+    double
+    DistributedPlacementPolicy::GetRate(EventTypeId eType)
+    {
+        return EstimateRate(eType, 0);
+    }
+    
+    double
+    DistributedPlacementPolicy::EstimateRate(EventTypeId eType, uint32_t depth)
+    {
+        std::unordered_map<EventTypeId, RateCounter>::const_iterator it = observed.find(eType);
+        if (it != observed.end())
+        {
+            Time elapsed = Simulator::Now() - it->second.first;
+            if (elapsed.GetSeconds() >= 1.0)
+            {
+                return it->second.count / elapsed.GetSeconds();
+            }
+        }
+        
+        std::unordered_map<EventTypeId, Ptr<Query> >::const_iterator qit = queries.find(eType);
+        if ((qit == queries.end()) || qit->second->isAtomic || (depth > queries.size()))
+        {
+            double advertised = GetObject<DcepState>()->GetAdvertisedRate(eType);
+            return (advertised > 0) ? advertised : defaultRate;
+        }
+        
+        /* composite streams, assuming matches are as frequent as the inputs allow */
+        Ptr<Query> q = qit->second;
+        double r1 = EstimateRate(q->inevent1, depth + 1);
+        double r2 = (q->inevent2 == NO_EVENT_TYPE) ? r1 : EstimateRate(q->inevent2, depth + 1);
+        if (q->op == "or")
+        {
+            return r1 + r2;
+        }
+        if ((q->op == "and") || (q->op == "seq"))
+        {
+            return std::min(r1, r2);
+        }
+        if (q->op == "kleene")
+        {
+            return r2;
+        }
+        if (q->report_period.IsStrictlyPositive())
+        {
+            return 1.0 / q->report_period.GetSeconds();
+        }
+        return r1;
+    }
+    
+    /*
+     * where the events of the given type come from: the producer of an 
+     * atomic type, the host of a placed operator or, for operators still 
+     * to be placed, the end of their heaviest input stream
+     */
+    Ipv4Address
+    DistributedPlacementPolicy::GetStreamEnd(EventTypeId eType, uint32_t depth)
+    {
+        std::unordered_map<EventTypeId, Ptr<Query> >::const_iterator it = queries.find(eType);
+        if ((it == queries.end()) || it->second->isAtomic || (depth > queries.size()))
+        {
+            return GetProducer(eType);
+        }
+        
+        Ipv4Address host = GetObject<DcepState>()->GetCurrentProcessor(eType);
+        if (!host.IsAny())
+        {
+            return host;
+        }
+        
+        Ptr<Query> q = it->second;
+        if ((q->inevent2 != NO_EVENT_TYPE) 
+                && (EstimateRate(q->inevent2, 0) > EstimateRate(q->inevent1, 0)))
+        {
+            return GetStreamEnd(q->inevent2, depth + 1);
+        }
+        return GetStreamEnd(q->inevent1, depth + 1);
+    }
+    
+    Ipv4Address
+    DistributedPlacementPolicy::GetParentHost(Ptr<Query> q)
+    {
+        if (q->isFinal || (q->parent_output == NO_EVENT_TYPE))
+        {
+            return GetObject<Communication>()->GetSinkAddress();
+        }
+        return GetObject<DcepState>()->GetCurrentProcessor(q->parent_output);
+    }
+    
+    void
+    DistributedPlacementPolicy::DoPlacement() 
+    {
+        NS_LOG_INFO ("Doing distributed placement");
+        std::vector<Ptr<Query> > &qs = GetObject<Placement>()->q_queue;
+        
+        if (IsOrigin())
+        {
+            for (uint32_t i = 0; i < qs.size(); i++)
+            {
+                if (!qs[i]->assigned)
+                {
+                    queries[qs[i]->eventType] = qs[i];
+                }
+            }
+        }
+        
+        PlacePending();
+    }
+    
+    bool
+    DistributedPlacementPolicy::PlaceQuery(Ptr<Query> q) 
+    {
+        Ptr<DcepState> dstate = GetObject<DcepState>();
+        Ipv4Address local = GetObject<Communication>()->GetLocalAddress();
+        
+        if (q->isAtomic)
+        {
+            return PlaceAtomicQuery(q);
+        }
+        
+        if (q->assigned)
+        {
+            if (q->currentHost.IsEqual(local))
+            {
+                Install(q);
+            }
+            else if (IsOrigin())
+            {
+                /* the host of an operator reports back */
+                NS_LOG_INFO ("OPERATOR " << EventTypeTable::GetName(q->eventType) 
+                        << " PLACED ON " << q->currentHost);
+                dstate->SetCurrentProcessor(q->eventType, q->currentHost);
+                dstate->SetNextHop(q->eventType, q->currentHost);
+                SchedulePlacement();
+            }
+            return true;
+        }
+        
+        if (IsOrigin() && (q->placement_steps == 0))
+        {
+            Ipv4Address parent = GetParentHost(q);
+            if (parent.IsAny())
+            {
+                return false;//wait until the parent is placed
+            }
+            
+            dstate->CreateEventRoutingTableEntry(q);
+            q->output_dest = parent;
+            q->output_rate = GetRate(q->eventType);
+            q->inputStream1_address = GetStreamEnd(q->inevent1, 0);
+            q->inputStream1_rate = GetRate(q->inevent1);
+            if (q->inevent2 != NO_EVENT_TYPE)
+            {
+                q->inputStream2_address = GetStreamEnd(q->inevent2, 0);
+                q->inputStream2_rate = GetRate(q->inevent2);
+            }
+            else
+            {
+                q->inputStream2_address = Ipv4Address::GetAny();
+                q->inputStream2_rate = 0;
+            }
+        }
+        
+        Walk(q);
+        return true;
+    }
+    
+    bool
+    DistributedPlacementPolicy::PlaceAtomicQuery(Ptr<Query> q)
+    {
+        Ptr<Placement> p = GetObject<Placement>();
+        Ptr<DcepState> dstate = GetObject<DcepState>();
+        Ipv4Address local = GetObject<Communication>()->GetLocalAddress();
+        
+        if (!q->assigned)
+        {
+            Ipv4Address parent = GetParentHost(q);
+            Ipv4Address producer = GetProducer(q->eventType);
+            if (parent.IsAny() || producer.IsAny())
+            {
+                return false;
+            }
+            
+            std::vector<Ipv4Address> others;
+            for (uint32_t i = 0; i < q->other_parent_outputs.size(); i++)
+            {
+                Ipv4Address host = GetObject<DcepState>()->GetCurrentProcessor(q->other_parent_outputs[i]);
+                if (host.IsAny())
+                {
+                    return false;
+                }
+                others.push_back(host);
+            }
+            
+            q->output_dest = parent;
+            q->other_output_dests = others;
+            q->currentHost = producer;
+            q->assigned = true;
+            if (!producer.IsEqual(local))
+            {
+                dstate->CreateEventRoutingTableEntry(q);
+                dstate->SetNextHop(q->eventType, producer);
+                dstate->SetCurrentProcessor(q->eventType, producer);
+                p->ForwardQuery(q->eventType);
+                return true;
+            }
+        }
+        
+        /* this node produces the events, they go to the parent operator */
+        dstate->CreateEventRoutingTableEntry(q);
+        dstate->SetNextHop(q->eventType, local);
+        dstate->SetCurrentProcessor(q->eventType, local);
+        dstate->SetOutDest(q->eventType, q->output_dest);
+        newLocalPlacement(q->eventType);
+        p->ForwardQuery(q->eventType);
+        return true;
+    }
+    
+    /*
+     * the neighbor behind which the stream ends of q with the highest 
+     * total rate are, Any if all the ends are local
+     */
+    Ipv4Address
+    DistributedPlacementPolicy::GetHeaviestNeighbor(Ptr<Query> q, const double rates[3], 
+            double &heaviest, double &total)
+    {
+        Ptr<ResourceManager> rm = GetObject<ResourceManager>();
+        Ipv4Address local = GetObject<Communication>()->GetLocalAddress();
+        
+        Ipv4Address ends[3] = {q->inputStream1_address, q->inputStream2_address, q->output_dest};
+        
+        /* the rate of the stream ends behind each neighbor */
+        std::unordered_map<uint32_t, double> weights;
+        total = 0;
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            total += rates[i];
+            if (ends[i].IsAny() || ends[i].IsEqual(local))
+            {
+                continue;
+            }
+            
+            RouteInfo route;
+            rm->getRoute(ends[i], route);
+            if (!route.nextHop.IsAny())
+            {
+                weights[route.nextHop.Get()] += rates[i];
+            }
+        }
+        
+        Ipv4Address next = Ipv4Address::GetAny();
+        heaviest = 0;
+        for (std::unordered_map<uint32_t, double>::const_iterator it = weights.begin(); 
+                it != weights.end(); ++it)
+        {
+            if (it->second > heaviest)
+            {
+                heaviest = it->second;
+                next = Ipv4Address(it->first);
+            }
+        }
+        return next;
+    }
+    
+    void
+    DistributedPlacementPolicy::Walk(Ptr<Query> q)
+    {
+        double rates[3] = {q->inputStream1_rate, q->inputStream2_rate, q->output_rate};
+        double heaviest;
+        double total;
+        Ipv4Address next = GetHeaviestNeighbor(q, rates, heaviest, total);
+        
+        if ((heaviest > total / 2) && (q->placement_steps < maxSteps))
+        {
+            NS_LOG_INFO ("PLACEMENT: MOVING " << EventTypeTable::GetName(q->eventType) 
+                    << " TOWARDS " << next);
+            q->placement_steps++;
+            GetObject<Placement>()->SendRemoteQuery(q, next);
+            return;
+        }
+        
+        q->assigned = true;
+        q->currentHost = GetObject<Communication>()->GetLocalAddress();
+        Install(q);
+    }
+    
+    void
+    DistributedPlacementPolicy::Install(Ptr<Query> q)
+    {
+        NS_LOG_INFO ("QUERY " << EventTypeTable::GetName(q->eventType) << " PLACED ON LOCAL NODE");
+        Ptr<DcepState> dstate = GetObject<DcepState>();
+        Ipv4Address local = GetObject<Communication>()->GetLocalAddress();
+        
+        dstate->CreateEventRoutingTableEntry(q);
+        dstate->SetNextHop(q->eventType, local);
+        dstate->SetCurrentProcessor(q->eventType, local);
+        dstate->SetOutDest(q->eventType, q->output_dest);
+        newLocalPlacement(q->eventType);
+        GetObject<Placement>()->ForwardQuery(q->eventType);
+        OperatorMigrated(q->eventType, local);
+        
+        if (IsOrigin())
+        {
+            SchedulePlacement();
+        }
+        else
+        {
+            GetObject<Placement>()->SendRemoteQuery(q, GetObject<Communication>()->GetSinkAddress());
+        }
+    }
 
-}
\ No newline at end of file
+}
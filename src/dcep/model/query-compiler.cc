@@ -0,0 +1,550 @@
+/*
+ * Copyright (C) 2018, Fabrice S. Bigirimana
+ * Copyright (c) 2018, University of Oslo
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#include "query-compiler.h"
+#include "cep-engine.h"
+#include "common.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+
+namespace ns3
+{
+    NS_LOG_COMPONENT_DEFINE ("QueryCompiler");
+
+    static std::string
+    ToLower(const std::string &s)
+    {
+        std::string lower(s);
+        for(uint32_t i = 0; i < lower.size(); i++)
+        {
+            lower[i] = std::tolower(lower[i]);
+        }
+        return lower;
+    }
+
+    static bool
+    IsNameChar(char c)
+    {
+        return std::isalnum(c) || (c == '_');
+    }
+
+    static bool
+    IsAggregateFunction(const std::string &f)
+    {
+        return (f == "count") || (f == "sum") || (f == "avg")
+                || (f == "min") || (f == "max");
+    }
+
+    QueryCompiler::QueryCompiler()
+    : nextId(1),
+      pos(0),
+      intermediates(0)
+    {
+    }
+
+    void
+    QueryCompiler::Compile(const std::string &t, std::vector<Ptr<Query> > &queries)
+    {
+        text = t;
+        pos = 0;
+        compiled.clear();
+        while(!AtEnd())
+        {
+            if(Accept(";"))
+            {
+                continue;
+            }
+            ParseStatement(queries);
+            if(!AtEnd())
+            {
+                Expect(";");
+            }
+        }
+    }
+
+    void
+    QueryCompiler::ParseStatement(std::vector<Ptr<Query> > &queries)
+    {
+        Expect("SELECT");
+        selected = ReadName();
+        Expect("FROM");
+        Node root = ParseExpression();
+        if(root.op.empty())
+        {
+            Fail("FROM needs an operator");
+        }
+
+        std::string filter;
+        uint32_t window_type = NO_WINDOW;
+        uint32_t window_mode = SLIDING_WINDOW;
+        Time window_length;
+        uint32_t window_count = 0;
+        bool aggregated = false;
+        double threshold = 0;
+        Time report_period;
+
+        while(true)
+        {
+            if(Accept("WHERE"))
+            {
+                filter = ReadFilter();
+                /* aborts on malformed filters, before anything is dispatched */
+                EventFilter::Compile(filter);
+            }
+            else if(Accept("WITHIN"))
+            {
+                double n = ReadNumber();
+                if(Accept("EVENTS"))
+                {
+                    window_type = COUNT_WINDOW;
+                    window_count = n;
+                }
+                else
+                {
+                    window_type = TIME_WINDOW;
+                    window_length = ReadTime(n);
+                }
+                if(Accept("TUMBLING"))
+                {
+                    window_mode = TUMBLING_WINDOW;
+                }
+                else
+                {
+                    Accept("SLIDING");
+                }
+            }
+            else if(Accept("ABOVE"))
+            {
+                threshold = ReadNumber();
+                aggregated = true;
+            }
+            else if(Accept("EVERY"))
+            {
+                report_period = ReadTime(ReadNumber());
+                aggregated = true;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        if(aggregated && !IsAggregateFunction(root.op))
+        {
+            Fail("ABOVE and EVERY need an aggregate");
+        }
+
+        intermediates = 0;
+        atomicQueries.clear();
+        operators.clear();
+        Emit(root, EventTypeTable::Intern(selected));
+
+        for(uint32_t i = 0; i < operators.size(); i++)
+        {
+            Ptr<Query> q = operators[i];
+            q->filter = filter;
+            q->window_type = window_type;
+            q->window_mode = window_mode;
+            q->window_length = window_length;
+            q->window_count = window_count;
+        }
+        Ptr<Query> top = operators.back();
+        top->isFinal = true;
+        top->threshold = threshold;
+        top->report_period = report_period;
+
+        NS_LOG_INFO("Compiled " << selected << " into " << atomicQueries.size()
+                << " atomic queries and " << operators.size() << " operators");
+        queries.insert(queries.end(), atomicQueries.begin(), atomicQueries.end());
+        queries.insert(queries.end(), operators.begin(), operators.end());
+    }
+
+    QueryCompiler::Node
+    QueryCompiler::ParseExpression()
+    {
+        std::vector<Node> operands;
+        operands.push_back(ParseTerm());
+
+        std::string op;
+        while(true)
+        {
+            std::string next;
+            if(Accept("AND")) next = "and";
+            else if(Accept("OR")) next = "or";
+            else if(Accept("SEQ")) next = "seq";
+            else break;
+
+            if(!op.empty() && (op != next))
+            {
+                Fail("different operators in a row, use parentheses");
+            }
+            op = next;
+            operands.push_back(ParseTerm());
+        }
+
+        if(operands.size() == 1)
+        {
+            return operands[0];
+        }
+
+        if(op == "seq")
+        {
+            /* one pattern over all the operands */
+            Node node;
+            node.op = op;
+            node.inputs = operands;
+            return node;
+        }
+
+        Node node = operands[0];
+        for(uint32_t i = 1; i < operands.size(); i++)
+        {
+            Node parent;
+            parent.op = op;
+            parent.inputs.push_back(node);
+            parent.inputs.push_back(operands[i]);
+            node = parent;
+        }
+        return node;
+    }
+
+    QueryCompiler::Node
+    QueryCompiler::ParseTerm()
+    {
+        if(Accept("("))
+        {
+            Node node = ParseExpression();
+            Expect(")");
+            return node;
+        }
+
+        Node node;
+        node.name = ReadName();
+        if(!Accept("("))
+        {
+            return node;
+        }
+
+        node.op = ToLower(node.name);
+        node.name.clear();
+        do
+        {
+            node.inputs.push_back(ParseExpression());
+        } while(Accept(","));
+        Expect(")");
+
+        uint32_t n = node.inputs.size();
+        if((node.op == "and") || (node.op == "or") || (node.op == "kleene"))
+        {
+            if(n != 2) Fail(node.op + " takes two inputs");
+        }
+        else if(node.op == "seq")
+        {
+            if(n < 2) Fail("seq takes two inputs or more");
+        }
+        else if(IsAggregateFunction(node.op))
+        {
+            if(n != 1) Fail(node.op + " takes one input");
+        }
+        else
+        {
+            Fail("unknown function " + node.op);
+        }
+        return node;
+    }
+
+    EventTypeId
+    QueryCompiler::Emit(const Node &node, EventTypeId output)
+    {
+        if(node.op.empty())
+        {
+            /* read from a datasource */
+            EventTypeId type = EventTypeTable::Intern(node.name);
+            if(atomics.find(type) == atomics.end())
+            {
+                Ptr<Query> q = CreateObject<Query>();
+                q->actionType = NOTIFICATION;
+                q->id = nextId++;
+                q->isFinal = false;
+                q->isAtomic = true;
+                q->eventType = type;
+                q->output_dest = Ipv4Address::GetAny();
+                q->inevent1 = type;
+                q->inevent2 = NO_EVENT_TYPE;
+                q->op = "true";
+                q->assigned = false;
+                q->currentHost.Set("0.0.0.0");
+                atomics[type] = q;
+                atomicQueries.push_back(q);
+                compiled.insert(type);
+            }
+            return type;
+        }
+
+        std::vector<EventTypeId> inputs;
+        for(uint32_t i = 0; i < node.inputs.size(); i++)
+        {
+            EventTypeId type = NO_EVENT_TYPE;
+            if(!node.inputs[i].op.empty())
+            {
+                std::ostringstream name;
+                name << selected << "_" << ++intermediates;
+                type = EventTypeTable::Intern(name.str());
+            }
+            inputs.push_back(Emit(node.inputs[i], type));
+        }
+
+        Ptr<Query> q = CreateObject<Query>();
+        q->actionType = NOTIFICATION;
+        q->id = nextId++;
+        q->isFinal = false;
+        q->isAtomic = false;
+        q->eventType = output;
+        q->output_dest = Ipv4Address::GetAny();
+        q->op = node.op;
+        q->assigned = false;
+        q->currentHost.Set("0.0.0.0");
+        q->inevent1 = inputs[0];
+        q->inevent2 = (inputs.size() > 1) ? inputs[1] : NO_EVENT_TYPE;
+        if(inputs.size() > 2)
+        {
+            q->inevents = inputs;
+        }
+
+        /* every input goes to this operator, a type already read to it too */
+        for(uint32_t i = 0; i < inputs.size(); i++)
+        {
+            Ptr<Query> child = FindQuery(inputs[i]);
+            if(child->parent_output == NO_EVENT_TYPE)
+            {
+                child->parent_output = output;
+                continue;
+            }
+            if((child->parent_output == output) 
+                    || (std::find(child->other_parent_outputs.begin(), child->other_parent_outputs.end(), 
+                    output) != child->other_parent_outputs.end()))
+            {
+                continue;
+            }
+            
+            child->other_parent_outputs.push_back(output);
+            if(compiled.find(inputs[i]) == compiled.end())
+            {
+                /* dispatched already, it is placed again with the new operator */
+                child->assigned = false;
+                child->other_output_dests.clear();
+                atomicQueries.push_back(child);
+                compiled.insert(inputs[i]);
+            }
+        }
+        operators.push_back(q);
+        return output;
+    }
+    
+    Ptr<Query>
+    QueryCompiler::FindQuery(EventTypeId type)
+    {
+        std::unordered_map<EventTypeId, Ptr<Query> >::iterator it = atomics.find(type);
+        if(it != atomics.end())
+        {
+            return it->second;
+        }
+        for(uint32_t i = 0; i < operators.size(); i++)
+        {
+            if(operators[i]->eventType == type)
+            {
+                return operators[i];
+            }
+        }
+        NS_ABORT_MSG("QUERY COMPILER: NO QUERY PRODUCES " << EventTypeTable::GetName(type));
+        return 0;
+    }
+
+    void
+    QueryCompiler::SkipBlanks()
+    {
+        while(pos < text.size())
+        {
+            if(std::isspace(text[pos]))
+            {
+                pos++;
+            }
+            else if(text[pos] == '#')
+            {
+                pos = text.find('\n', pos);
+                if(pos == std::string::npos)
+                {
+                    pos = text.size();
+                }
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+
+    bool
+    QueryCompiler::AtEnd()
+    {
+        SkipBlanks();
+        return pos >= text.size();
+    }
+
+    bool
+    QueryCompiler::Accept(const std::string &keyword)
+    {
+        SkipBlanks();
+        if(text.compare(pos, keyword.size(), keyword) == 0 && !IsNameChar(keyword[0]))
+        {
+            pos += keyword.size();
+            return true;
+        }
+
+        std::string::size_type end = pos;
+        while((end < text.size()) && IsNameChar(text[end]))
+        {
+            end++;
+        }
+        if((end > pos) && (ToLower(text.substr(pos, end - pos)) == ToLower(keyword)))
+        {
+            pos = end;
+            return true;
+        }
+        return false;
+    }
+
+    void
+    QueryCompiler::Expect(const std::string &keyword)
+    {
+        if(!Accept(keyword))
+        {
+            Fail("expected " + keyword);
+        }
+    }
+
+    std::string
+    QueryCompiler::ReadName()
+    {
+        SkipBlanks();
+        std::string::size_type begin = pos;
+        while((pos < text.size()) && IsNameChar(text[pos]))
+        {
+            pos++;
+        }
+        if((pos == begin) || std::isdigit(text[begin]))
+        {
+            pos = begin;
+            Fail("expected an event type");
+        }
+        return text.substr(begin, pos - begin);
+    }
+
+    double
+    QueryCompiler::ReadNumber()
+    {
+        SkipBlanks();
+        const char *begin = text.c_str() + pos;
+        char *end;
+        double n = std::strtod(begin, &end);
+        if(end == begin)
+        {
+            Fail("expected a number");
+        }
+        pos += end - begin;
+        return n;
+    }
+
+    Time
+    QueryCompiler::ReadTime(double n)
+    {
+        SkipBlanks();
+        std::string::size_type begin = pos;
+        while((pos < text.size()) && std::isalpha(text[pos]))
+        {
+            pos++;
+        }
+        std::string unit = ToLower(text.substr(begin, pos - begin));
+
+        if(unit == "h") return Time::FromDouble(n, Time::H);
+        if(unit == "min") return Time::FromDouble(n, Time::MIN);
+        if(unit == "s") return Time::FromDouble(n, Time::S);
+        if(unit == "ms") return Time::FromDouble(n, Time::MS);
+        if(unit == "us") return Time::FromDouble(n, Time::US);
+        if(unit == "ns") return Time::FromDouble(n, Time::NS);
+        pos = begin;
+        Fail("expected a time unit");
+        return Time();
+    }
+
+    std::string
+    QueryCompiler::ReadFilter()
+    {
+        static const char *clauses[] = {"WITHIN", "ABOVE", "EVERY"};
+
+        SkipBlanks();
+        std::string::size_type begin = pos;
+        std::string::size_type end = pos;
+        while((end < text.size()) && (text[end] != ';'))
+        {
+            bool clause = false;
+            if(((end == begin) || !IsNameChar(text[end-1])) && IsNameChar(text[end]))
+            {
+                std::string::size_type word = end;
+                while((word < text.size()) && IsNameChar(text[word]))
+                {
+                    word++;
+                }
+                for(uint32_t i = 0; i < 3; i++)
+                {
+                    clause = clause || (ToLower(text.substr(end, word - end)) == ToLower(clauses[i]));
+                }
+            }
+            if(clause)
+            {
+                break;
+            }
+            end++;
+        }
+
+        pos = end;
+        std::string filter = text.substr(begin, end - begin);
+        filter.erase(filter.find_last_not_of(" \t\r\n") + 1);
+        if(filter.empty())
+        {
+            Fail("expected a filter");
+        }
+        return filter;
+    }
+
+    void
+    QueryCompiler::Fail(const std::string &message)
+    {
+        uint32_t line = 1;
+        for(std::string::size_type i = 0; (i < pos) && (i < text.size()); i++)
+        {
+            if(text[i] == '\n') line++;
+        }
+        NS_ABORT_MSG ("QUERY SYNTAX ERROR LINE " << line << ": " << message
+                << " at \"" << text.substr(pos, 20) << "\"");
+    }
+}
@@ -19,24 +19,351 @@
 
 #include "resource-manager.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 #include "ns3/string.h"
 #include "dcep.h"
 #include "cep-engine.h"
 #include "ns3/boolean.h"
 #include "dcep-state.h"
 #include "ns3/communication.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-list-routing.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/node-list.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/packet.h"
+#include <sstream>
 
 namespace ns3
 {
+    NS_OBJECT_ENSURE_REGISTERED (RoutingInfo);
+    NS_OBJECT_ENSURE_REGISTERED (OlsrRoutingInfo);
+    NS_OBJECT_ENSURE_REGISTERED (Ipv4RoutingInfo);
     NS_OBJECT_ENSURE_REGISTERED (ResourceManager);
     NS_LOG_COMPONENT_DEFINE ("ResourceManager");
     
+    const uint32_t RouteInfo::UNKNOWN_DISTANCE;
+    
+    RouteInfo::RouteInfo()
+    : nextHop(Ipv4Address::GetAny()),
+      distance(UNKNOWN_DISTANCE),
+      interface(0)
+    {}
+    
+    TypeId
+    RoutingInfo::GetTypeId(void)
+    {
+        static TypeId id = TypeId("ns3::RoutingInfo")
+        .SetParent<Object>();
+        
+        return id;
+    }
+    
+    bool
+    RoutingInfo::IsReactive(void) const
+    {
+        return false;
+    }
+    
+    bool
+    RoutingInfo::ReportsChanges(void) const
+    {
+        return false;
+    }
+    
+    void
+    RoutingInfo::SetChangeCallback(Callback<void> cb)
+    {
+        changed = cb;
+    }
+    
+    TypeId
+    OlsrRoutingInfo::GetTypeId(void)
+    {
+        static TypeId id = TypeId("ns3::OlsrRoutingInfo")
+        .SetParent<RoutingInfo>()
+        .AddConstructor<OlsrRoutingInfo>();
+        
+        return id;
+    }
+    
+    OlsrRoutingInfo::OlsrRoutingInfo()
+    : stale(true)
+    {}
+    
+    void
+    OlsrRoutingInfo::SetRoutingProtocol(Ptr<olsr::RoutingProtocol> protocol)
+    {
+        olsr_routing_protocol = protocol;
+        olsr_routing_protocol->TraceConnectWithoutContext("RoutingTableChanged",
+                MakeCallback(&OlsrRoutingInfo::RoutingTableChanged, this));
+        stale = true;
+    }
+    
+    bool
+    OlsrRoutingInfo::ReportsChanges(void) const
+    {
+        return true;
+    }
+    
+    void
+    OlsrRoutingInfo::RoutingTableChanged(uint32_t size)
+    {
+        /* the table is recomputed often, it is copied again on the next lookup only */
+        stale = true;
+        if (!changed.IsNull()) {
+            changed();
+        }
+    }
+    
+    void
+    OlsrRoutingInfo::RefreshRoutes(void)
+    {
+        routes.clear();
+        std::vector<olsr::RoutingTableEntry> entries = olsr_routing_protocol->GetRoutingTableEntries();
+        for (uint32_t i = 0; i < entries.size(); i++)
+        {
+            routes[entries[i].destAddr.Get()] = entries[i];
+        }
+        stale = false;
+    }
+    
+    bool
+    OlsrRoutingInfo::Lookup(Ipv4Address dest, RouteInfo &route)
+    {
+        if (stale) {
+            RefreshRoutes();
+        }
+
+        std::unordered_map<uint32_t, olsr::RoutingTableEntry>::const_iterator it 
+                = routes.find(dest.Get());
+        if (it == routes.end()) {
+            return false;
+        }
+        
+        route.distance = it->second.distance;
+        route.interface = it->second.interface;
+        route.nextHop = it->second.nextAddr;
+        return true;
+    }
+    
+    TypeId
+    Ipv4RoutingInfo::GetTypeId(void)
+    {
+        static TypeId id = TypeId("ns3::Ipv4RoutingInfo")
+        .SetParent<RoutingInfo>()
+        .AddConstructor<Ipv4RoutingInfo>();
+        
+        return id;
+    }
+    
+    Ipv4RoutingInfo::Ipv4RoutingInfo()
+    : reactive(false)
+    {}
+    
+    void
+    Ipv4RoutingInfo::SetNode(Ptr<Node> node)
+    {
+        ipv4 = node->GetObject<Ipv4>();
+        NS_ABORT_MSG_IF(ipv4 == 0, "Ipv4RoutingInfo needs a node with an ipv4 stack");
+    }
+    
+    void
+    Ipv4RoutingInfo::SetReactive(bool r)
+    {
+        reactive = r;
+    }
+    
+    bool
+    Ipv4RoutingInfo::IsReactive(void) const
+    {
+        return reactive;
+    }
+    
+    bool
+    Ipv4RoutingInfo::Lookup(Ipv4Address dest, RouteInfo &route)
+    {
+        Ptr<Ipv4RoutingProtocol> protocol = ipv4->GetRoutingProtocol();
+        if (protocol == 0) {
+            return false;
+        }
+        
+        return LookupProtocol(protocol, dest, route);
+    }
+    
+    bool
+    Ipv4RoutingInfo::LookupProtocol(Ptr<Ipv4RoutingProtocol> protocol, Ipv4Address dest, RouteInfo &route)
+    {
+        /* the first protocol of a list having a route routes the packet */
+        Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting>(protocol);
+        if (list != 0) {
+            for (uint32_t i = 0; i < list->GetNRoutingProtocols(); i++) {
+                int16_t priority;
+                if (LookupProtocol(list->GetRoutingProtocol(i, priority), dest, route)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        
+        Ptr<Ipv4StaticRouting> staticRouting = DynamicCast<Ipv4StaticRouting>(protocol);
+        if (staticRouting != 0) {
+            return LookupStatic(staticRouting, dest, route);
+        }
+        
+        if (protocol->GetInstanceTypeId().GetName() == "ns3::aodv::RoutingProtocol") {
+            return LookupAodv(protocol, dest, route);
+        }
+        
+        return LookupOutput(protocol, dest, route);
+    }
+    
+    bool
+    Ipv4RoutingInfo::LookupStatic(Ptr<Ipv4StaticRouting> protocol, Ipv4Address dest, RouteInfo &route)
+    {
+        /* as the protocol, the longest prefix then the lowest metric */
+        bool found = false;
+        Ipv4RoutingTableEntry best;
+        uint16_t bestLength = 0;
+        uint32_t bestMetric = 0;
+        for (uint32_t i = 0; i < protocol->GetNRoutes(); i++) {
+            Ipv4RoutingTableEntry entry = protocol->GetRoute(i);
+            if (!entry.GetDestNetworkMask().IsMatch(dest, entry.GetDestNetwork())
+                    || !ipv4->IsUp(entry.GetInterface())) {
+                continue;
+            }
+            
+            uint16_t length = entry.GetDestNetworkMask().GetPrefixLength();
+            uint32_t metric = protocol->GetMetric(i);
+            if (found && (length < bestLength || (length == bestLength && metric >= bestMetric))) {
+                continue;
+            }
+            found = true;
+            best = entry;
+            bestLength = length;
+            bestMetric = metric;
+        }
+        
+        if (!found) {
+            return false;
+        }
+        
+        if (best.GetGateway().IsAny() || best.GetGateway() == dest) {
+            route.nextHop = dest;
+            route.distance = 1;
+        }
+        else {
+            /* the metric of a route set up by hand counts its hops */
+            route.nextHop = best.GetGateway();
+            route.distance = (bestMetric > 0) ? bestMetric : RouteInfo::UNKNOWN_DISTANCE;
+        }
+        route.interface = best.GetInterface();
+        return true;
+    }
+    
+    bool
+    Ipv4RoutingInfo::LookupAodv(Ptr<Ipv4RoutingProtocol> protocol, Ipv4Address dest, RouteInfo &route)
+    {
+        std::ostringstream table;
+        protocol->PrintRoutingTable(Create<OutputStreamWrapper>(&table));
+        std::ostringstream address;
+        address << dest;
+        
+        /* destination, gateway, interface, flag, expire, hops */
+        std::istringstream lines(table.str());
+        std::string line;
+        while (std::getline(lines, line)) {
+            std::istringstream fields(line);
+            std::string destination, gateway, local, flag;
+            double expire;
+            uint32_t hops;
+            if (!(fields >> destination >> gateway >> local >> flag >> expire >> hops)
+                    || destination != address.str() || flag != "UP") {
+                continue;
+            }
+            
+            route.nextHop = Ipv4Address(gateway.c_str());
+            route.distance = hops;
+            route.interface = ipv4->GetInterfaceForAddress(Ipv4Address(local.c_str()));
+            return true;
+        }
+        return false;
+    }
+    
+    bool
+    Ipv4RoutingInfo::LookupOutput(Ptr<Ipv4RoutingProtocol> protocol, Ipv4Address dest, RouteInfo &route)
+    {
+        /* 
+         * aodv answers a null packet with a loopback route, a dummy 
+         * packet gets the route it really has.
+         */
+        Ipv4Header header;
+        header.SetDestination(dest);
+        Socket::SocketErrno err = Socket::ERROR_NOTERROR;
+        Ptr<Ipv4Route> r = protocol->RouteOutput(Create<Packet>(), header, 0, err);
+        
+        /* reactive protocols return loopback while the route is not known yet */
+        if (r == 0 || err != Socket::ERROR_NOTERROR || r->GetGateway().IsLocalhost()) {
+            return false;
+        }
+        
+        Ipv4Address gateway = r->GetGateway();
+        if (gateway.IsAny() || gateway == dest) {
+            /* on link */
+            route.nextHop = dest;
+            route.distance = 1;
+        }
+        else {
+            route.nextHop = gateway;
+            route.distance = (protocol->GetInstanceTypeId().GetName() == "ns3::Ipv4NixVectorRouting")
+                    ? CountNixHops(gateway, dest) : RouteInfo::UNKNOWN_DISTANCE;
+        }
+        route.interface = ipv4->GetInterfaceForDevice(r->GetOutputDevice());
+        return true;
+    }
+    
+    uint32_t
+    Ipv4RoutingInfo::CountNixHops(Ipv4Address gateway, Ipv4Address dest)
+    {
+        Ipv4Header header;
+        header.SetDestination(dest);
+        Ipv4Address hop = gateway;
+        
+        /* a path visits each node once */
+        for (uint32_t hops = 1; hops < NodeList::GetNNodes(); hops++) {
+            Ptr<Ipv4> next = 0;
+            for (NodeList::Iterator it = NodeList::Begin(); it != NodeList::End() && next == 0; it++) {
+                Ptr<Ipv4> candidate = (*it)->GetObject<Ipv4>();
+                if (candidate != 0 && candidate->GetInterfaceForAddress(hop) >= 0) {
+                    next = candidate;
+                }
+            }
+            if (next == 0 || next->GetRoutingProtocol() == 0) {
+                return RouteInfo::UNKNOWN_DISTANCE;
+            }
+            
+            Socket::SocketErrno err = Socket::ERROR_NOTERROR;
+            Ptr<Ipv4Route> r = next->GetRoutingProtocol()->RouteOutput(Create<Packet>(), header, 0, err);
+            if (r == 0 || err != Socket::ERROR_NOTERROR) {
+                return RouteInfo::UNKNOWN_DISTANCE;
+            }
+            if (r->GetGateway().IsAny() || r->GetGateway() == dest) {
+                return hops + 1;
+            }
+            hop = r->GetGateway();
+        }
+        return RouteInfo::UNKNOWN_DISTANCE;
+    }
+    
     TypeId
     ResourceManager::GetTypeId(void)
     {
         static TypeId id = TypeId("ns3::ResourceManager")
         .SetParent<Object>()
-        .AddConstructor<ResourceManager>();
+        .AddConstructor<ResourceManager>()
+        .AddTraceSource ("RoutesChanged",
+                         "The routing protocol changed its routes.",
+                         MakeTraceSourceAccessor (&ResourceManager::routesChanged));
         
         return id;
     }
@@ -48,66 +375,79 @@ namespace ns3
     ResourceManager::Configure(void)
     {
         Ptr<Dcep> dcep = GetObject<Dcep>();
-        Ptr<Placement> p = GetObject<Placement>();
 
         StringValue s;
         dcep->GetAttribute("routing protocol", s);
+        std::string protocol = s.Get();
 
-        if (s.Get() == "olsr") 
+        if (protocol == "olsr") 
         {
-
             NS_LOG_INFO("Current routing protocol is olsr");
-            olsr_routing_protocol = dcep->GetNode()->GetObject<olsr::RoutingProtocol>();
-
+            Ptr<olsr::RoutingProtocol> olsr_routing_protocol = dcep->GetNode()->GetObject<olsr::RoutingProtocol>();
+            NS_ABORT_MSG_IF(olsr_routing_protocol == 0, "routing protocol is olsr but olsr is not installed on the node");
+            
+            Ptr<OlsrRoutingInfo> info = CreateObject<OlsrRoutingInfo>();
+            info->SetRoutingProtocol(olsr_routing_protocol);
+            SetRoutingInfo(info);
+        }
+        else if (protocol == "aodv" || protocol == "dsdv" || protocol == "dsr"
+                || protocol == "static" || protocol == "nix")
+        {
+            NS_LOG_INFO("Current routing protocol is " << protocol);
+            Ptr<Ipv4RoutingInfo> info = CreateObject<Ipv4RoutingInfo>();
+            info->SetNode(dcep->GetNode());
+            /* dsr has no ipv4 routing, its routes are only found by sending */
+            info->SetReactive(protocol == "aodv" || protocol == "dsr");
+            SetRoutingInfo(info);
+        }
+        else
+        {
+            NS_ABORT_MSG("Unknown routing protocol " << protocol);
         }
     }
     
+    void
+    ResourceManager::SetRoutingInfo(Ptr<RoutingInfo> info)
+    {
+        routing = info;
+        routing->SetChangeCallback(MakeCallback(&ResourceManager::RoutesChanged, this));
+    }
+    
+    bool
+    ResourceManager::ReportsRouteChanges(void) const
+    {
+        return routing && routing->ReportsChanges();
+    }
     
     void
-    ResourceManager::getRoute(olsr::RoutingTableEntry &rentry) {
+    ResourceManager::RoutesChanged(void)
+    {
+        routesChanged();
+    }
+    
+    bool
+    ResourceManager::getRoute(Ipv4Address dest, RouteInfo &route) {
 
         /*
          * gets the route to a specific destination on behalf
          * of a placement policy.
          * 
          */
-        //NS_LOG_INFO("checking entry " << rentry.destAddr);
+        route.destination = dest;
+        route.nextHop = Ipv4Address::GetAny();
+        route.distance = RouteInfo::UNKNOWN_DISTANCE;
 
-        if (rentry.destAddr == GetObject<Communication>()->GetLocalAddress()) {
+        if (dest == GetObject<Communication>()->GetLocalAddress()) {
             NS_LOG_INFO("DESTINATION IS LOCAL NODE, SOMEONE IS SCRUING UP! ABORTING...");
             NS_FATAL_ERROR_NO_MSG ();
-            rentry.nextAddr = GetObject<Communication>()->GetLocalAddress();
-            return;
         }
 
-        if (olsr_routing_protocol) {
-            std::vector<ns3::olsr::RoutingTableEntry>::iterator it;
-            std::vector<ns3::olsr::RoutingTableEntry> olsr_entries = olsr_routing_protocol->GetRoutingTableEntries();
-
-            bool found = false;
-            for (it = olsr_entries.begin(); it != olsr_entries.end(); it++) {
-                ns3::olsr::RoutingTableEntry entry = *it;
-
-                //NS_LOG_INFO("current entry " << entry.destAddr );
-
-                if (entry.destAddr.IsEqual(rentry.destAddr)) {
-          //          NS_LOG_INFO("found entry, next hop is " << entry.nextAddr);
-                    found = true;
-                    //found an entry for the current destination
-                    rentry.distance = entry.distance;
-                    rentry.interface = entry.interface;
-                    rentry.nextAddr.Set(entry.nextAddr.Get()); //the next hop
-//                    if(this->localAddress.IsEqual(this->sinkAddress))
-//                    std::cout << "Number of hops to destination: " << entry.distance << std::endl;
-                    break;
-                }
-            }
-            if (!found) {
-               // NS_LOG_INFO("Couldn't find next hop to provided destination");
-                rentry.nextAddr = Ipv4Address::GetAny();
-            }
+        if (routing->Lookup(dest, route)) {
+            return true;
         }
-
+        
+        route.nextHop = Ipv4Address::GetAny();
+        return routing->IsReactive();
     }
     
 }
@@ -24,6 +24,11 @@
 #include "placement.h"
 #include "ns3/olsr-routing-protocol.h"
 #include "ns3/ipv4.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/node.h"
+#include "event-type.h"
+#include <unordered_map>
 
 namespace ns3
 {
@@ -34,10 +39,107 @@ namespace ns3
             Ipv4Address adr;
             uint32_t hops;
             Ipv4Address nextAddr;
-            std::vector<std::string> etypes;
+            std::vector<EventTypeId> etypes;
           //  uint32_t threshhold;
     };
 
+    /*
+     * a route as dcep sees it, whatever protocol computed it. The
+     * next hop is Any if there is no route, the distance is the number
+     * of hops when the protocol reports it and UNKNOWN_DISTANCE otherwise.
+     */
+    struct RouteInfo
+    {
+        static const uint32_t UNKNOWN_DISTANCE = 0xffffffff;
+
+        RouteInfo ();
+        Ipv4Address destination;
+        Ipv4Address nextHop;
+        uint32_t distance;
+        uint32_t interface;
+    };
+
+    /*
+     * the routing information of the node, one subclass per kind of
+     * routing protocol.
+     */
+    class RoutingInfo : public Object
+    {
+        public:
+            static TypeId GetTypeId (void);
+
+            /* fills the route to the destination, false if there is none */
+            virtual bool Lookup (Ipv4Address dest, RouteInfo &route) = 0;
+            /*
+             * true if the protocol finds routes on demand, packets to
+             * destinations without a route then trigger the discovery.
+             */
+            virtual bool IsReactive (void) const;
+            /* true if the change callback is called when routes change */
+            virtual bool ReportsChanges (void) const;
+            /* called when routes may have appeared or changed */
+            void SetChangeCallback (Callback<void> cb);
+
+        protected:
+            Callback<void> changed;
+    };
+
+    /* routes from the olsr table, copied again only after it changed */
+    class OlsrRoutingInfo : public RoutingInfo
+    {
+        public:
+            static TypeId GetTypeId (void);
+
+            OlsrRoutingInfo ();
+            void SetRoutingProtocol (Ptr<olsr::RoutingProtocol> protocol);
+            virtual bool Lookup (Ipv4Address dest, RouteInfo &route);
+            virtual bool ReportsChanges (void) const;
+
+        private:
+            void RoutingTableChanged (uint32_t size);
+            void RefreshRoutes (void);
+
+            Ptr<olsr::RoutingProtocol> olsr_routing_protocol;
+            /* routes by destination address */
+            std::unordered_map<uint32_t, olsr::RoutingTableEntry> routes;
+            bool stale;
+    };
+
+    /*
+     * routes asked to the ipv4 routing protocol of the node, which
+     * works for static and nix-vector routing as well as aodv, dsdv
+     * or a list of them, none of which tells when its routes changed.
+     * The distance is known on link, from the metric of a static
+     * route, by following a nix-vector route and from the aodv table.
+     */
+    class Ipv4RoutingInfo : public RoutingInfo
+    {
+        public:
+            static TypeId GetTypeId (void);
+
+            Ipv4RoutingInfo ();
+            void SetNode (Ptr<Node> node);
+            void SetReactive (bool reactive);
+            virtual bool Lookup (Ipv4Address dest, RouteInfo &route);
+            virtual bool IsReactive (void) const;
+
+        private:
+            /* the route of one protocol, false if it has none */
+            bool LookupProtocol (Ptr<Ipv4RoutingProtocol> protocol, Ipv4Address dest, RouteInfo &route);
+            /* the longest match in the table, without routing a packet */
+            bool LookupStatic (Ptr<Ipv4StaticRouting> protocol, Ipv4Address dest, RouteInfo &route);
+            /* read from the printed table, routing a packet would refresh
+             * the route and queue the packet for a discovery */
+            bool LookupAodv (Ptr<Ipv4RoutingProtocol> protocol, Ipv4Address dest, RouteInfo &route);
+            /* the route of a packet to dest */
+            bool LookupOutput (Ptr<Ipv4RoutingProtocol> protocol, Ipv4Address dest, RouteInfo &route);
+            /* the hops of a nix-vector route, asking each node on the way */
+            uint32_t CountNixHops (Ipv4Address gateway, Ipv4Address dest);
+
+            Ptr<Ipv4> ipv4;
+            bool reactive;
+    };
+
     class ResourceManager: public Object
     {
         public:
@@ -46,11 +148,26 @@ namespace ns3
             ResourceManager ();
 
             void Configure (void);
-            void getRoute(olsr::RoutingTableEntry &);
+            /**
+             * fills the distance, interface and next hop of the route to 
+             * dest, the next hop is Any if there is no route. Returns 
+             * true if events can be sent to dest now, which is also the 
+             * case without a route when the protocol discovers it on demand.
+             */
+            bool getRoute(Ipv4Address dest, RouteInfo &route);
+            void SetRoutingInfo(Ptr<RoutingInfo> info);
+            /* true if RoutesChanged fires when the routes change */
+            bool ReportsRouteChanges(void) const;
             
         private:
+            void RoutesChanged (void);
 
-            Ptr<olsr::RoutingProtocol> olsr_routing_protocol;
+            Ptr<RoutingInfo> routing;
+            /* 
+             * fired when the routing protocol changed its routes, not 
+             * every protocol tells, see Ipv4RoutingInfo
+             */
+            TracedCallback<> routesChanged;
 
     };
 }
@@ -2,6 +2,31 @@
 
 // Include a header file from your module to test.
 #include "ns3/dcep.h"
+#include "ns3/event-type.h"
+#include "ns3/cep-engine.h"
+#include "ns3/common.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/message-types.h"
+#include "ns3/placement.h"
+#include "ns3/dcep-state.h"
+#include "ns3/query-compiler.h"
+#include "ns3/resource-manager.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/olsr-helper.h"
+#include "ns3/communication.h"
+#include "ns3/dcep-header.h"
+#include "ns3/seq-ts-header.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/data-rate.h"
+#include "ns3/error-model.h"
+#include "ns3/pointer.h"
+#include "ns3/string.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -46,6 +71,2378 @@ DcepTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// Event types are interned once and then handled by id only
+class EventTypeTableTestCase : public TestCase
+{
+public:
+  EventTypeTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+EventTypeTableTestCase::EventTypeTableTestCase ()
+  : TestCase ("Event type names are interned into stable ids")
+{
+}
+
+void
+EventTypeTableTestCase::DoRun (void)
+{
+  EventTypeId a = EventTypeTable::Intern ("A");
+  EventTypeId b = EventTypeTable::Intern ("B");
+
+  NS_TEST_ASSERT_MSG_NE (a, b, "distinct names must get distinct ids");
+  NS_TEST_ASSERT_MSG_EQ (EventTypeTable::Intern ("A"), a, "interning twice must return the same id");
+  NS_TEST_ASSERT_MSG_EQ (EventTypeTable::Intern (""), NO_EVENT_TYPE, "the empty type is reserved");
+  NS_TEST_ASSERT_MSG_EQ (EventTypeTable::GetName (b), "B", "names must resolve back");
+}
+
+// Released events are recycled by the next allocation
+class EventFreeListTestCase : public TestCase
+{
+public:
+  EventFreeListTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+EventFreeListTestCase::EventFreeListTestCase ()
+  : TestCase ("Released events are recycled through a bounded free list")
+{
+}
+
+void
+EventFreeListTestCase::DoRun (void)
+{
+  Ptr<Event> e = Create<Event> ();
+  Event *released = PeekPointer (e);
+  uint32_t before = Event::GetFreeListSize ();
+  e = 0;
+  NS_TEST_ASSERT_MSG_EQ (Event::GetFreeListSize (), before + 1, "the released event is kept");
+  e = Create<Event> ();
+  NS_TEST_ASSERT_MSG_EQ (PeekPointer (e), released, "the next allocation reuses it");
+  NS_TEST_ASSERT_MSG_EQ (Event::GetFreeListSize (), before, "and takes it off the list");
+
+  std::vector<Ptr<Event> > events;
+  for (uint32_t i = 0; i < Event::FREE_LIST_CAPACITY + 10; i++)
+    {
+      events.push_back (Create<Event> ());
+    }
+  events.clear ();
+  NS_TEST_ASSERT_MSG_EQ (Event::GetFreeListSize (), Event::FREE_LIST_CAPACITY,
+                         "the events beyond the capacity are freed");
+}
+
+// The and operator joins its two input streams on the sequence number
+class AndOperatorJoinTestCase : public TestCase
+{
+public:
+  AndOperatorJoinTestCase ();
+
+private:
+  virtual void DoRun (void);
+  Ptr<Event> MakeEvent (EventTypeId type, uint64_t seq);
+};
+
+AndOperatorJoinTestCase::AndOperatorJoinTestCase ()
+  : TestCase ("And operator matches events with equal sequence numbers")
+{
+}
+
+Ptr<Event>
+AndOperatorJoinTestCase::MakeEvent (EventTypeId type, uint64_t seq)
+{
+  Ptr<Event> e = Create<Event> ();
+  e->type = type;
+  e->m_seq = seq;
+  e->delay = 0;
+  e->hopsCount = 0;
+  e->prevHopsCount = 0;
+  e->event_class = ATOMIC_EVENT;
+  return e;
+}
+
+void
+AndOperatorJoinTestCase::DoRun (void)
+{
+  Ptr<Query> q = CreateObject<Query> ();
+  q->id = 1;
+  q->op = "and";
+  q->inevent1 = EventTypeTable::Intern ("A");
+  q->inevent2 = EventTypeTable::Intern ("B");
+
+  Ptr<AndOperator> op = CreateObject<AndOperator> ();
+  op->Configure (q);
+
+  std::vector<Ptr<Event> > returned;
+  NS_TEST_ASSERT_MSG_EQ (op->Evaluate (MakeEvent (q->inevent1, 1), returned), false, "nothing to join with yet");
+  NS_TEST_ASSERT_MSG_EQ (op->Evaluate (MakeEvent (q->inevent1, 2), returned), false, "nothing to join with yet");
+  NS_TEST_ASSERT_MSG_EQ (op->Evaluate (MakeEvent (q->inevent2, 2), returned), true, "out of order arrival must match");
+  NS_TEST_ASSERT_MSG_EQ (returned.size (), 2, "a match returns both constituent events");
+  NS_TEST_ASSERT_MSG_EQ (returned[1]->m_seq, 2, "the matched partner has the same sequence number");
+
+  returned.clear ();
+  NS_TEST_ASSERT_MSG_EQ (op->Evaluate (MakeEvent (q->inevent2, 2), returned), false, "a consumed event must not match twice");
+  NS_TEST_ASSERT_MSG_EQ (op->Evaluate (MakeEvent (q->inevent2, 1), returned), true, "the first buffered event is still there");
+}
+
+// Windows evict events by count or as simulation time advances
+class WindowTestCase : public TestCase
+{
+public:
+  WindowTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Evicted (Ptr<Event> e);
+  void Insert (Ptr<Window> w);
+  uint32_t m_evicted;
+};
+
+WindowTestCase::WindowTestCase ()
+  : TestCase ("Sliding and tumbling windows bound the buffered events"),
+    m_evicted (0)
+{
+}
+
+void
+WindowTestCase::Evicted (Ptr<Event> e)
+{
+  m_evicted++;
+}
+
+void
+WindowTestCase::Insert (Ptr<Window> w)
+{
+  w->Insert (Create<Event> ());
+}
+
+void
+WindowTestCase::DoRun (void)
+{
+  Ptr<Window> sliding = CreateObject<Window> ();
+  sliding->Configure (COUNT_WINDOW, SLIDING_WINDOW, Seconds (0), 2);
+  sliding->SetEvictCallback (MakeCallback (&WindowTestCase::Evicted, this));
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      Insert (sliding);
+    }
+  NS_TEST_ASSERT_MSG_EQ (sliding->GetSize (), 2, "a sliding count window keeps the last events");
+  NS_TEST_ASSERT_MSG_EQ (m_evicted, 3, "older events must be evicted");
+
+  m_evicted = 0;
+  Ptr<Window> tumbling = CreateObject<Window> ();
+  tumbling->Configure (COUNT_WINDOW, TUMBLING_WINDOW, Seconds (0), 2);
+  tumbling->SetEvictCallback (MakeCallback (&WindowTestCase::Evicted, this));
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      Insert (tumbling);
+    }
+  NS_TEST_ASSERT_MSG_EQ (tumbling->GetSize (), 1, "a tumbling count window restarts when full");
+  NS_TEST_ASSERT_MSG_EQ (m_evicted, 4, "full windows are emptied at once");
+
+  m_evicted = 0;
+  Ptr<Window> timed = CreateObject<Window> ();
+  timed->Configure (TIME_WINDOW, SLIDING_WINDOW, Seconds (1), 0);
+  timed->SetEvictCallback (MakeCallback (&WindowTestCase::Evicted, this));
+  Simulator::Schedule (Seconds (0.0), &WindowTestCase::Insert, this, timed);
+  Simulator::Schedule (Seconds (0.5), &WindowTestCase::Insert, this, timed);
+  Simulator::Schedule (Seconds (2.0), &WindowTestCase::Insert, this, timed);
+  Simulator::Stop (Seconds (2.2));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (timed->GetSize (), 1, "a time window only keeps recent events");
+  NS_TEST_ASSERT_MSG_EQ (m_evicted, 2, "events expire with simulation time");
+  Simulator::Destroy ();
+}
+
+// Sequence and Kleene plus patterns are matched in arrival order
+class PatternOperatorTestCase : public TestCase
+{
+public:
+  PatternOperatorTestCase ();
+
+private:
+  virtual void DoRun (void);
+  Ptr<Event> MakeEvent (EventTypeId type, uint64_t seq);
+};
+
+PatternOperatorTestCase::PatternOperatorTestCase ()
+  : TestCase ("Seq and kleene operators match ordered patterns")
+{
+}
+
+Ptr<Event>
+PatternOperatorTestCase::MakeEvent (EventTypeId type, uint64_t seq)
+{
+  Ptr<Event> e = Create<Event> ();
+  e->type = type;
+  e->m_seq = seq;
+  return e;
+}
+
+void
+PatternOperatorTestCase::DoRun (void)
+{
+  EventTypeId a = EventTypeTable::Intern ("A");
+  EventTypeId b = EventTypeTable::Intern ("B");
+  EventTypeId c = EventTypeTable::Intern ("C");
+
+  Ptr<Query> q = CreateObject<Query> ();
+  q->id = 1;
+  q->op = "seq";
+  q->inevents.push_back (a);
+  q->inevents.push_back (b);
+  q->inevents.push_back (c);
+
+  Ptr<SeqOperator> seq = CreateObject<SeqOperator> ();
+  seq->Configure (q);
+  NS_TEST_ASSERT_MSG_EQ (seq->ExpectingEvent (c), true, "every type of the pattern is expected");
+
+  std::vector<Ptr<Event> > returned;
+  NS_TEST_ASSERT_MSG_EQ (seq->Evaluate (MakeEvent (b, 1), returned), false, "B before any A is ignored");
+  NS_TEST_ASSERT_MSG_EQ (seq->Evaluate (MakeEvent (c, 2), returned), false, "C before any A is ignored");
+  NS_TEST_ASSERT_MSG_EQ (seq->Evaluate (MakeEvent (a, 3), returned), false, "");
+  NS_TEST_ASSERT_MSG_EQ (seq->Evaluate (MakeEvent (a, 4), returned), false, "");
+  NS_TEST_ASSERT_MSG_EQ (seq->Evaluate (MakeEvent (b, 5), returned), false, "");
+  NS_TEST_ASSERT_MSG_EQ (seq->Evaluate (MakeEvent (c, 6), returned), true, "A B C completes the sequence");
+  NS_TEST_ASSERT_MSG_EQ (returned.size (), 3, "");
+  NS_TEST_ASSERT_MSG_EQ (returned[0]->m_seq, 3, "the oldest run completes first");
+  NS_TEST_ASSERT_MSG_EQ (returned[2]->m_seq, 6, "");
+
+  q = CreateObject<Query> ();
+  q->id = 2;
+  q->op = "kleene";
+  q->inevent1 = a;
+  q->inevent2 = b;
+  q->window_type = COUNT_WINDOW;
+  q->window_count = 4;
+
+  Ptr<KleeneOperator> kleene = CreateObject<KleeneOperator> ();
+  kleene->Configure (q);
+
+  returned.clear ();
+  NS_TEST_ASSERT_MSG_EQ (kleene->Evaluate (MakeEvent (a, 1), returned), false, "");
+  NS_TEST_ASSERT_MSG_EQ (kleene->Evaluate (MakeEvent (a, 2), returned), false, "");
+  NS_TEST_ASSERT_MSG_EQ (kleene->Evaluate (MakeEvent (a, 3), returned), false, "");
+  NS_TEST_ASSERT_MSG_EQ (kleene->Evaluate (MakeEvent (b, 4), returned), true, "A+ B");
+  NS_TEST_ASSERT_MSG_EQ (returned.size (), 4, "all the A events are part of the match");
+
+  returned.clear ();
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      kleene->Evaluate (MakeEvent (a, 10 + i), returned);
+    }
+  NS_TEST_ASSERT_MSG_EQ (kleene->Evaluate (MakeEvent (b, 20), returned), false, "the run grew out of the count window");
+}
+
+// Aggregates follow the content of the window as events come and go
+class AggregateOperatorTestCase : public TestCase
+{
+public:
+  AggregateOperatorTestCase ();
+
+private:
+  virtual void DoRun (void);
+  Ptr<AggregateOperator> MakeOperator (std::string function, uint32_t count, double threshold,
+                                       window_type type = COUNT_WINDOW);
+  bool Feed (Ptr<AggregateOperator> op, double value);
+};
+
+AggregateOperatorTestCase::AggregateOperatorTestCase ()
+  : TestCase ("Aggregation operators maintain windowed aggregates incrementally")
+{
+}
+
+Ptr<AggregateOperator>
+AggregateOperatorTestCase::MakeOperator (std::string function, uint32_t count, double threshold,
+                                         window_type type)
+{
+  Ptr<Query> q = CreateObject<Query> ();
+  q->id = 1;
+  q->op = function;
+  q->inevent1 = EventTypeTable::Intern ("A");
+  q->window_type = type;
+  q->window_count = count;
+  q->threshold = threshold;
+
+  Ptr<AggregateOperator> op = CreateObject<AggregateOperator> ();
+  op->Configure (q);
+  return op;
+}
+
+bool
+AggregateOperatorTestCase::Feed (Ptr<AggregateOperator> op, double value)
+{
+  Ptr<Event> e = Create<Event> ();
+  e->type = EventTypeTable::Intern ("A");
+  e->value = value;
+  std::vector<Ptr<Event> > returned;
+  return op->Evaluate (e, returned);
+}
+
+void
+AggregateOperatorTestCase::DoRun (void)
+{
+  Ptr<AggregateOperator> avg = MakeOperator ("avg", 3, 1000);
+  Feed (avg, 3);
+  Feed (avg, 6);
+  Feed (avg, 9);
+  NS_TEST_ASSERT_MSG_EQ_TOL (avg->GetValue (), 6, 1e-9, "average of a full window");
+  Feed (avg, 12);
+  NS_TEST_ASSERT_MSG_EQ (avg->GetCount (), 3, "the oldest value was evicted");
+  NS_TEST_ASSERT_MSG_EQ_TOL (avg->GetValue (), 9, 1e-9, "the evicted value is subtracted");
+
+  Ptr<AggregateOperator> max = MakeOperator ("max", 3, 1000);
+  double values[] = {5, 1, 4, 2, 3, 0};
+  double expected[] = {5, 5, 5, 4, 4, 3};
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      Feed (max, values[i]);
+      NS_TEST_ASSERT_MSG_EQ_TOL (max->GetValue (), expected[i], 1e-9, "sliding max");
+    }
+
+  Ptr<AggregateOperator> min = MakeOperator ("min", 2, 1000);
+  Feed (min, 1);
+  Feed (min, 7);
+  Feed (min, 8);
+  NS_TEST_ASSERT_MSG_EQ_TOL (min->GetValue (), 7, 1e-9, "sliding min");
+
+  Ptr<AggregateOperator> sum = MakeOperator ("sum", 2, 10);
+  NS_TEST_ASSERT_MSG_EQ (Feed (sum, 4), false, "below the threshold");
+  NS_TEST_ASSERT_MSG_EQ (Feed (sum, 7), true, "rising above the threshold reports");
+  NS_TEST_ASSERT_MSG_EQ (Feed (sum, 5), false, "still above, no new report");
+  NS_TEST_ASSERT_MSG_EQ (Feed (sum, 1), false, "back below");
+  NS_TEST_ASSERT_MSG_EQ (Feed (sum, 20), true, "above again");
+
+  Ptr<AggregateOperator> unbounded = MakeOperator ("max", 0, 1000, NO_WINDOW);
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      Feed (unbounded, values[i]);
+    }
+  NS_TEST_ASSERT_MSG_EQ_TOL (unbounded->GetValue (), 5, 1e-9, "running max without a window");
+  NS_TEST_ASSERT_MSG_EQ (unbounded->GetBufferedEvents (), 0, "no events are buffered without a window");
+}
+
+// Compiled filters check the attributes of the events of their types only
+class EventFilterTestCase : public TestCase
+{
+public:
+  EventFilterTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+EventFilterTestCase::EventFilterTestCase ()
+  : TestCase ("Compiled filters accept the events satisfying all their terms")
+{
+}
+
+void
+EventFilterTestCase::DoRun (void)
+{
+  Ptr<EventFilter> filter = EventFilter::Compile ("A.temp > 30 && A.zone == 4&&B.value<=-1.5");
+  NS_TEST_ASSERT_MSG_EQ (filter->GetSize (), 3, "one term per comparison");
+
+  Ptr<Event> a = Create<Event> ();
+  a->type = EventTypeTable::Intern ("A");
+  a->SetAttribute ("temp", 35);
+  a->SetAttribute ("zone", 4);
+  NS_TEST_ASSERT_MSG_EQ (filter->Accept (a), true, "all the terms hold");
+  a->SetAttribute ("zone", 3);
+  NS_TEST_ASSERT_MSG_EQ (filter->Accept (a), false, "one term fails");
+
+  Ptr<Event> b = Create<Event> ();
+  b->type = EventTypeTable::Intern ("B");
+  b->value = -2;
+  NS_TEST_ASSERT_MSG_EQ (filter->Accept (b), true, "value term");
+  b->value = 0;
+  NS_TEST_ASSERT_MSG_EQ (filter->Accept (b), false, "value term fails");
+
+  Ptr<Event> c = Create<Event> ();
+  c->type = EventTypeTable::Intern ("C");
+  NS_TEST_ASSERT_MSG_EQ (filter->Accept (c), true, "no term on this type");
+
+  /* the attributes travel with the event */
+  a->SetAttribute ("zone", 4);
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (a->serialize ());
+  SerializedEvent message;
+  p->RemoveHeader (message);
+  Ptr<Event> ra = Create<Event> ();
+  ra->deserialize (message);
+  NS_TEST_ASSERT_MSG_EQ (filter->Accept (ra), true, "deserialized attributes");
+  double temp = 0;
+  NS_TEST_ASSERT_MSG_EQ (ra->GetAttribute ("temp", temp), true, "known attribute");
+  NS_TEST_ASSERT_MSG_EQ_TOL (temp, 35, 1e-9, "");
+
+  /* reading an unknown attribute leaves the schema alone */
+  uint32_t count = EventTypeTable::GetAttributeCount (ra->type);
+  NS_TEST_ASSERT_MSG_EQ (ra->GetAttribute ("humidity", temp), false, "unknown attribute");
+  NS_TEST_ASSERT_MSG_EQ (EventTypeTable::GetAttributeCount (ra->type), count, "schema unchanged");
+}
+
+// Queries with the same sub-pattern share one operator
+class OperatorSharingTestCase : public TestCase
+{
+public:
+  OperatorSharingTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Produced (Ptr<Event> e);
+  Ptr<Query> MakeQuery (uint32_t id, std::string output);
+
+  std::vector<EventTypeId> m_produced;
+};
+
+OperatorSharingTestCase::OperatorSharingTestCase ()
+  : TestCase ("Identical operators are shared and their matches fanned out")
+{
+}
+
+void
+OperatorSharingTestCase::Produced (Ptr<Event> e)
+{
+  m_produced.push_back (e->type);
+}
+
+Ptr<Query>
+OperatorSharingTestCase::MakeQuery (uint32_t id, std::string output)
+{
+  Ptr<Query> q = CreateObject<Query> ();
+  q->id = id;
+  q->actionType = NOTIFICATION;
+  q->isAtomic = false;
+  q->isFinal = false;
+  q->op = "and";
+  q->eventType = EventTypeTable::Intern (output);
+  q->inevent1 = EventTypeTable::Intern ("A");
+  q->inevent2 = EventTypeTable::Intern ("B");
+  return q;
+}
+
+void
+OperatorSharingTestCase::DoRun (void)
+{
+  Ptr<CEPEngine> cep = CreateObject<CEPEngine> ();
+  cep->GetObject<Forwarder> ()->TraceConnectWithoutContext ("new event",
+      MakeCallback (&OperatorSharingTestCase::Produced, this));
+
+  cep->RecvQuery (MakeQuery (1, "X"));
+  cep->RecvQuery (MakeQuery (2, "Y"));
+  Ptr<Query> filtered = MakeQuery (3, "Z");
+  filtered->filter = "A.value > 50";
+  cep->RecvQuery (filtered);
+
+  EventTypeId a = EventTypeTable::Intern ("A");
+  NS_TEST_ASSERT_MSG_EQ (cep->GetOpsByInputEventType (a).size (), 2, "the first two queries share an operator");
+
+  Ptr<Event> e = Create<Event> ();
+  e->type = a;
+  e->m_seq = 1;
+  cep->ProcessCepEvent (e);
+  e = Create<Event> ();
+  e->type = EventTypeTable::Intern ("B");
+  e->m_seq = 1;
+  cep->ProcessCepEvent (e);
+
+  NS_TEST_ASSERT_MSG_EQ (m_produced.size (), 2, "one event per sharing query, the filtered query rejected A");
+  NS_TEST_ASSERT_MSG_EQ (m_produced[0], EventTypeTable::Intern ("X"), "");
+  NS_TEST_ASSERT_MSG_EQ (m_produced[1], EventTypeTable::Intern ("Y"), "");
+  cep->Dispose ();
+}
+
+// Events are dispatched only to the operators subscribed to their type
+class SubscriptionIndexTestCase : public TestCase
+{
+public:
+  SubscriptionIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Produced (Ptr<Event> e);
+  void Process (Ptr<CEPEngine> cep, std::string type);
+
+  std::vector<EventTypeId> m_produced;
+};
+
+SubscriptionIndexTestCase::SubscriptionIndexTestCase ()
+  : TestCase ("The subscription index follows added and removed queries")
+{
+}
+
+void
+SubscriptionIndexTestCase::Produced (Ptr<Event> e)
+{
+  m_produced.push_back (e->type);
+}
+
+void
+SubscriptionIndexTestCase::Process (Ptr<CEPEngine> cep, std::string type)
+{
+  Ptr<Event> e = Create<Event> ();
+  e->type = EventTypeTable::Intern (type);
+  e->m_seq = 1;
+  cep->ProcessCepEvent (e);
+}
+
+void
+SubscriptionIndexTestCase::DoRun (void)
+{
+  Ptr<CEPEngine> cep = CreateObject<CEPEngine> ();
+  cep->GetObject<Forwarder> ()->TraceConnectWithoutContext ("new event",
+      MakeCallback (&SubscriptionIndexTestCase::Produced, this));
+
+  Ptr<Query> q = CreateObject<Query> ();
+  q->id = 1;
+  q->actionType = NOTIFICATION;
+  q->isAtomic = false;
+  q->isFinal = false;
+  q->op = "or";
+  q->eventType = EventTypeTable::Intern ("AorC");
+  q->inevent1 = EventTypeTable::Intern ("A");
+  q->inevent2 = EventTypeTable::Intern ("C");
+  cep->RecvQuery (q);
+
+  NS_TEST_ASSERT_MSG_EQ (cep->GetOpsByInputEventType (q->inevent1).size (), 1, "subscribed to its first input");
+  NS_TEST_ASSERT_MSG_EQ (cep->GetOpsByInputEventType (q->inevent2).size (), 1, "subscribed to its second input");
+  NS_TEST_ASSERT_MSG_EQ (cep->GetOpsByInputEventType (EventTypeTable::Intern ("B")).size (), 0,
+                         "not subscribed to other types");
+  NS_TEST_ASSERT_MSG_EQ (cep->GetOpsByInputEventType (EventTypeTable::Intern ("NeverSeenType")).size (), 0,
+                         "types interned after the query have no subscribers");
+
+  Process (cep, "B");
+  NS_TEST_ASSERT_MSG_EQ (m_produced.size (), 0, "an event nobody subscribed to is ignored");
+  Process (cep, "C");
+  NS_TEST_ASSERT_MSG_EQ (m_produced.size (), 1, "a subscribed input reaches the operator");
+
+  std::vector<Ptr<Event> > state;
+  cep->RemoveQuery (q, state);
+  NS_TEST_ASSERT_MSG_EQ (cep->GetOpsByInputEventType (q->inevent1).size (), 0, "unsubscribed on removal");
+  Process (cep, "A");
+  NS_TEST_ASSERT_MSG_EQ (m_produced.size (), 1, "nothing is dispatched after removal");
+  cep->Dispose ();
+}
+
+// Events wait for the CPU of the node when operators have a cost
+class ProcessingTimeTestCase : public TestCase
+{
+public:
+  ProcessingTimeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Produced (Ptr<Event> e);
+  void Process (Ptr<CEPEngine> cep, std::string type, uint64_t seq);
+  void Dropped (uint32_t oldValue, uint32_t newValue);
+
+  uint32_t m_drops;
+  std::vector<Time> m_producedAt;
+  std::vector<uint64_t> m_delays;
+};
+
+ProcessingTimeTestCase::ProcessingTimeTestCase ()
+  : TestCase ("Operators take CPU time and the execution queue is bounded"),
+    m_drops (0)
+{
+}
+
+void
+ProcessingTimeTestCase::Dropped (uint32_t oldValue, uint32_t newValue)
+{
+  m_drops = newValue;
+}
+
+void
+ProcessingTimeTestCase::Produced (Ptr<Event> e)
+{
+  m_producedAt.push_back (Simulator::Now ());
+  m_delays.push_back (e->delay);
+}
+
+void
+ProcessingTimeTestCase::Process (Ptr<CEPEngine> cep, std::string type, uint64_t seq)
+{
+  Ptr<Event> e = Create<Event> ();
+  e->type = EventTypeTable::Intern (type);
+  e->m_seq = seq;
+  cep->ProcessCepEvent (e);
+}
+
+void
+ProcessingTimeTestCase::DoRun (void)
+{
+  Ptr<Query> q = CreateObject<Query> ();
+  q->id = 1;
+  q->actionType = NOTIFICATION;
+  q->isAtomic = false;
+  q->isFinal = false;
+  q->op = "and";
+  q->eventType = EventTypeTable::Intern ("AandB");
+  q->inevent1 = EventTypeTable::Intern ("A");
+  q->inevent2 = EventTypeTable::Intern ("B");
+
+  Ptr<CEPEngine> cep = CreateObject<CEPEngine> ();
+  cep->SetAttribute ("OperatorCost", TimeValue (MilliSeconds (2)));
+  cep->SetAttribute ("BufferedEventCost", TimeValue (MilliSeconds (1)));
+  cep->SetAttribute ("ExecutionQueueCapacity", UintegerValue (1));
+  cep->GetObject<Forwarder> ()->TraceConnectWithoutContext ("new event",
+      MakeCallback (&ProcessingTimeTestCase::Produced, this));
+  cep->TraceConnectWithoutContext ("CpuDrops",
+      MakeCallback (&ProcessingTimeTestCase::Dropped, this));
+  cep->RecvQuery (q);
+
+  /* A is served at once, B waits for it and the second A finds the queue full */
+  Process (cep, "A", 1);
+  Process (cep, "B", 1);
+  Process (cep, "A", 2);
+  NS_TEST_ASSERT_MSG_EQ (m_drops, 1, "one event dropped");
+  NS_TEST_ASSERT_MSG_EQ (m_producedAt.size (), 0, "nothing is detected before the CPU is done");
+
+  Simulator::Run ();
+  /* 2ms for A, then 2ms plus 1ms for the buffered A for B */
+  NS_TEST_ASSERT_MSG_EQ (m_producedAt.size (), 1, "the match is detected");
+  NS_TEST_ASSERT_MSG_EQ (m_producedAt[0], MilliSeconds (5), "after both services");
+  NS_TEST_ASSERT_MSG_EQ (m_delays[0], 5000, "the waiting time is part of the delay");
+
+  /* only the inputs of the removed query are handed over */
+  cep->SetAttribute ("ExecutionQueueCapacity", UintegerValue (0));
+  Process (cep, "A", 3);
+  Process (cep, "C", 1);
+  Process (cep, "B", 3);
+  std::vector<Ptr<Event> > state;
+  cep->RemoveQuery (q, state);
+  std::vector<EventTypeId> inputs;
+  inputs.push_back (EventTypeTable::Intern ("A"));
+  std::vector<Ptr<Event> > orphaned;
+  cep->TakeOrphanedEvents (inputs, orphaned);
+  NS_TEST_ASSERT_MSG_EQ (orphaned.size (), 1, "only the input of the given type");
+  NS_TEST_ASSERT_MSG_EQ (orphaned[0]->type, EventTypeTable::Intern ("A"), "the event in service");
+  inputs.push_back (EventTypeTable::Intern ("B"));
+  cep->TakeOrphanedEvents (inputs, orphaned);
+  NS_TEST_ASSERT_MSG_EQ (orphaned.size (), 2, "the queued input follows");
+  NS_TEST_ASSERT_MSG_EQ (orphaned[1]->type, EventTypeTable::Intern ("B"), "in arrival order");
+  Simulator::Run ();
+
+  cep->Dispose ();
+  Simulator::Destroy ();
+}
+
+// Queries and events survive a round trip through a packet
+class WireFormatTestCase : public TestCase
+{
+public:
+  WireFormatTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WireFormatTestCase::WireFormatTestCase ()
+  : TestCase ("Query and event messages are written into and read from packets")
+{
+}
+
+void
+WireFormatTestCase::DoRun (void)
+{
+  Ptr<Query> q = CreateObject<Query> ();
+  q->id = 7;
+  q->actionType = NOTIFICATION;
+  q->eventType = EventTypeTable::Intern ("AandB");
+  q->inevent1 = EventTypeTable::Intern ("A");
+  q->inevent2 = EventTypeTable::Intern ("B");
+  q->op = "and";
+  q->isAtomic = false;
+  q->isFinal = true;
+  q->assigned = false;
+  q->output_dest = Ipv4Address ("10.0.0.1");
+  q->window_type = TIME_WINDOW;
+  q->window_length = Seconds (5);
+  q->inevents.push_back (q->inevent2);
+  q->other_parent_outputs.push_back (EventTypeTable::Intern ("AorB"));
+  q->other_output_dests.push_back (Ipv4Address ("10.0.0.2"));
+
+  SerializedQuery qmsg = q->serialize ();
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (qmsg);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), qmsg.GetSerializedSize (), "the query is written in place");
+
+  SerializedQuery rqmsg;
+  p->RemoveHeader (rqmsg);
+  Ptr<Query> rq = CreateObject<Query> ();
+  rq->deserialize (rqmsg);
+  NS_TEST_ASSERT_MSG_EQ (rq->id, 7, "query id");
+  NS_TEST_ASSERT_MSG_EQ (rq->eventType, q->eventType, "output type");
+  NS_TEST_ASSERT_MSG_EQ (rq->inevent2, q->inevent2, "second input type");
+  NS_TEST_ASSERT_MSG_EQ (rq->op, "and", "operator");
+  NS_TEST_ASSERT_MSG_EQ (rq->isFinal, true, "final flag");
+  NS_TEST_ASSERT_MSG_EQ (rq->output_dest, Ipv4Address ("10.0.0.1"), "output destination");
+  NS_TEST_ASSERT_MSG_EQ (rq->window_length, Seconds (5), "window length");
+  NS_TEST_ASSERT_MSG_EQ (rq->inevents.size (), 1, "n-ary operator inputs");
+  NS_TEST_ASSERT_MSG_EQ (rq->other_parent_outputs.size (), 1, "other readers");
+  NS_TEST_ASSERT_MSG_EQ (rq->other_parent_outputs[0], EventTypeTable::Intern ("AorB"), "");
+  NS_TEST_ASSERT_MSG_EQ (rq->other_output_dests.size (), 1, "and their hosts");
+  NS_TEST_ASSERT_MSG_EQ (rq->other_output_dests[0], Ipv4Address ("10.0.0.2"), "");
+
+  Ptr<Event> e = Create<Event> ();
+  e->type = q->inevent1;
+  e->m_seq = 42;
+  e->hopsCount = 3;
+  e->event_class = COMPOSITE_EVENT;
+  p = Create<Packet> ();
+  p->AddHeader (e->serialize ());
+  SerializedEvent emsg;
+  p->RemoveHeader (emsg);
+  Ptr<Event> re = Create<Event> ();
+  re->deserialize (emsg);
+  NS_TEST_ASSERT_MSG_EQ (re->type, e->type, "event type");
+  NS_TEST_ASSERT_MSG_EQ (re->m_seq, 42, "sequence number");
+  NS_TEST_ASSERT_MSG_EQ (re->hopsCount, 3, "hops count");
+  NS_TEST_ASSERT_MSG_EQ (re->event_class, COMPOSITE_EVENT, "event class");
+}
+
+// The state of a migrated operator is rebuilt on its new host
+class OperatorMigrationTestCase : public TestCase
+{
+public:
+  OperatorMigrationTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Produced (Ptr<Event> e);
+  Ptr<Event> MakeEvent (std::string type, uint64_t seq);
+
+  std::vector<EventTypeId> m_produced;
+};
+
+OperatorMigrationTestCase::OperatorMigrationTestCase ()
+  : TestCase ("Operators are moved between engines with their buffered events")
+{
+}
+
+void
+OperatorMigrationTestCase::Produced (Ptr<Event> e)
+{
+  m_produced.push_back (e->type);
+}
+
+Ptr<Event>
+OperatorMigrationTestCase::MakeEvent (std::string type, uint64_t seq)
+{
+  Ptr<Event> e = Create<Event> ();
+  e->type = EventTypeTable::Intern (type);
+  e->m_seq = seq;
+  e->event_class = ATOMIC_EVENT;
+  return e;
+}
+
+void
+OperatorMigrationTestCase::DoRun (void)
+{
+  Ptr<Query> q = CreateObject<Query> ();
+  q->id = 1;
+  q->actionType = NOTIFICATION;
+  q->isAtomic = false;
+  q->isFinal = false;
+  q->op = "seq";
+  q->eventType = EventTypeTable::Intern ("AthenBthenC");
+  q->inevents.push_back (EventTypeTable::Intern ("A"));
+  q->inevents.push_back (EventTypeTable::Intern ("B"));
+  q->inevents.push_back (EventTypeTable::Intern ("C"));
+
+  Ptr<CEPEngine> from = CreateObject<CEPEngine> ();
+  from->RecvQuery (q);
+  from->ProcessCepEvent (MakeEvent ("A", 1));
+  from->ProcessCepEvent (MakeEvent ("A", 2));
+  from->ProcessCepEvent (MakeEvent ("B", 3));
+
+  std::vector<Ptr<Event> > state;
+  from->RemoveQuery (q, state);
+  NS_TEST_ASSERT_MSG_EQ (state.size (), 3, "the events of both runs are exported");
+  NS_TEST_ASSERT_MSG_EQ (from->GetOpsByInputEventType (EventTypeTable::Intern ("A")).size (), 0,
+                         "the operator is detached");
+
+  /* the state travels in a migration message */
+  SerializedMigration message;
+  message.eventType = q->eventType;
+  message.host = Ipv4Address ("10.0.0.9");
+  message.event_count = state.size ();
+  for (uint32_t i = 0; i < state.size (); i++)
+    {
+      message.arrivals.push_back (state[i]->arrival + Seconds (i));
+    }
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (message);
+  SerializedMigration rmessage;
+  p->RemoveHeader (rmessage);
+  NS_TEST_ASSERT_MSG_EQ (rmessage.eventType, q->eventType, "operator");
+  NS_TEST_ASSERT_MSG_EQ (rmessage.stream, NO_EVENT_TYPE, "no stream");
+  NS_TEST_ASSERT_MSG_EQ (rmessage.host, Ipv4Address ("10.0.0.9"), "new host");
+  NS_TEST_ASSERT_MSG_EQ (rmessage.event_count, 3, "event count");
+  NS_TEST_ASSERT_MSG_EQ (rmessage.arrivals.size (), 3, "one arrival time per event");
+  NS_TEST_ASSERT_MSG_EQ (rmessage.arrivals[2], Seconds (2), "arrival time");
+
+  Ptr<CEPEngine> to = CreateObject<CEPEngine> ();
+  to->GetObject<Forwarder> ()->TraceConnectWithoutContext ("new event",
+      MakeCallback (&OperatorMigrationTestCase::Produced, this));
+  to->RecvQuery (q);
+  to->RestoreState (q, state);
+  NS_TEST_ASSERT_MSG_EQ (m_produced.size (), 0, "restoring reports nothing");
+
+  /* the older run A1 B3 completes first, A2 is still waiting for a B */
+  to->ProcessCepEvent (MakeEvent ("C", 4));
+  NS_TEST_ASSERT_MSG_EQ (m_produced.size (), 1, "the restored run completes");
+  to->ProcessCepEvent (MakeEvent ("C", 5));
+  NS_TEST_ASSERT_MSG_EQ (m_produced.size (), 1, "the other run still needs a B");
+  to->ProcessCepEvent (MakeEvent ("B", 6));
+  to->ProcessCepEvent (MakeEvent ("C", 7));
+  NS_TEST_ASSERT_MSG_EQ (m_produced.size (), 2, "and completes after one");
+
+  from->Dispose ();
+  to->Dispose ();
+
+  /* restored events leave a time window when they would have left the
+     exporting one, not a window length after the migration */
+  Ptr<Query> aq = CreateObject<Query> ();
+  aq->op = "count";
+  aq->inevent1 = EventTypeTable::Intern ("A");
+  aq->window_type = TIME_WINDOW;
+  aq->window_length = Seconds (10);
+  aq->threshold = 1000;
+  Ptr<AggregateOperator> exporter = CreateObject<AggregateOperator> ();
+  exporter->Configure (aq);
+  std::vector<Ptr<Event> > returned;
+  exporter->Evaluate (MakeEvent ("A", 1), returned);
+  exporter->Evaluate (MakeEvent ("A", 2), returned);
+
+  Simulator::Stop (Seconds (6));
+  Simulator::Run ();
+  std::vector<Ptr<Event> > window;
+  exporter->ExportState (window);
+  NS_TEST_ASSERT_MSG_EQ (window.size (), 2, "both events are in the window");
+  NS_TEST_ASSERT_MSG_EQ (window[0]->arrival, Seconds (0), "with the time they entered it");
+
+  Ptr<AggregateOperator> importer = CreateObject<AggregateOperator> ();
+  importer->Configure (aq);
+  importer->SetRestoring (true);
+  for (uint32_t i = 0; i < window.size (); i++)
+    {
+      importer->Evaluate (window[i], returned);
+    }
+  importer->SetRestoring (false);
+  importer->Evaluate (MakeEvent ("A", 3), returned);
+  NS_TEST_ASSERT_MSG_EQ (importer->GetCount (), 3, "restored");
+
+  Simulator::Stop (Seconds (5));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (importer->GetCount (), 1, "the restored events expired at 10 s");
+
+  exporter->Dispose ();
+  importer->Dispose ();
+  Simulator::Destroy ();
+}
+
+// Places queries only from a given time on, recording the placement passes
+class DelayedPlacementPolicy : public PlacementPolicy
+{
+public:
+  static TypeId GetTypeId (void);
+
+  virtual void configure (void) {}
+  virtual void DoPlacement (void)
+  {
+    passes.push_back (Simulator::Now ());
+    PlacePending ();
+  }
+  virtual bool doAdaptation (EventTypeId eType) { return false; }
+  virtual bool PlaceQuery (Ptr<Query> q) { return Simulator::Now () >= placeFrom; }
+  void PlaceLocally (EventTypeId eType) { newLocalPlacement (eType); }
+
+  Time placeFrom;
+  std::vector<Time> passes;
+};
+
+TypeId
+DelayedPlacementPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("DelayedPlacementPolicy")
+    .SetParent<PlacementPolicy> ()
+    .AddConstructor<DelayedPlacementPolicy> ()
+  ;
+  return tid;
+}
+
+// Pending queries are placed in batches with a single backed off retry
+class PlacementRetryTestCase : public TestCase
+{
+public:
+  PlacementRetryTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PlacementRetryTestCase::PlacementRetryTestCase ()
+  : TestCase ("Queries which cannot be placed are retried together with exponential backoff")
+{
+}
+
+void
+PlacementRetryTestCase::DoRun (void)
+{
+  Ptr<Placement> placement = CreateObject<Placement> ();
+  Ptr<DelayedPlacementPolicy> policy = CreateObject<DelayedPlacementPolicy> ();
+  policy->placeFrom = Seconds (20);
+  placement->AggregateObject (policy);
+
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Ptr<Query> q = CreateObject<Query> ();
+      q->id = i;
+      placement->RecvQuery (q);
+    }
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (policy->passes.size (), 4, "one pass per retry, not per query");
+  NS_TEST_ASSERT_MSG_EQ (policy->passes[0], Seconds (0), "first pass");
+  NS_TEST_ASSERT_MSG_EQ (policy->passes[1], Seconds (3), "first retry");
+  NS_TEST_ASSERT_MSG_EQ (policy->passes[2], Seconds (9), "the delay doubles");
+  NS_TEST_ASSERT_MSG_EQ (policy->passes[3], Seconds (21), "all placed");
+  Simulator::Destroy ();
+  placement->Dispose ();
+}
+
+// The routing table of a node is indexed by produced and consumed types
+class DcepStateTestCase : public TestCase
+{
+public:
+  DcepStateTestCase ();
+
+private:
+  virtual void DoRun (void);
+  Ptr<Query> MakeQuery (std::string output, std::string input1, std::string input2);
+  Ptr<Event> MakeEvent (std::string type);
+};
+
+DcepStateTestCase::DcepStateTestCase ()
+  : TestCase ("Routing entries are found by type and active operators expect their inputs")
+{
+}
+
+Ptr<Query>
+DcepStateTestCase::MakeQuery (std::string output, std::string input1, std::string input2)
+{
+  Ptr<Query> q = CreateObject<Query> ();
+  q->isAtomic = false;
+  q->isFinal = false;
+  q->eventType = EventTypeTable::Intern (output);
+  q->inevent1 = EventTypeTable::Intern (input1);
+  q->inevent2 = EventTypeTable::Intern (input2);
+  return q;
+}
+
+Ptr<Event>
+DcepStateTestCase::MakeEvent (std::string type)
+{
+  Ptr<Event> e = Create<Event> ();
+  e->type = EventTypeTable::Intern (type);
+  return e;
+}
+
+void
+DcepStateTestCase::DoRun (void)
+{
+  Ptr<DcepState> state = CreateObject<DcepState> ();
+  Ptr<DelayedPlacementPolicy> policy = CreateObject<DelayedPlacementPolicy> ();
+  state->AggregateObject (policy);
+  state->Configure ();
+
+  EventTypeId ab = EventTypeTable::Intern ("AB");
+  EventTypeId abc = EventTypeTable::Intern ("ABC");
+  state->CreateEventRoutingTableEntry (MakeQuery ("AB", "A", "B"));
+  state->CreateEventRoutingTableEntry (MakeQuery ("ABC", "AB", "C"));
+
+  NS_TEST_ASSERT_MSG_NE (state->GetEntry (ab), 0, "entry by produced type");
+  NS_TEST_ASSERT_MSG_EQ (state->GetEntry (ab)->source_query->eventType, ab, "the entry of its query");
+  NS_TEST_ASSERT_MSG_EQ (state->GetConsumers (EventTypeTable::Intern ("A")).size (), 1, "one consumer of A");
+  NS_TEST_ASSERT_MSG_EQ (state->GetConsumers (EventTypeTable::Intern ("A"))[0], state->GetEntry (ab), "AB consumes A");
+  NS_TEST_ASSERT_MSG_EQ (state->GetConsumers (ab)[0], state->GetEntry (abc), "ABC consumes AB");
+  NS_TEST_ASSERT_MSG_EQ (state->GetConsumers (abc).size (), 0, "nobody consumes ABC");
+  state->CreateEventRoutingTableEntry (MakeQuery ("AB", "A", "B"));
+  NS_TEST_ASSERT_MSG_EQ (state->GetConsumers (EventTypeTable::Intern ("A")).size (), 1, "placed again, not indexed twice");
+
+  /* the shared miss entry is never modified */
+  EventTypeId unknown = EventTypeTable::Intern ("Unknown");
+  NS_TEST_ASSERT_MSG_EQ (state->GetEntry (unknown), 0, "no entry");
+  state->SetNextHop (unknown, Ipv4Address ("10.0.0.1"));
+  state->SetState (unknown, ACTIVE);
+  NS_TEST_ASSERT_MSG_EQ (state->GetNextHop (unknown), Ipv4Address::GetAny (), "no next hop");
+  NS_TEST_ASSERT_MSG_EQ (state->GetState (unknown), UNDEFINED, "no state");
+  NS_TEST_ASSERT_MSG_EQ (state->IsActive (unknown), false, "not active");
+  NS_TEST_ASSERT_MSG_EQ (state->GetNextHop (EventTypeTable::Intern ("Other")), Ipv4Address::GetAny (),
+                         "other misses are not affected");
+
+  /* a local placement activates the operator, which then expects its inputs */
+  NS_TEST_ASSERT_MSG_EQ (state->IsExpected (MakeEvent ("A")), false, "no active consumer yet");
+  policy->PlaceLocally (ab);
+  NS_TEST_ASSERT_MSG_EQ (state->GetState (ab), ACTIVE, "activated by the local placement");
+  NS_TEST_ASSERT_MSG_EQ (state->IsActive (ab), true, "active");
+  NS_TEST_ASSERT_MSG_EQ (state->IsExpected (MakeEvent ("A")), true, "A is expected");
+  NS_TEST_ASSERT_MSG_EQ (state->IsExpected (MakeEvent ("AB")), false, "ABC is not active");
+
+  state->SetState (ab, ACTIVE);
+  state->SetState (ab, FREEZED);
+  NS_TEST_ASSERT_MSG_EQ (state->IsActive (ab), false, "frozen");
+  NS_TEST_ASSERT_MSG_EQ (state->IsExpected (MakeEvent ("B")), false, "counted once, released once");
+  state->SetState (ab, ACTIVE);
+  state->SetState (abc, ACTIVE);
+  NS_TEST_ASSERT_MSG_EQ (state->IsExpected (MakeEvent ("AB")), true, "ABC expects AB");
+  state->SetState (abc, DEACTIVATED);
+  NS_TEST_ASSERT_MSG_EQ (state->IsExpected (MakeEvent ("AB")), false, "no longer");
+  NS_TEST_ASSERT_MSG_EQ (state->IsExpected (MakeEvent ("A")), true, "AB still expects A");
+
+  Ptr<Query> atomic = MakeQuery ("D", "D", "D");
+  atomic->isAtomic = true;
+  state->CreateEventRoutingTableEntry (atomic);
+  state->SetState (atomic->eventType, ACTIVE);
+  NS_TEST_ASSERT_MSG_EQ (state->IsExpected (MakeEvent ("D")), false, "atomic operators expect nothing");
+}
+
+// Nodes on one simple channel, two by default, numbered from 10.1.1.1 and
+// routed by the given helper, static and global routing by default
+static NetDeviceContainer
+CreateLink (NodeContainer &nodes, const Ipv4RoutingHelper *routing = 0, uint32_t count = 2)
+{
+  nodes.Create (count);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < count; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      nodes.Get (i)->AddDevice (device);
+      devices.Add (device);
+    }
+
+  InternetStackHelper stack;
+  if (routing)
+    {
+      stack.SetRoutingHelper (*routing);
+    }
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  address.Assign (devices);
+  return devices;
+}
+
+// The communication layer of a dcep application that is never started,
+// final events it receives go to its sink
+static Ptr<Communication>
+CreateCommunication (Ptr<Node> node, std::string reliableMessages = "",
+                     Ptr<ResourceManager> resources = 0, Ipv4Address sinkAddress = Ipv4Address ())
+{
+  Ptr<Dcep> dcep = CreateObject<Dcep> ();
+  dcep->SetNode (node);
+  dcep->SetAttribute ("SinkAddress", Ipv4AddressValue (sinkAddress));
+  dcep->AggregateObject (CreateObject<Sink> ());
+  dcep->AggregateObject (CreateObject<Placement> ());
+  if (resources)
+    {
+      dcep->AggregateObject (resources);
+    }
+  Ptr<Communication> communication = CreateObject<Communication> ();
+  dcep->AggregateObject (communication);
+  communication->setNode (node);
+  communication->setPort (9);
+  communication->SetAttribute ("ReliableMessages", StringValue (reliableMessages));
+  communication->Configure ();
+  return communication;
+}
+
+// Routes are read from any ipv4 routing protocol, not only olsr
+class Ipv4RoutingInfoTestCase : public TestCase
+{
+public:
+  Ipv4RoutingInfoTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4RoutingInfoTestCase::Ipv4RoutingInfoTestCase ()
+  : TestCase ("Routes of static routing are seen through Ipv4RoutingInfo")
+{
+}
+
+void
+Ipv4RoutingInfoTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  CreateLink (nodes);
+
+  Ipv4StaticRoutingHelper staticRouting;
+  Ptr<Ipv4StaticRouting> routes = staticRouting.GetStaticRouting (nodes.Get (0)->GetObject<Ipv4> ());
+  routes->AddHostRouteTo (Ipv4Address ("10.2.0.9"), Ipv4Address ("10.1.1.2"), 1);
+  /* the metric counts the hops */
+  routes->AddHostRouteTo (Ipv4Address ("10.2.0.10"), Ipv4Address ("10.1.1.2"), 1, 3);
+
+  Ptr<Ipv4RoutingInfo> info = CreateObject<Ipv4RoutingInfo> ();
+  info->SetNode (nodes.Get (0));
+
+  RouteInfo route;
+  NS_TEST_ASSERT_MSG_EQ (info->Lookup (Ipv4Address ("10.1.1.2"), route), true, "on link route");
+  NS_TEST_ASSERT_MSG_EQ (route.nextHop, Ipv4Address ("10.1.1.2"), "the neighbor is the next hop");
+  NS_TEST_ASSERT_MSG_EQ (route.distance, 1, "one hop");
+  NS_TEST_ASSERT_MSG_EQ (route.interface, 1, "through the simple device");
+
+  NS_TEST_ASSERT_MSG_EQ (info->Lookup (Ipv4Address ("10.2.0.9"), route), true, "host route");
+  NS_TEST_ASSERT_MSG_EQ (route.nextHop, Ipv4Address ("10.1.1.2"), "through the gateway");
+  NS_TEST_ASSERT_MSG_EQ (route.distance, RouteInfo::UNKNOWN_DISTANCE, "without a metric the hops are unknown");
+
+  NS_TEST_ASSERT_MSG_EQ (info->Lookup (Ipv4Address ("10.2.0.10"), route), true, "host route with a metric");
+  NS_TEST_ASSERT_MSG_EQ (route.nextHop, Ipv4Address ("10.1.1.2"), "through the gateway");
+  NS_TEST_ASSERT_MSG_EQ (route.distance, 3, "the metric");
+  NS_TEST_ASSERT_MSG_EQ (route.interface, 1, "");
+
+  NS_TEST_ASSERT_MSG_EQ (info->Lookup (Ipv4Address ("192.168.0.1"), route), false, "no route");
+  NS_TEST_ASSERT_MSG_EQ (info->IsReactive (), false, "static routing is proactive");
+
+  Simulator::Destroy ();
+}
+
+// The olsr routes are copied once per change of the routing table
+class OlsrRoutingInfoTestCase : public TestCase
+{
+public:
+  OlsrRoutingInfoTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Changed (void);
+
+  uint32_t m_changes;
+};
+
+OlsrRoutingInfoTestCase::OlsrRoutingInfoTestCase ()
+  : TestCase ("The olsr route cache is refreshed after the routing table changed"),
+    m_changes (0)
+{
+}
+
+void
+OlsrRoutingInfoTestCase::Changed (void)
+{
+  m_changes++;
+}
+
+void
+OlsrRoutingInfoTestCase::DoRun (void)
+{
+  OlsrHelper olsr;
+  NodeContainer nodes;
+  CreateLink (nodes, &olsr);
+
+  Ptr<olsr::RoutingProtocol> protocol = DynamicCast<olsr::RoutingProtocol> (
+      nodes.Get (0)->GetObject<Ipv4> ()->GetRoutingProtocol ());
+  NS_TEST_ASSERT_MSG_NE (protocol, 0, "olsr is the routing protocol of the node");
+  Ptr<OlsrRoutingInfo> info = CreateObject<OlsrRoutingInfo> ();
+  info->SetRoutingProtocol (protocol);
+  info->SetChangeCallback (MakeCallback (&OlsrRoutingInfoTestCase::Changed, this));
+
+  RouteInfo route;
+  NS_TEST_ASSERT_MSG_EQ (info->Lookup (Ipv4Address ("10.1.1.2"), route), false, "olsr has not met the neighbor yet");
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_GT (m_changes, 0, "the routing table changed");
+  NS_TEST_ASSERT_MSG_EQ (info->Lookup (Ipv4Address ("10.1.1.2"), route), true, "the cached routes were refreshed");
+  NS_TEST_ASSERT_MSG_EQ (route.nextHop, Ipv4Address ("10.1.1.2"), "the neighbor is the next hop");
+  NS_TEST_ASSERT_MSG_EQ (route.distance, 1, "one hop");
+
+  Simulator::Destroy ();
+}
+
+// Datasources are found through their advertisements
+class AdvertisementTestCase : public TestCase
+{
+public:
+  AdvertisementTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void CheckExpired (Ptr<DcepState> state, EventTypeId type);
+};
+
+AdvertisementTestCase::AdvertisementTestCase ()
+  : TestCase ("Advertisements cross the wire and build the producer index")
+{
+}
+
+void
+AdvertisementTestCase::CheckExpired (Ptr<DcepState> state, EventTypeId type)
+{
+  std::vector<Ipv4Address> producers;
+  state->GetProducers (type, producers);
+  NS_TEST_EXPECT_MSG_EQ (producers.size (), 1, "the producer which was not refreshed is gone");
+  NS_TEST_EXPECT_MSG_EQ (producers[0], Ipv4Address ("10.0.0.7"), "the refreshed one stays");
+  NS_TEST_EXPECT_MSG_EQ_TOL (state->GetAdvertisedRate (type), 2.0, 1e-9, "only live producers count");
+}
+
+void
+AdvertisementTestCase::DoRun (void)
+{
+  EventTypeId temperature = EventTypeTable::Intern ("Temperature");
+  EventTypeId humidity = EventTypeTable::Intern ("Humidity");
+
+  SerializedAdvertisement sent;
+  sent.origin = Ipv4Address ("10.0.0.42");
+  sent.lifetime = 15000;
+  sent.types.push_back (temperature);
+  sent.rates.push_back (10.0);
+  sent.types.push_back (humidity);
+  sent.rates.push_back (0.5);
+
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (sent);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), sent.GetSerializedSize (), "size on the wire");
+  SerializedAdvertisement received;
+  p->RemoveHeader (received);
+  NS_TEST_ASSERT_MSG_EQ (received.origin, sent.origin, "origin");
+  NS_TEST_ASSERT_MSG_EQ (received.lifetime, 15000, "lifetime");
+  NS_TEST_ASSERT_MSG_EQ (received.types.size (), 2, "types");
+  NS_TEST_ASSERT_MSG_EQ (received.types[1], humidity, "types keep their order");
+  NS_TEST_ASSERT_MSG_EQ_TOL (received.rates[1], 0.5, 1e-12, "rates");
+
+  Ptr<DcepState> state = CreateObject<DcepState> ();
+  NS_TEST_ASSERT_MSG_EQ (state->AddProducer (temperature, Ipv4Address ("10.0.0.5"), 1.0, Seconds (10)), true, "new producer");
+  NS_TEST_ASSERT_MSG_EQ (state->AddProducer (temperature, Ipv4Address ("10.0.0.7"), 2.0, Seconds (5)), true, "second producer");
+  NS_TEST_ASSERT_MSG_EQ (state->AddProducer (temperature, Ipv4Address ("10.0.0.7"), 2.0, Seconds (20)), false, "refreshed");
+
+  std::vector<Ipv4Address> producers;
+  state->GetProducers (temperature, producers);
+  NS_TEST_ASSERT_MSG_EQ (producers.size (), 2, "both producers");
+  NS_TEST_ASSERT_MSG_EQ (producers[0], Ipv4Address ("10.0.0.7"), "the fastest first");
+  NS_TEST_ASSERT_MSG_EQ_TOL (state->GetAdvertisedRate (temperature), 3.0, 1e-9, "rates add up");
+  state->GetProducers (humidity, producers);
+  NS_TEST_ASSERT_MSG_EQ (producers.size (), 0, "nobody advertised humidity");
+
+  Simulator::Schedule (Seconds (12), &AdvertisementTestCase::CheckExpired, this, state, temperature);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+// Textual queries compile into the query trees the sink dispatches
+class QueryCompilerTestCase : public TestCase
+{
+public:
+  QueryCompilerTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+QueryCompilerTestCase::QueryCompilerTestCase ()
+  : TestCase ("Textual queries compile into query trees")
+{
+}
+
+void
+QueryCompilerTestCase::DoRun (void)
+{
+  QueryCompiler compiler;
+  std::vector<Ptr<Query> > queries;
+  compiler.Compile ("# two statements\n"
+                    "select Fire from (Smoke and Heat) or Alarm within 5s where Heat.value > 30;\n"
+                    "SELECT Hot FROM AVG(Heat) WITHIN 10 EVENTS TUMBLING ABOVE 40;", queries);
+
+  EventTypeId smoke = EventTypeTable::Intern ("Smoke");
+  EventTypeId heat = EventTypeTable::Intern ("Heat");
+  EventTypeId alarm = EventTypeTable::Intern ("Alarm");
+  EventTypeId fire = EventTypeTable::Intern ("Fire");
+  EventTypeId inner = EventTypeTable::Intern ("Fire_1");
+
+  /* Smoke, Heat, the inner and, Alarm, the or, then the average */
+  NS_TEST_ASSERT_MSG_EQ (queries.size (), 6, "one query per type read and per operator");
+  NS_TEST_ASSERT_MSG_EQ (queries[0]->isAtomic, true, "inputs come first");
+  NS_TEST_ASSERT_MSG_EQ (queries[0]->eventType, smoke, "in the order they are read");
+  NS_TEST_ASSERT_MSG_EQ (queries[0]->parent_output, inner, "smoke goes to the inner operator");
+  NS_TEST_ASSERT_MSG_EQ (queries[1]->eventType, heat, "heat is read once");
+  NS_TEST_ASSERT_MSG_EQ (queries[1]->parent_output, inner, "heat goes to the inner operator");
+  NS_TEST_ASSERT_MSG_EQ (queries[1]->other_parent_outputs.size (), 1, "and to the average");
+  NS_TEST_ASSERT_MSG_EQ (queries[1]->other_parent_outputs[0], EventTypeTable::Intern ("Hot"), "");
+  NS_TEST_ASSERT_MSG_EQ (queries[2]->eventType, alarm, "alarm is read once");
+  NS_TEST_ASSERT_MSG_EQ (queries[2]->parent_output, fire, "alarm goes to the top operator");
+
+  Ptr<Query> andOp = queries[3];
+  NS_TEST_ASSERT_MSG_EQ (andOp->op, "and", "inner operator");
+  NS_TEST_ASSERT_MSG_EQ (andOp->eventType, inner, "intermediate type");
+  NS_TEST_ASSERT_MSG_EQ (andOp->inevent1, smoke, "first input");
+  NS_TEST_ASSERT_MSG_EQ (andOp->inevent2, heat, "second input");
+  NS_TEST_ASSERT_MSG_EQ (andOp->isFinal, false, "not what the sink waits for");
+  NS_TEST_ASSERT_MSG_EQ (andOp->parent_output, fire, "its output goes to the top operator");
+  NS_TEST_ASSERT_MSG_EQ (andOp->window_type, TIME_WINDOW, "the window applies to every operator");
+  NS_TEST_ASSERT_MSG_EQ (andOp->filter, "Heat.value > 30", "so does the filter");
+
+  Ptr<Query> orOp = queries[4];
+  NS_TEST_ASSERT_MSG_EQ (orOp->op, "or", "top operator");
+  NS_TEST_ASSERT_MSG_EQ (orOp->eventType, fire, "selected type");
+  NS_TEST_ASSERT_MSG_EQ (orOp->inevent1, inner, "reads the inner operator");
+  NS_TEST_ASSERT_MSG_EQ (orOp->inevent2, alarm, "and the alarms");
+  NS_TEST_ASSERT_MSG_EQ (orOp->isFinal, true, "final");
+  NS_TEST_ASSERT_MSG_EQ (orOp->parent_output, NO_EVENT_TYPE, "its output goes to the sink");
+  NS_TEST_ASSERT_MSG_EQ (orOp->window_length, Seconds (5), "window length");
+
+  Ptr<Query> avg = queries[5];
+  NS_TEST_ASSERT_MSG_EQ (avg->op, "avg", "aggregate");
+  NS_TEST_ASSERT_MSG_EQ (avg->inevent1, heat, "heat was already read by the first statement");
+  NS_TEST_ASSERT_MSG_EQ (avg->window_type, COUNT_WINDOW, "count window");
+  NS_TEST_ASSERT_MSG_EQ (avg->window_count, 10, "of ten events");
+  NS_TEST_ASSERT_MSG_EQ (avg->window_mode, TUMBLING_WINDOW, "tumbling");
+  NS_TEST_ASSERT_MSG_EQ_TOL (avg->threshold, 40.0, 1e-12, "threshold");
+
+  std::vector<Ptr<Query> > pattern;
+  compiler.Compile ("SELECT Intrusion FROM Door SEQ Motion SEQ Heat", pattern);
+  NS_TEST_ASSERT_MSG_EQ (pattern.size (), 4, "one pattern over the new types and heat");
+  NS_TEST_ASSERT_MSG_EQ (pattern[2], queries[1], "heat is placed again for its new reader");
+  NS_TEST_ASSERT_MSG_EQ (pattern[2]->other_parent_outputs.size (), 2, "");
+  NS_TEST_ASSERT_MSG_EQ (pattern[2]->assigned, false, "");
+  NS_TEST_ASSERT_MSG_EQ (pattern[3]->op, "seq", "chained seq");
+  NS_TEST_ASSERT_MSG_EQ (pattern[3]->inevents.size (), 3, "is one n-ary pattern");
+  NS_TEST_ASSERT_MSG_EQ (pattern[3]->inevents[2], heat, "in order");
+  NS_TEST_ASSERT_MSG_NE (pattern[3]->id, avg->id, "ids go on across texts");
+}
+
+// Queued packets leave at the rate of the network or of the pacer
+class CommunicationSendTestCase : public TestCase
+{
+public:
+  CommunicationSendTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Received (Ptr<Socket> socket);
+  void SendBurst (Ptr<Communication> communication, uint32_t count, Ipv4Address dest);
+  void Dropped (uint32_t oldValue, uint32_t newValue);
+
+  std::vector<Time> m_arrivals;
+  uint32_t m_size;
+  uint32_t m_drops;
+};
+
+CommunicationSendTestCase::CommunicationSendTestCase ()
+  : TestCase ("Communication drains its queues at line rate and honours the pacer"),
+    m_size (0),
+    m_drops (0)
+{
+}
+
+void
+CommunicationSendTestCase::Dropped (uint32_t oldValue, uint32_t newValue)
+{
+  m_drops = newValue;
+}
+
+void
+CommunicationSendTestCase::Received (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()))
+    {
+      m_arrivals.push_back (Simulator::Now ());
+      m_size = p->GetSize ();
+    }
+}
+
+void
+CommunicationSendTestCase::SendBurst (Ptr<Communication> communication, uint32_t count, Ipv4Address dest)
+{
+  for (uint32_t i = 0; i < count; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (100);
+      DcepHeader header;
+      header.SetContentType (EVENT);
+      header.setContentSize (100);
+      p->AddHeader (header);
+      communication->ScheduleSend (p, dest);
+    }
+}
+
+void
+CommunicationSendTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  CreateLink (nodes);
+
+  Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (1), UdpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  sink->SetRecvCallback (MakeCallback (&CommunicationSendTestCase::Received, this));
+
+  Ptr<Communication> communication = CreateCommunication (nodes.Get (0));
+  communication->TraceConnectWithoutContext ("SendDrops",
+      MakeCallback (&CommunicationSendTestCase::Dropped, this));
+
+  /* the first packet resolves the address of the peer */
+  Ipv4Address peer ("10.1.1.2");
+  SendBurst (communication, 1, peer);
+  Simulator::Schedule (Seconds (1), &CommunicationSendTestCase::SendBurst, this, communication, 20, peer);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_arrivals.size (), 21, "every packet is delivered");
+  NS_TEST_ASSERT_MSG_EQ (m_arrivals[20], Seconds (1), "the burst is not paced by the application");
+
+  /* 8kbps let one byte out per millisecond */
+  m_arrivals.clear ();
+  communication->SetAttribute ("PacingRate", DataRateValue (DataRate ("8kbps")));
+  communication->SetAttribute ("PacingBurst", UintegerValue (m_size));
+  Time start = Simulator::Now () + Seconds (1);
+  Simulator::Schedule (Seconds (1), &CommunicationSendTestCase::SendBurst, this, communication, 5, peer);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_arrivals.size (), 5, "every paced packet is delivered");
+  NS_TEST_ASSERT_MSG_EQ (m_arrivals[0], start, "the bucket holds one packet");
+  for (uint32_t i = 1; i < m_arrivals.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_arrivals[i] - m_arrivals[i - 1], DataRate ("8kbps").CalculateBytesTxTime (m_size),
+                             "one packet per refill of the bucket");
+    }
+
+  /* packets without a route wait on their own */
+  m_arrivals.clear ();
+  communication->SetAttribute ("PacingRate", DataRateValue (DataRate (0)));
+  start = Simulator::Now () + Seconds (1);
+  Simulator::Schedule (Seconds (1), &CommunicationSendTestCase::SendBurst, this, communication, 3,
+                       Ipv4Address ("192.168.0.1"));
+  Simulator::Schedule (Seconds (1), &CommunicationSendTestCase::SendBurst, this, communication, 3, peer);
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_arrivals.size (), 3, "the reachable destination is served");
+  NS_TEST_ASSERT_MSG_EQ (m_arrivals[2], start, "without waiting for the other one");
+  NS_TEST_ASSERT_MSG_EQ (m_drops, 3, "the others are dropped after MaxSendRetries");
+
+  /* a packet larger than a datagram is dropped at once */
+  m_arrivals.clear ();
+  Ptr<Packet> large = Create<Packet> (70000);
+  DcepHeader header;
+  header.SetContentType (QUERY);
+  header.setContentSize (70000);
+  large->AddHeader (header);
+  Simulator::Schedule (Seconds (1), &Communication::ScheduleSend, communication, large, peer);
+  Simulator::Schedule (Seconds (1), &CommunicationSendTestCase::SendBurst, this, communication, 1, peer);
+  Simulator::Stop (Seconds (1.001));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_drops, 4, "dropped");
+  NS_TEST_ASSERT_MSG_EQ (m_arrivals.size (), 1, "the next packet is not held up");
+
+  Simulator::Destroy ();
+}
+
+// Routes the test adds by hand, telling the resource manager about them
+class ManualRoutingInfo : public RoutingInfo
+{
+public:
+  ManualRoutingInfo () : routed (false), lookups (0) {}
+  virtual bool Lookup (Ipv4Address dest, RouteInfo &route)
+  {
+    lookups++;
+    if (routed)
+      {
+        route.nextHop = dest;
+        route.distance = 1;
+      }
+    return routed;
+  }
+  virtual bool ReportsChanges (void) const { return true; }
+  void Change (void) { changed (); }
+
+  /* every destination is a neighbor once routed */
+  bool routed;
+  uint32_t lookups;
+};
+
+// Packets without a route wait for the routes to change
+class CommunicationRouteChangeTestCase : public TestCase
+{
+public:
+  CommunicationRouteChangeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Received (Ptr<Socket> socket);
+  void Dropped (uint32_t oldValue, uint32_t newValue);
+  void AddRoute (Ptr<Node> node, Ptr<ManualRoutingInfo> info);
+
+  std::vector<Time> m_arrivals;
+  uint32_t m_drops;
+};
+
+CommunicationRouteChangeTestCase::CommunicationRouteChangeTestCase ()
+  : TestCase ("Packets without a route are sent when the routes change"),
+    m_drops (0)
+{
+}
+
+void
+CommunicationRouteChangeTestCase::Received (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_arrivals.push_back (Simulator::Now ());
+    }
+}
+
+void
+CommunicationRouteChangeTestCase::Dropped (uint32_t oldValue, uint32_t newValue)
+{
+  m_drops = newValue;
+}
+
+void
+CommunicationRouteChangeTestCase::AddRoute (Ptr<Node> node, Ptr<ManualRoutingInfo> info)
+{
+  Ipv4StaticRoutingHelper staticRouting;
+  staticRouting.GetStaticRouting (node->GetObject<Ipv4> ())->AddHostRouteTo (
+      Ipv4Address ("192.168.0.1"), Ipv4Address ("10.1.1.2"), 1);
+  info->Change ();
+}
+
+void
+CommunicationRouteChangeTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  CreateLink (nodes);
+  /* the peer is reached through a second address, which needs a route */
+  Ptr<Ipv4> ipv4 = nodes.Get (1)->GetObject<Ipv4> ();
+  ipv4->AddAddress (1, Ipv4InterfaceAddress (Ipv4Address ("192.168.0.1"), Ipv4Mask ("255.255.255.255")));
+
+  Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (1), UdpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  sink->SetRecvCallback (MakeCallback (&CommunicationRouteChangeTestCase::Received, this));
+
+  Ptr<ManualRoutingInfo> info = CreateObject<ManualRoutingInfo> ();
+  Ptr<ResourceManager> resources = CreateObject<ResourceManager> ();
+  resources->SetRoutingInfo (info);
+  Ptr<Communication> communication = CreateCommunication (nodes.Get (0), "", resources);
+  communication->TraceConnectWithoutContext ("SendDrops",
+      MakeCallback (&CommunicationRouteChangeTestCase::Dropped, this));
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (100);
+      DcepHeader header;
+      header.SetContentType (QUERY);
+      header.setContentSize (100);
+      p->AddHeader (header);
+      communication->ScheduleSend (p, Ipv4Address ("192.168.0.1"));
+    }
+  Simulator::Schedule (Seconds (5), &CommunicationRouteChangeTestCase::AddRoute, this, nodes.Get (0), info);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_drops, 0, "nothing is dropped while waiting for a route");
+  NS_TEST_ASSERT_MSG_EQ (m_arrivals.size (), 3, "every packet arrives");
+  NS_TEST_ASSERT_MSG_EQ ((m_arrivals[0] >= Seconds (5)), true, "once the route is there");
+
+  Simulator::Destroy ();
+}
+
+// Events without a route wait in a bounded queue for the routes to change
+class PendingEventsTestCase : public TestCase
+{
+public:
+  PendingEventsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Received (Ptr<Socket> socket);
+  void OverflowDropped (uint32_t oldValue, uint32_t newValue);
+  void ExpiredDropped (uint32_t oldValue, uint32_t newValue);
+  void SendEvent (Ptr<Placement> placement);
+
+  uint32_t m_received;
+  uint32_t m_overflowDrops;
+  uint32_t m_expiredDrops;
+};
+
+PendingEventsTestCase::PendingEventsTestCase ()
+  : TestCase ("Events without a route are dropped when too many or too old, and sent on new routes"),
+    m_received (0),
+    m_overflowDrops (0),
+    m_expiredDrops (0)
+{
+}
+
+void
+PendingEventsTestCase::Received (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_received++;
+    }
+}
+
+void
+PendingEventsTestCase::OverflowDropped (uint32_t oldValue, uint32_t newValue)
+{
+  m_overflowDrops = newValue;
+}
+
+void
+PendingEventsTestCase::ExpiredDropped (uint32_t oldValue, uint32_t newValue)
+{
+  m_expiredDrops = newValue;
+}
+
+void
+PendingEventsTestCase::SendEvent (Ptr<Placement> placement)
+{
+  Ptr<Event> e = Create<Event> ();
+  e->type = EventTypeTable::Intern ("A");
+  e->event_class = FINAL_EVENT;
+  placement->ForwardProducedEvent (e);
+}
+
+void
+PendingEventsTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  CreateLink (nodes);
+
+  Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (1), UdpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  sink->SetRecvCallback (MakeCallback (&PendingEventsTestCase::Received, this));
+
+  /* final events go to the sink on the other node, which has no route yet */
+  Ptr<ManualRoutingInfo> info = CreateObject<ManualRoutingInfo> ();
+  Ptr<ResourceManager> resources = CreateObject<ResourceManager> ();
+  resources->SetRoutingInfo (info);
+  Ptr<Communication> communication = CreateCommunication (nodes.Get (0), "", resources,
+                                                          Ipv4Address ("10.1.1.2"));
+  Ptr<Placement> placement = communication->GetObject<Placement> ();
+  placement->SetAttribute ("PendingQueueCapacity", UintegerValue (3));
+  placement->SetAttribute ("PendingEventMaxAge", TimeValue (Seconds (2)));
+  placement->configure ();
+  placement->TraceConnectWithoutContext ("PendingOverflowDrops",
+      MakeCallback (&PendingEventsTestCase::OverflowDropped, this));
+  placement->TraceConnectWithoutContext ("PendingExpiredDrops",
+      MakeCallback (&PendingEventsTestCase::ExpiredDropped, this));
+
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      SendEvent (placement);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_overflowDrops, 2, "the queue holds three");
+
+  /* checked at 1 s, none is old enough */
+  Simulator::Stop (Seconds (1.5));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_expiredDrops, 0, "none expired yet");
+  SendEvent (placement);
+  NS_TEST_ASSERT_MSG_EQ (m_overflowDrops, 3, "the oldest makes room");
+
+  /* a burst of route changes is one lookup, then checked at 2 s, the two
+     left from the start are too old */
+  uint32_t lookups = info->lookups;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      info->Change ();
+    }
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (info->lookups, lookups + 2, "one lookup for the burst, one for the check");
+  NS_TEST_ASSERT_MSG_EQ (m_expiredDrops, 2, "the old ones expired");
+  NS_TEST_ASSERT_MSG_EQ (m_received, 0, "nothing sent without a route");
+
+  /* the route comes in a burst of changes too */
+  lookups = info->lookups;
+  info->routed = true;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      info->Change ();
+    }
+  Simulator::Stop (Seconds (0.5));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_received, 1, "the young one is sent");
+  NS_TEST_ASSERT_MSG_EQ (info->lookups, lookups + 1, "one lookup for the burst");
+
+  info->Change ();
+  NS_TEST_ASSERT_MSG_EQ (info->lookups, lookups + 1, "no lookup when nothing waits");
+  NS_TEST_ASSERT_MSG_EQ (m_overflowDrops, 3, "");
+  NS_TEST_ASSERT_MSG_EQ (m_expiredDrops, 2, "");
+
+  Simulator::Destroy ();
+}
+
+// Operators move between placements through the freeze, redirect and resume
+// protocol, and come back when the new host does not answer
+class PlacementMigrationTestCase : public TestCase
+{
+public:
+  PlacementMigrationTestCase ();
+
+private:
+  virtual void DoRun (void);
+  Ptr<Placement> CreateHost (Ptr<Node> node);
+  void AddOperator (Ptr<Placement> placement, std::string type, bool atomic);
+  void Send (Ptr<Placement> placement, std::string type, uint64_t seq);
+  void ProducedAtOrigin (Ptr<Event> e);
+  void ProducedAtHost (Ptr<Event> e);
+  void UnclaimedDropped (uint32_t oldValue, uint32_t newValue);
+
+  uint32_t m_producedAtOrigin;
+  uint32_t m_producedAtHost;
+  uint32_t m_unclaimedDrops;
+};
+
+PlacementMigrationTestCase::PlacementMigrationTestCase ()
+  : TestCase ("Operators are migrated without losing inputs, or rolled back"),
+    m_producedAtOrigin (0),
+    m_producedAtHost (0),
+    m_unclaimedDrops (0)
+{
+}
+
+Ptr<Placement>
+PlacementMigrationTestCase::CreateHost (Ptr<Node> node)
+{
+  /* the sink is the origin, on the same link */
+  Ptr<ManualRoutingInfo> info = CreateObject<ManualRoutingInfo> ();
+  info->routed = true;
+  Ptr<ResourceManager> resources = CreateObject<ResourceManager> ();
+  resources->SetRoutingInfo (info);
+  Ptr<Communication> communication = CreateCommunication (node, "migration", resources,
+                                                          Ipv4Address ("10.1.1.1"));
+  Ptr<CEPEngine> cep = CreateObject<CEPEngine> ();
+  communication->AggregateObject (cep);
+  cep->Configure ();
+  Ptr<Placement> placement = communication->GetObject<Placement> ();
+  placement->SetAttribute ("MigrationTimeout", TimeValue (Seconds (2)));
+  placement->configure ();
+  return placement;
+}
+
+void
+PlacementMigrationTestCase::AddOperator (Ptr<Placement> placement, std::string type, bool atomic)
+{
+  Ptr<Query> q = CreateObject<Query> ();
+  q->id = EventTypeTable::Intern (type);
+  q->eventType = EventTypeTable::Intern (type);
+  q->actionType = NOTIFICATION;
+  q->isAtomic = atomic;
+  q->isFinal = !atomic;
+  q->output_dest = Ipv4Address ("10.1.1.1");
+  if (!atomic)
+    {
+      q->op = "and";
+      q->inevent1 = EventTypeTable::Intern ("X");
+      q->inevent2 = EventTypeTable::Intern ("Y");
+      q->inputStream1_address = Ipv4Address ("10.1.1.1");
+      q->inputStream2_address = Ipv4Address ("10.1.1.1");
+      placement->GetObject<CEPEngine> ()->RecvQuery (q);
+    }
+
+  Ptr<DcepState> dstate = placement->GetObject<DcepState> ();
+  dstate->CreateEventRoutingTableEntry (q);
+  dstate->SetCurrentProcessor (q->eventType, Ipv4Address ("10.1.1.1"));
+  dstate->SetState (q->eventType, ACTIVE);
+}
+
+void
+PlacementMigrationTestCase::Send (Ptr<Placement> placement, std::string type, uint64_t seq)
+{
+  Ptr<Event> e = Create<Event> ();
+  e->type = EventTypeTable::Intern (type);
+  e->m_seq = seq;
+  e->event_class = ATOMIC_EVENT;
+  placement->ForwardProducedEvent (e);
+}
+
+void
+PlacementMigrationTestCase::ProducedAtOrigin (Ptr<Event> e)
+{
+  if (e->type == EventTypeTable::Intern ("XandY"))
+    {
+      m_producedAtOrigin++;
+    }
+}
+
+void
+PlacementMigrationTestCase::ProducedAtHost (Ptr<Event> e)
+{
+  m_producedAtHost++;
+}
+
+void
+PlacementMigrationTestCase::UnclaimedDropped (uint32_t oldValue, uint32_t newValue)
+{
+  m_unclaimedDrops = newValue;
+}
+
+void
+PlacementMigrationTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  CreateLink (nodes);
+  Ptr<Placement> origin = CreateHost (nodes.Get (0));
+  Ptr<Placement> host = CreateHost (nodes.Get (1));
+  origin->TraceConnectWithoutContext ("new event produced",
+      MakeCallback (&PlacementMigrationTestCase::ProducedAtOrigin, this));
+  host->TraceConnectWithoutContext ("new event produced",
+      MakeCallback (&PlacementMigrationTestCase::ProducedAtHost, this));
+  host->TraceConnectWithoutContext ("UnclaimedEventDrops",
+      MakeCallback (&PlacementMigrationTestCase::UnclaimedDropped, this));
+
+  /* the origin produces X and Y and joins them by sequence number */
+  AddOperator (origin, "X", true);
+  AddOperator (origin, "Y", true);
+  AddOperator (origin, "XandY", false);
+  EventTypeId xandy = EventTypeTable::Intern ("XandY");
+  Ptr<DcepState> originState = origin->GetObject<DcepState> ();
+  Ptr<DcepState> hostState = host->GetObject<DcepState> ();
+
+  Send (origin, "X", 1);
+  Send (origin, "X", 2);
+  /* redirected to the host before the operator got there */
+  Ptr<Event> early = Create<Event> ();
+  early->type = EventTypeTable::Intern ("Y");
+  early->m_seq = 3;
+  host->RcvCepEvent (early);
+
+  NS_TEST_ASSERT_MSG_EQ (origin->MigrateOperator (xandy, Ipv4Address ("10.1.1.2")), true, "migrating");
+  NS_TEST_ASSERT_MSG_EQ (originState->GetState (xandy), FREEZED, "frozen");
+  /* held until the inputs are redirected */
+  Send (origin, "Y", 1);
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (originState->GetState (xandy), DEACTIVATED, "moved out");
+  NS_TEST_ASSERT_MSG_EQ (hostState->GetState (xandy), ACTIVE, "moved in");
+  NS_TEST_ASSERT_MSG_EQ (originState->GetOuputDest (EventTypeTable::Intern ("X")),
+                         Ipv4Address ("10.1.1.2"), "the inputs are redirected");
+  NS_TEST_ASSERT_MSG_EQ (m_producedAtHost, 1, "the held input matched the restored state");
+
+  Send (origin, "Y", 2);
+  Send (origin, "X", 3);
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_producedAtHost, 3, "the new host joins the inputs");
+  NS_TEST_ASSERT_MSG_EQ (m_producedAtOrigin, 0, "the origin does not anymore");
+
+  /* a late or duplicate resume is ignored */
+  SerializedMigration resume;
+  resume.eventType = xandy;
+  resume.origin = Ipv4Address ("10.1.1.1");
+  std::vector<Ptr<Event> > none;
+  host->RecvMigrationMessage (RESUME, resume, 0, none);
+  NS_TEST_ASSERT_MSG_EQ (hostState->GetState (xandy), ACTIVE, "still active");
+
+  /* events no operator claims are dropped after a while */
+  Ptr<Event> stray = Create<Event> ();
+  stray->type = EventTypeTable::Intern ("Z");
+  host->RcvCepEvent (stray);
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_unclaimedDrops, 1, "the stray event expired");
+
+  /* placed at the origin again, then moved to a host that never answers */
+  originState->SetOutDest (EventTypeTable::Intern ("X"), Ipv4Address ("10.1.1.1"));
+  originState->SetOutDest (EventTypeTable::Intern ("Y"), Ipv4Address ("10.1.1.1"));
+  AddOperator (origin, "XandY", false);
+  NS_TEST_ASSERT_MSG_EQ (origin->MigrateOperator (xandy, Ipv4Address ("10.1.1.9")), true, "migrating");
+  Send (origin, "X", 4);
+  Send (origin, "Y", 4);
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (originState->GetState (xandy), FREEZED, "waiting for the host");
+  NS_TEST_ASSERT_MSG_EQ (m_producedAtOrigin, 0, "the inputs are held");
+
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (originState->GetState (xandy), ACTIVE, "rolled back");
+  NS_TEST_ASSERT_MSG_EQ (originState->GetOuputDest (EventTypeTable::Intern ("Y")),
+                         Ipv4Address ("10.1.1.1"), "the inputs come back");
+  NS_TEST_ASSERT_MSG_EQ (m_producedAtOrigin, 1, "the held inputs are processed");
+
+  Send (origin, "X", 5);
+  Send (origin, "Y", 5);
+  NS_TEST_ASSERT_MSG_EQ (m_producedAtOrigin, 2, "and the new ones");
+
+  Simulator::Destroy ();
+}
+
+// Routes of a star whose hub is the only router, the nodes share one link
+class StarRoutingInfo : public RoutingInfo
+{
+public:
+  StarRoutingInfo (Ipv4Address local, Ipv4Address hub) : local (local), hub (hub) {}
+  virtual bool Lookup (Ipv4Address dest, RouteInfo &route)
+  {
+    bool direct = local.IsEqual (hub) || dest.IsEqual (hub);
+    route.nextHop = direct ? dest : hub;
+    route.distance = direct ? 1 : 2;
+    return true;
+  }
+
+  Ipv4Address local;
+  Ipv4Address hub;
+};
+
+// The distributed placement walks an operator to the weighted median of
+// its stream ends
+class DistributedPlacementTestCase : public TestCase
+{
+public:
+  DistributedPlacementTestCase ();
+
+private:
+  virtual void DoRun (void);
+  Ptr<Query> MakeQuery (std::string type, std::string input1, std::string input2);
+};
+
+DistributedPlacementTestCase::DistributedPlacementTestCase ()
+  : TestCase ("Distributed placement moves operators towards their heaviest streams")
+{
+}
+
+Ptr<Query>
+DistributedPlacementTestCase::MakeQuery (std::string type, std::string input1, std::string input2)
+{
+  Ptr<Query> q = CreateObject<Query> ();
+  q->id = EventTypeTable::Intern (type);
+  q->eventType = EventTypeTable::Intern (type);
+  q->actionType = NOTIFICATION;
+  q->isAtomic = false;
+  q->isFinal = true;
+  q->op = "and";
+  q->inevent1 = EventTypeTable::Intern (input1);
+  q->inevent2 = EventTypeTable::Intern (input2);
+  return q;
+}
+
+void
+DistributedPlacementTestCase::DoRun (void)
+{
+  /* the sink 10.1.1.1 and the producers 10.1.1.3 and 10.1.1.4 are 
+     leaves of the hub 10.1.1.2 */
+  NodeContainer nodes;
+  CreateLink (nodes, 0, 4);
+  Ipv4Address hub ("10.1.1.2");
+  std::vector<Ptr<Placement> > placements;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ipv4Address local = nodes.Get (i)->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ();
+      Ptr<ResourceManager> resources = CreateObject<ResourceManager> ();
+      resources->SetRoutingInfo (CreateObject<StarRoutingInfo> (local, hub));
+      Ptr<Communication> communication = CreateCommunication (nodes.Get (i), "", resources,
+                                                              Ipv4Address ("10.1.1.1"));
+      communication->GetObject<Dcep> ()->SetAttribute ("placement policy", StringValue ("distributed"));
+      Ptr<CEPEngine> cep = CreateObject<CEPEngine> ();
+      communication->AggregateObject (cep);
+      cep->Configure ();
+      Ptr<Placement> placement = communication->GetObject<Placement> ();
+      placement->configure ();
+      placements.push_back (placement);
+    }
+
+  Ptr<Placement> sink = placements[0];
+  Ptr<DcepState> dstate = sink->GetObject<DcepState> ();
+  dstate->AddProducer (EventTypeTable::Intern ("Fast"), Ipv4Address ("10.1.1.3"), 10, Seconds (100));
+  dstate->AddProducer (EventTypeTable::Intern ("Slow"), Ipv4Address ("10.1.1.4"), 1, Seconds (100));
+  dstate->AddProducer (EventTypeTable::Intern ("Left"), Ipv4Address ("10.1.1.3"), 3, Seconds (100));
+  dstate->AddProducer (EventTypeTable::Intern ("Right"), Ipv4Address ("10.1.1.4"), 3, Seconds (100));
+
+  /* 10 events per second come from 10.1.1.3 out of 12 in total */
+  sink->RecvQuery (MakeQuery ("FastAndSlow", "Fast", "Slow"));
+  /* 3 from each leaf, no neighbor of the hub carries more than half */
+  sink->RecvQuery (MakeQuery ("LeftAndRight", "Left", "Right"));
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (dstate->GetCurrentProcessor (EventTypeTable::Intern ("FastAndSlow")),
+                         Ipv4Address ("10.1.1.3"), "placed on the producer of the heavy stream");
+  NS_TEST_ASSERT_MSG_EQ (dstate->GetCurrentProcessor (EventTypeTable::Intern ("LeftAndRight")),
+                         hub, "placed on the hub between balanced streams");
+  NS_TEST_ASSERT_MSG_EQ (placements[2]->GetObject<DcepState> ()->GetState (
+                           EventTypeTable::Intern ("FastAndSlow")), ACTIVE, "running there");
+  NS_TEST_ASSERT_MSG_EQ (placements[1]->GetObject<DcepState> ()->GetState (
+                           EventTypeTable::Intern ("LeftAndRight")), ACTIVE, "running there");
+
+  Simulator::Destroy ();
+}
+
+// Events for one destination travel together and are split on arrival
+class CommunicationBatchTestCase : public TestCase
+{
+public:
+  CommunicationBatchTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Received (uint32_t count);
+  void ReceivedDelay (uint64_t delay);
+  void SendEvents (Ptr<Communication> communication, uint32_t count);
+  Ptr<Packet> MakeMessage (void);
+
+  std::vector<Time> m_arrivals;
+  std::vector<uint64_t> m_delays;
+};
+
+CommunicationBatchTestCase::CommunicationBatchTestCase ()
+  : TestCase ("Events are batched per destination up to a size or a hold time")
+{
+}
+
+void
+CommunicationBatchTestCase::Received (uint32_t count)
+{
+  m_arrivals.push_back (Simulator::Now ());
+}
+
+void
+CommunicationBatchTestCase::ReceivedDelay (uint64_t delay)
+{
+  m_delays.push_back (delay);
+}
+
+Ptr<Packet>
+CommunicationBatchTestCase::MakeMessage (void)
+{
+  Ptr<Event> e = Create<Event> ();
+  e->type = EventTypeTable::Intern ("AandB");
+  e->event_class = FINAL_EVENT;
+  SerializedEvent message = e->serialize ();
+  DcepHeader header;
+  header.SetContentType (EVENT);
+  header.setContentSize (message.GetSerializedSize ());
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (message);
+  p->AddHeader (header);
+  return p;
+}
+
+void
+CommunicationBatchTestCase::SendEvents (Ptr<Communication> communication, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i++)
+    {
+      communication->ScheduleSend (MakeMessage (), Ipv4Address ("10.1.1.2"));
+    }
+}
+
+void
+CommunicationBatchTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  CreateLink (nodes);
+
+  /* final events go straight to the sink of the receiver */
+  Ptr<Communication> sender = CreateCommunication (nodes.Get (0));
+  Ptr<Communication> receiver = CreateCommunication (nodes.Get (1));
+  receiver->GetObject<Dcep> ()->TraceConnectWithoutContext ("RxFinalEvent",
+      MakeCallback (&CommunicationBatchTestCase::Received, this));
+  receiver->GetObject<Dcep> ()->TraceConnectWithoutContext ("RxFinalEventDelay",
+      MakeCallback (&CommunicationBatchTestCase::ReceivedDelay, this));
+  sender->SetAttribute ("BatchSize", UintegerValue (3 * MakeMessage ()->GetSize ()));
+  sender->SetAttribute ("BatchHoldTime", TimeValue (MilliSeconds (20)));
+
+  /* the first event resolves the address of the peer */
+  SendEvents (sender, 1);
+  Simulator::Schedule (Seconds (1), &CommunicationBatchTestCase::SendEvents, this, sender, 7);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_arrivals.size (), 8, "every event of the batches is delivered");
+  NS_TEST_ASSERT_MSG_EQ ((m_arrivals[0] >= MilliSeconds (20)), true, "a lone event waits for the hold time");
+  for (uint32_t i = 1; i < 7; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_arrivals[i], Seconds (1), "full batches leave at once");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_arrivals[7], Seconds (1) + MilliSeconds (20), "the rest after the hold time");
+  NS_TEST_ASSERT_MSG_EQ (m_delays[1], 0, "a full batch is not held");
+  NS_TEST_ASSERT_MSG_EQ (m_delays[7], 20000, "the hold time is part of the delay");
+
+  Simulator::Destroy ();
+}
+
+// Reliable messages are sent again until acknowledged, and delivered once
+class CommunicationReliabilityTestCase : public TestCase
+{
+public:
+  CommunicationReliabilityTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Received (uint32_t count);
+  void Retransmitted (uint32_t oldValue, uint32_t newValue);
+  void GivenUp (uint32_t oldValue, uint32_t newValue);
+  void SendEvents (Ptr<Communication> communication, uint32_t count);
+  void Drop (Ptr<NetDevice> device, std::list<uint32_t> received);
+
+  std::vector<Time> m_arrivals;
+  uint32_t m_retransmissions;
+  uint32_t m_givenUp;
+};
+
+CommunicationReliabilityTestCase::CommunicationReliabilityTestCase ()
+  : TestCase ("Reliable events survive losses of messages and acknowledgements"),
+    m_retransmissions (0),
+    m_givenUp (0)
+{
+}
+
+void
+CommunicationReliabilityTestCase::Received (uint32_t count)
+{
+  m_arrivals.push_back (Simulator::Now ());
+}
+
+void
+CommunicationReliabilityTestCase::Retransmitted (uint32_t oldValue, uint32_t newValue)
+{
+  m_retransmissions = newValue;
+}
+
+void
+CommunicationReliabilityTestCase::GivenUp (uint32_t oldValue, uint32_t newValue)
+{
+  m_givenUp = newValue;
+}
+
+void
+CommunicationReliabilityTestCase::SendEvents (Ptr<Communication> communication, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i++)
+    {
+      Ptr<Event> e = Create<Event> ();
+      e->type = EventTypeTable::Intern ("AandB");
+      e->event_class = FINAL_EVENT;
+      SerializedEvent message = e->serialize ();
+      DcepHeader header;
+      header.SetContentType (EVENT);
+      header.setContentSize (message.GetSerializedSize ());
+      Ptr<Packet> p = Create<Packet> ();
+      p->AddHeader (message);
+      p->AddHeader (header);
+      communication->ScheduleSend (p, Ipv4Address ("10.1.1.2"));
+    }
+}
+
+void
+CommunicationReliabilityTestCase::Drop (Ptr<NetDevice> device, std::list<uint32_t> received)
+{
+  Ptr<ReceiveListErrorModel> errors = CreateObject<ReceiveListErrorModel> ();
+  errors->SetList (received);
+  device->SetAttribute ("ReceiveErrorModel", PointerValue (errors));
+}
+
+void
+CommunicationReliabilityTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  NetDeviceContainer devices = CreateLink (nodes);
+
+  Ptr<Communication> sender = CreateCommunication (nodes.Get (0), "event, query");
+  Ptr<Communication> receiver = CreateCommunication (nodes.Get (1), "event, query");
+  receiver->GetObject<Dcep> ()->TraceConnectWithoutContext ("RxFinalEvent",
+      MakeCallback (&CommunicationReliabilityTestCase::Received, this));
+  sender->TraceConnectWithoutContext ("Retransmissions",
+      MakeCallback (&CommunicationReliabilityTestCase::Retransmitted, this));
+  sender->TraceConnectWithoutContext ("ReliableDrops",
+      MakeCallback (&CommunicationReliabilityTestCase::GivenUp, this));
+
+  /* the first event resolves the addresses and measures the round trip */
+  SendEvents (sender, 1);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_arrivals.size (), 1, "delivered");
+  NS_TEST_ASSERT_MSG_EQ (m_retransmissions, 0, "and acknowledged at once");
+
+  /* the first two of three events are lost */
+  m_arrivals.clear ();
+  Time start = Simulator::Now () + Seconds (1);
+  std::list<uint32_t> lost;
+  lost.push_back (0);
+  lost.push_back (1);
+  Simulator::Schedule (Seconds (1), &CommunicationReliabilityTestCase::Drop, this, devices.Get (1), lost);
+  Simulator::Schedule (Seconds (1), &CommunicationReliabilityTestCase::SendEvents, this, sender, 3);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_arrivals.size (), 3, "every event arrives");
+  NS_TEST_ASSERT_MSG_EQ (m_arrivals[0], start, "the third at once");
+  NS_TEST_ASSERT_MSG_EQ ((m_arrivals[1] > start), true, "the others after a timeout");
+  NS_TEST_ASSERT_MSG_EQ (m_retransmissions, 2, "only the lost events are sent again");
+
+  /* the acknowledgement is lost, the copy sent again is not delivered */
+  m_arrivals.clear ();
+  lost.pop_back ();
+  Simulator::Schedule (Seconds (1), &CommunicationReliabilityTestCase::Drop, this, devices.Get (0), lost);
+  Simulator::Schedule (Seconds (1), &CommunicationReliabilityTestCase::SendEvents, this, sender, 1);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_arrivals.size (), 1, "delivered once");
+  NS_TEST_ASSERT_MSG_EQ (m_retransmissions, 3, "sent again for the lost acknowledgement");
+
+  /* an event and both of its copies are lost, the sender gives up */
+  m_arrivals.clear ();
+  sender->SetAttribute ("MaxRetransmissions", UintegerValue (2));
+  lost.push_back (1);
+  lost.push_back (2);
+  Simulator::Schedule (Seconds (1), &CommunicationReliabilityTestCase::Drop, this, devices.Get (1), lost);
+  Simulator::Schedule (Seconds (1), &CommunicationReliabilityTestCase::SendEvents, this, sender, 1);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_arrivals.size (), 0, "lost");
+  NS_TEST_ASSERT_MSG_EQ (m_givenUp, 1, "given up");
+  NS_TEST_ASSERT_MSG_EQ (m_retransmissions, 5, "after two copies");
+
+  /* the receiver skips it rather than waiting for it forever */
+  Simulator::Schedule (Seconds (1), &CommunicationReliabilityTestCase::SendEvents, this, sender, 20);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_arrivals.size (), 20, "the following events arrive");
+  NS_TEST_ASSERT_MSG_EQ (m_retransmissions, 5, "and are all acknowledged at once");
+  NS_TEST_ASSERT_MSG_EQ (m_givenUp, 1, "none given up");
+
+  Simulator::Destroy ();
+}
+
+// Urgent messages overtake queued atomic events to other destinations
+class CommunicationPriorityTestCase : public TestCase
+{
+public:
+  CommunicationPriorityTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Received (Ptr<Socket> socket);
+  void SendEvent (Ptr<Communication> communication, uint32_t eventClass, Ipv4Address peer);
+  void SendMessage (Ptr<Communication> communication, uint16_t type, Ipv4Address peer);
+
+  /* the second destination of node 1 */
+  Ptr<Socket> m_second;
+  /* the traffic class of each packet received, and whether it went to
+     the second destination */
+  std::vector<uint32_t> m_classes;
+  std::vector<bool> m_toSecond;
+};
+
+CommunicationPriorityTestCase::CommunicationPriorityTestCase ()
+  : TestCase ("Messages leave by traffic class, in order for a destination")
+{
+}
+
+void
+CommunicationPriorityTestCase::Received (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()))
+    {
+      SeqTsHeader seqTs;
+      DcepHeader header;
+      p->RemoveHeader (seqTs);
+      p->RemoveHeader (header);
+      m_toSecond.push_back (socket == m_second);
+      if (header.GetContentType () != EVENT)
+        {
+          m_classes.push_back (header.GetContentType () == QUERY ? QUERY_TRAFFIC : CONTROL_TRAFFIC);
+          continue;
+        }
+      SerializedEvent message;
+      p->RemoveHeader (message);
+      m_classes.push_back (Communication::GetEventTrafficClass (message.event_class));
+    }
+}
+
+void
+CommunicationPriorityTestCase::SendEvent (Ptr<Communication> communication, uint32_t eventClass,
+                                          Ipv4Address peer)
+{
+  Ptr<Event> e = Create<Event> ();
+  e->type = EventTypeTable::Intern ("A");
+  e->event_class = eventClass;
+  SerializedEvent message = e->serialize ();
+  DcepHeader header;
+  header.SetContentType (EVENT);
+  header.SetTrafficClass (Communication::GetEventTrafficClass (eventClass));
+  header.setContentSize (message.GetSerializedSize ());
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (message);
+  p->AddHeader (header);
+  communication->ScheduleSend (p, peer);
+}
+
+void
+CommunicationPriorityTestCase::SendMessage (Ptr<Communication> communication, uint16_t type,
+                                            Ipv4Address peer)
+{
+  Ptr<Packet> p = Create<Packet> (20);
+  DcepHeader header;
+  header.SetContentType (type);
+  header.setContentSize (20);
+  p->AddHeader (header);
+  communication->ScheduleSend (p, peer);
+}
+
+void
+CommunicationPriorityTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  CreateLink (nodes);
+  Ipv4Address first ("10.1.1.2");
+  Ipv4Address second ("192.168.0.1");
+  Ptr<Ipv4> ipv4 = nodes.Get (1)->GetObject<Ipv4> ();
+  ipv4->AddAddress (1, Ipv4InterfaceAddress (second, Ipv4Mask ("255.255.255.255")));
+  Ipv4StaticRoutingHelper staticRouting;
+  staticRouting.GetStaticRouting (nodes.Get (0)->GetObject<Ipv4> ())->AddHostRouteTo (second, first, 1);
+
+  Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (1), UdpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (first, 9));
+  sink->SetRecvCallback (MakeCallback (&CommunicationPriorityTestCase::Received, this));
+  m_second = Socket::CreateSocket (nodes.Get (1), UdpSocketFactory::GetTypeId ());
+  m_second->Bind (InetSocketAddress (second, 9));
+  m_second->SetRecvCallback (MakeCallback (&CommunicationPriorityTestCase::Received, this));
+
+  Ptr<Communication> communication = CreateCommunication (nodes.Get (0));
+  communication->SetAttribute ("AtomicEventQueueCapacity", UintegerValue (3));
+
+  /* the first event resolves the address of the peer */
+  SendEvent (communication, ATOMIC_EVENT, first);
+  Simulator::Run ();
+  m_classes.clear ();
+  m_toSecond.clear ();
+
+  /* queued together, the query goes first and the final event to the
+     second destination overtakes the atomic events to the first, while
+     to the first the events and the migration keep their order */
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      SendEvent (communication, ATOMIC_EVENT, first);
+    }
+  SendEvent (communication, FINAL_EVENT, first);
+  SendMessage (communication, MIGRATION, first);
+  SendMessage (communication, QUERY, first);
+  SendEvent (communication, FINAL_EVENT, second);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (communication->GetQueueDrops (ATOMIC_EVENT_TRAFFIC), 1, "the atomic queue holds three");
+  NS_TEST_ASSERT_MSG_EQ (communication->GetQueueDrops (FINAL_EVENT_TRAFFIC), 0, "");
+  NS_TEST_ASSERT_MSG_EQ (m_classes.size (), 7, "the others are delivered");
+  NS_TEST_ASSERT_MSG_EQ (m_classes[0], QUERY_TRAFFIC, "the query first");
+  NS_TEST_ASSERT_MSG_EQ (m_classes[1], FINAL_EVENT_TRAFFIC, "then the final event");
+  NS_TEST_ASSERT_MSG_EQ (m_toSecond[1], true, "to the second destination");
+  for (uint32_t i = 2; i < 5; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_classes[i], ATOMIC_EVENT_TRAFFIC, "the atomic events are not overtaken");
+      NS_TEST_ASSERT_MSG_EQ (m_toSecond[i], false, "");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_classes[5], FINAL_EVENT_TRAFFIC, "the final event follows them");
+  NS_TEST_ASSERT_MSG_EQ (m_toSecond[5], false, "");
+  NS_TEST_ASSERT_MSG_EQ (m_classes[6], CONTROL_TRAFFIC, "the migration last");
+
+  m_second = 0;
+  Simulator::Destroy ();
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +2458,32 @@ DcepTestSuite::DcepTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new DcepTestCase1, TestCase::QUICK);
+  AddTestCase (new EventTypeTableTestCase, TestCase::QUICK);
+  AddTestCase (new EventFreeListTestCase, TestCase::QUICK);
+  AddTestCase (new AndOperatorJoinTestCase, TestCase::QUICK);
+  AddTestCase (new WindowTestCase, TestCase::QUICK);
+  AddTestCase (new PatternOperatorTestCase, TestCase::QUICK);
+  AddTestCase (new AggregateOperatorTestCase, TestCase::QUICK);
+  AddTestCase (new EventFilterTestCase, TestCase::QUICK);
+  AddTestCase (new OperatorSharingTestCase, TestCase::QUICK);
+  AddTestCase (new SubscriptionIndexTestCase, TestCase::QUICK);
+  AddTestCase (new ProcessingTimeTestCase, TestCase::QUICK);
+  AddTestCase (new WireFormatTestCase, TestCase::QUICK);
+  AddTestCase (new OperatorMigrationTestCase, TestCase::QUICK);
+  AddTestCase (new PlacementRetryTestCase, TestCase::QUICK);
+  AddTestCase (new DcepStateTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4RoutingInfoTestCase, TestCase::QUICK);
+  AddTestCase (new OlsrRoutingInfoTestCase, TestCase::QUICK);
+  AddTestCase (new AdvertisementTestCase, TestCase::QUICK);
+  AddTestCase (new QueryCompilerTestCase, TestCase::QUICK);
+  AddTestCase (new CommunicationSendTestCase, TestCase::QUICK);
+  AddTestCase (new CommunicationRouteChangeTestCase, TestCase::QUICK);
+  AddTestCase (new PendingEventsTestCase, TestCase::QUICK);
+  AddTestCase (new PlacementMigrationTestCase, TestCase::QUICK);
+  AddTestCase (new DistributedPlacementTestCase, TestCase::QUICK);
+  AddTestCase (new CommunicationBatchTestCase, TestCase::QUICK);
+  AddTestCase (new CommunicationReliabilityTestCase, TestCase::QUICK);
+  AddTestCase (new CommunicationPriorityTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite